@@ -0,0 +1,436 @@
+#include "CorpusGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include <libzippp/libzippp.h>
+#include <xlnt/xlnt.hpp>
+
+namespace
+{
+    constexpr const char* FILLER[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do",
+        "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore", "magna", "aliqua", "report",
+        "quarterly", "meeting", "schedule", "project", "budget", "review", "approved", "draft", "team",
+        "delivery", "warehouse", "invoice", "summary", "agenda", "minutes", "the", "of", "and", "for"
+    };
+
+    constexpr const char* FIRST_NAMES[] = { "anna", "ivan", "maria", "john", "olga", "peter", "elena", "sam" };
+    constexpr const char* DOMAINS[] = { "example.com", "mail.org", "corp.net", "company.ru" };
+    constexpr const char* KEYWORDS[][2] = {
+        { "sensitive", "confidential" }, { "sensitive", "password" }, { "sensitive", "secret" },
+        { "personal", "passport" }, { "personal", "identification" }
+    };
+
+    // Lines of at most `width` characters, split on spaces
+    std::vector<std::string> wrap(const std::string& text, size_t width)
+    {
+        std::vector<std::string> lines;
+        size_t begin = 0;
+
+        while (begin < text.size())
+        {
+            auto end = text.find('\n', begin);
+            if (end == std::string::npos)
+                end = text.size();
+
+            if (end - begin > width)
+            {
+                const auto space = text.rfind(' ', begin + width);
+                end = (space != std::string::npos && space > begin) ? space : begin + width;
+            }
+
+            lines.push_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        return lines;
+    }
+
+    std::string escapeXml(const std::string& text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+
+        for (const char c : text)
+        {
+            switch (c)
+            {
+                case '&': escaped += "&amp;"; break;
+                case '<': escaped += "&lt;"; break;
+                case '>': escaped += "&gt;"; break;
+                case '"': escaped += "&quot;"; break;
+                default: escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    void writeFile(const std::filesystem::path& filePath, const std::string& data)
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+        if (!out)
+            throw std::runtime_error("Failed to write fixture: " + filePath.string());
+    }
+
+    // libzippp keeps pointers to the entry data until close()
+    void writeZip(const std::filesystem::path& filePath, const std::vector<std::pair<std::string, std::string>>& entries)
+    {
+        std::filesystem::remove(filePath);
+        libzippp::ZipArchive zip(filePath.string());
+
+        if (!zip.open(libzippp::ZipArchive::New))
+            throw std::runtime_error("Failed to create fixture archive: " + filePath.string());
+
+        for (const auto& [name, data] : entries)
+            zip.addData(name, data.data(), data.size());
+
+        zip.close();
+    }
+}
+
+std::string CorpusGenerator::digits(size_t count)
+{
+    std::string result;
+    for (size_t i = 0; i < count; ++i)
+        result += static_cast<char>('0' + pick(10));
+    return result;
+}
+
+// Visa-like 16 digits with a valid Luhn check digit, so card validation keeps it
+std::string CorpusGenerator::cardNumber()
+{
+    const std::string payload = "4" + digits(14);
+    unsigned sum = 0;
+
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        unsigned digit = static_cast<unsigned>(payload[payload.size() - 1 - i] - '0');
+        if (i % 2 == 0)
+            digit = digit * 2 > 9 ? digit * 2 - 9 : digit * 2;
+        sum += digit;
+    }
+
+    const std::string number = payload + static_cast<char>('0' + (10 - sum % 10) % 10);
+    return number.substr(0, 4) + " " + number.substr(4, 4) + " " + number.substr(8, 4) + " " + number.substr(12);
+}
+
+CorpusGenerator::Sample CorpusGenerator::sample()
+{
+    switch (pick(7))
+    {
+        case 0:
+            return { "email", std::string(FIRST_NAMES[pick(std::size(FIRST_NAMES))]) + "." + digits(3) + "@" +
+                              DOMAINS[pick(std::size(DOMAINS))] };
+        case 1:
+            return { "phone", "+7 (9" + digits(2) + ") " + digits(3) + "-" + digits(2) + "-" + digits(2) };
+        case 2:
+            return { "ip", std::to_string(1 + pick(223)) + "." + std::to_string(pick(256)) + "." +
+                           std::to_string(pick(256)) + "." + std::to_string(1 + pick(254)) };
+        case 3:
+            return { "cardNumber", cardNumber() };
+        case 4:
+            return { "passport", std::to_string(10 + pick(90)) + digits(2) + " " + digits(5) + std::to_string(1 + pick(9)) };
+        case 5:
+            return { "url", "https://" + std::string(DOMAINS[pick(std::size(DOMAINS))]) + "/docs/" + digits(5) };
+        default:
+        {
+            const auto& keyword = KEYWORDS[pick(std::size(KEYWORDS))];
+            return { keyword[0], keyword[1] };
+        }
+    }
+}
+
+std::string CorpusGenerator::text(size_t size, size_t matchInterval, std::vector<Sample>* planted)
+{
+    std::string result;
+    result.reserve(size + 64);
+
+    // Lines stay under 100 characters so fixture writers never split a planted value
+    constexpr size_t LINE_BREAK_AT = 60;
+
+    size_t nextMatch = matchInterval;
+    size_t lineStart = 0;
+
+    while (result.size() < size)
+    {
+        if (matchInterval != 0 && result.size() >= nextMatch)
+        {
+            auto next = sample();
+            result += next.value;
+            nextMatch += matchInterval;
+
+            if (planted)
+                planted->push_back(std::move(next));
+        }
+        else
+            result += FILLER[pick(std::size(FILLER))];
+
+        if (result.size() - lineStart >= LINE_BREAK_AT)
+        {
+            result += '\n';
+            lineStart = result.size();
+        }
+        else
+            result += ' ';
+    }
+
+    return result;
+}
+
+void Fixtures::writeTxt(const std::filesystem::path& filePath, const std::string& text)
+{
+    writeFile(filePath, text);
+}
+
+void Fixtures::writeXml(const std::filesystem::path& filePath, const std::string& text)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<document>\n";
+
+    for (const auto& line : wrap(text, 200))
+        xml += "  <line>" + escapeXml(line) + "</line>\n";
+
+    xml += "</document>\n";
+    writeFile(filePath, xml);
+}
+
+void Fixtures::writeDocx(const std::filesystem::path& filePath, const std::string& text)
+{
+    std::string document = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+
+    for (const auto& line : wrap(text, 200))
+        document += "<w:p><w:r><w:t xml:space=\"preserve\">" + escapeXml(line) + "</w:t></w:r></w:p>";
+
+    document += "</w:body></w:document>";
+
+    writeZip(filePath, {
+        { "[Content_Types].xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\"/>" },
+        { "word/document.xml", document } });
+}
+
+void Fixtures::writePptx(const std::filesystem::path& filePath, const std::string& text)
+{
+    constexpr size_t LINES_PER_SLIDE = 40;
+
+    std::vector<std::pair<std::string, std::string>> entries = {
+        { "[Content_Types].xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\"/>" } };
+
+    const auto lines = wrap(text, 200);
+
+    for (size_t first = 0; first < lines.size(); first += LINES_PER_SLIDE)
+    {
+        std::string slide = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+            "<p:sld xmlns:a=\"http://schemas.openxmlformats.org/drawingml/2006/main\" "
+            "xmlns:p=\"http://schemas.openxmlformats.org/presentationml/2006/main\">"
+            "<p:cSld><p:spTree><p:sp><p:txBody>";
+
+        for (size_t line = first; line < std::min(lines.size(), first + LINES_PER_SLIDE); ++line)
+            slide += "<a:p><a:r><a:t>" + escapeXml(lines[line]) + "\n</a:t></a:r></a:p>";
+
+        slide += "</p:txBody></p:sp></p:spTree></p:cSld></p:sld>";
+        entries.emplace_back("ppt/slides/slide" + std::to_string(first / LINES_PER_SLIDE + 1) + ".xml", std::move(slide));
+    }
+
+    writeZip(filePath, entries);
+}
+
+void Fixtures::writeXlsx(const std::filesystem::path& filePath, const std::string& text)
+{
+    constexpr uint32_t ROWS_PER_SHEET = 1000;
+
+    xlnt::workbook workbook;
+    auto sheet = workbook.active_sheet();
+    uint32_t row = 0;
+
+    for (const auto& line : wrap(text, 200))
+    {
+        if (row == ROWS_PER_SHEET)
+        {
+            sheet = workbook.create_sheet();
+            row = 0;
+        }
+
+        sheet.cell(xlnt::cell_reference(1, ++row)).value(line);
+    }
+
+    workbook.save(filePath.string());
+}
+
+void Fixtures::writePdf(const std::filesystem::path& filePath, const std::string& text)
+{
+    constexpr size_t LINES_PER_PAGE = 60;
+
+    const auto lines = wrap(text, 100);
+    const size_t pageCount = std::max<size_t>(1, (lines.size() + LINES_PER_PAGE - 1) / LINES_PER_PAGE);
+
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+
+    auto object = [&](const std::string& body)
+    {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(offsets.size()) + " 0 obj\n" + body + "\nendobj\n";
+    };
+
+    // 1 catalog, 2 page tree, 3 font, then a page and its content stream per page
+    std::string kids;
+    for (size_t page = 0; page < pageCount; ++page)
+        kids += std::to_string(4 + page * 2) + " 0 R ";
+
+    object("<< /Type /Catalog /Pages 2 0 R >>");
+    object("<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pageCount) + " >>");
+    object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+
+    for (size_t page = 0; page < pageCount; ++page)
+    {
+        std::string content = "BT /F1 9 Tf 11 TL 36 756 Td\n";
+
+        for (size_t line = page * LINES_PER_PAGE; line < std::min(lines.size(), (page + 1) * LINES_PER_PAGE); ++line)
+        {
+            content += '(';
+            for (const char c : lines[line])
+            {
+                if (c == '(' || c == ')' || c == '\\')
+                    content += '\\';
+                content += c;
+            }
+            content += ") Tj T*\n";
+        }
+
+        content += "ET";
+
+        object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Resources << /Font << /F1 3 0 R >> >> "
+               "/Contents " + std::to_string(5 + page * 2) + " 0 R >>");
+        object("<< /Length " + std::to_string(content.size()) + " >>\nstream\n" + content + "\nendstream");
+    }
+
+    const auto xrefOffset = pdf.size();
+    pdf += "xref\n0 " + std::to_string(offsets.size() + 1) + "\n0000000000 65535 f \n";
+
+    for (const auto offset : offsets)
+    {
+        const auto number = std::to_string(offset);
+        pdf += std::string(10 - number.size(), '0') + number + " 00000 n \n";
+    }
+
+    pdf += "trailer\n<< /Size " + std::to_string(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+           std::to_string(xrefOffset) + "\n%%EOF\n";
+
+    writeFile(filePath, pdf);
+}
+
+void Fixtures::write(const std::filesystem::path& filePath, const std::string& text)
+{
+    const auto extension = filePath.extension().string();
+
+    if (extension == ".txt")
+        writeTxt(filePath, text);
+    else if (extension == ".xml")
+        writeXml(filePath, text);
+    else if (extension == ".docx")
+        writeDocx(filePath, text);
+    else if (extension == ".pptx")
+        writePptx(filePath, text);
+    else if (extension == ".xlsx")
+        writeXlsx(filePath, text);
+    else if (extension == ".pdf")
+        writePdf(filePath, text);
+    else
+        throw std::invalid_argument("No fixture writer for " + extension);
+}
+
+const std::vector<std::string>& Fixtures::extensions()
+{
+    static const std::vector<std::string> supported = { ".txt", ".xml", ".docx", ".pptx", ".xlsx", ".pdf" };
+    return supported;
+}
+
+std::vector<CorpusFile> Corpus::generate(const std::filesystem::path& root, const CorpusSpec& spec)
+{
+    const auto& extensions = spec.extensions.empty() ? Fixtures::extensions() : spec.extensions;
+
+    CorpusGenerator generator(spec.seed);
+    std::mt19937_64 layout(spec.seed ^ 0x9e3779b97f4a7c15ULL);
+    std::lognormal_distribution<double> sizeDistribution(std::log(static_cast<double>(spec.medianBytes)), spec.sizeSigma);
+
+    std::vector<CorpusFile> files;
+    files.reserve(spec.files);
+
+    nlohmann::json groundTruth;
+    groundTruth["seed"] = spec.seed;
+    groundTruth["files"] = nlohmann::json::array();
+
+    for (size_t index = 0; index < spec.files; ++index)
+    {
+        std::filesystem::path directory;
+        const auto depth = std::uniform_int_distribution<size_t>(0, spec.depth)(layout);
+
+        for (size_t level = 0; level < depth; ++level)
+            directory /= "dir" + std::to_string(std::uniform_int_distribution<size_t>(0, spec.fanout - 1)(layout));
+
+        const auto& extension = extensions[index % extensions.size()];
+
+        CorpusFile file;
+        file.relativePath = directory / ("file_" + std::to_string(index) + extension);
+
+        const auto size = std::clamp<size_t>(static_cast<size_t>(sizeDistribution(layout)), 256, spec.maxBytes);
+        const auto text = generator.text(size, spec.matchInterval, &file.planted);
+        file.textBytes = text.size();
+
+        std::filesystem::create_directories(root / directory);
+        Fixtures::write(root / file.relativePath, text);
+
+        nlohmann::json planted = nlohmann::json::array();
+        for (const auto& sample : file.planted)
+            planted.push_back({ {"category", sample.category}, {"value", sample.value} });
+
+        groundTruth["files"].push_back({
+            {"path", file.relativePath.generic_string()},
+            {"text_bytes", file.textBytes},
+            {"planted", std::move(planted)} });
+
+        files.push_back(std::move(file));
+    }
+
+    std::ofstream out(root / GROUND_TRUTH_FILE);
+    out << groundTruth.dump(1) << std::endl;
+
+    if (!out)
+        throw std::runtime_error("Failed to write " + (root / GROUND_TRUTH_FILE).string());
+
+    return files;
+}
+
+std::vector<CorpusFile> Corpus::loadGroundTruth(const std::filesystem::path& root)
+{
+    std::ifstream in(root / GROUND_TRUTH_FILE);
+
+    if (!in)
+        throw std::runtime_error("No " + std::string(GROUND_TRUTH_FILE) + " in " + root.string() +
+                                 ", generate the corpus with PIICorpusGen first");
+
+    const auto groundTruth = nlohmann::json::parse(in);
+    std::vector<CorpusFile> files;
+
+    for (const auto& entry : groundTruth.at("files"))
+    {
+        CorpusFile file;
+        file.relativePath = entry.at("path").get<std::string>();
+        file.textBytes = entry.at("text_bytes").get<size_t>();
+
+        for (const auto& sample : entry.at("planted"))
+            file.planted.push_back({ sample.at("category").get<std::string>(), sample.at("value").get<std::string>() });
+
+        files.push_back(std::move(file));
+    }
+
+    return files;
+}
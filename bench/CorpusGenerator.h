@@ -0,0 +1,84 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+// Deterministic synthetic documents for benchmarks: filler prose with PII
+// values planted at a fixed interval. The same seed gives the same bytes.
+class CorpusGenerator
+{
+public:
+    struct Sample
+    {
+        std::string category;
+        std::string value;
+    };
+
+    explicit CorpusGenerator(uint64_t seed): _random(seed) {}
+
+    // Roughly `size` bytes of text; one sample every `matchInterval` bytes (0 = no PII).
+    // Planted samples are appended to `planted` when given.
+    std::string text(size_t size, size_t matchInterval, std::vector<Sample>* planted = nullptr);
+
+    Sample sample();
+
+private:
+    size_t pick(size_t count) { return std::uniform_int_distribution<size_t>(0, count - 1)(_random); }
+    std::string digits(size_t count);
+    std::string cardNumber();
+
+    std::mt19937_64 _random;
+};
+
+// Directory tree of fixtures with a recorded ground truth of every planted value
+struct CorpusSpec
+{
+    size_t files = 200;
+    uint64_t seed = 42;
+    std::vector<std::string> extensions;    // empty = every fixture type
+    size_t medianBytes = 32 * 1024;         // text size is log-normal around the median
+    double sizeSigma = 1.0;
+    size_t maxBytes = 4 * 1024 * 1024;
+    size_t matchInterval = 2048;            // one planted value per N bytes of text
+    size_t depth = 3;
+    size_t fanout = 4;
+};
+
+struct CorpusFile
+{
+    std::filesystem::path relativePath;
+    size_t textBytes = 0;
+    std::vector<CorpusGenerator::Sample> planted;
+};
+
+namespace Corpus
+{
+    inline constexpr const char* GROUND_TRUTH_FILE = "ground_truth.json";
+
+    // Creates the tree under `root` and writes ground_truth.json next to it
+    std::vector<CorpusFile> generate(const std::filesystem::path& root, const CorpusSpec& spec);
+
+    std::vector<CorpusFile> loadGroundTruth(const std::filesystem::path& root);
+}
+
+// Writes `text` as a document the matching ReaderBase can extract it from again
+namespace Fixtures
+{
+    void writeTxt(const std::filesystem::path& filePath, const std::string& text);
+    void writeXml(const std::filesystem::path& filePath, const std::string& text);
+    void writeDocx(const std::filesystem::path& filePath, const std::string& text);
+    void writePptx(const std::filesystem::path& filePath, const std::string& text);
+    void writeXlsx(const std::filesystem::path& filePath, const std::string& text);
+    void writePdf(const std::filesystem::path& filePath, const std::string& text);
+
+    // Picks the writer by extension (.txt/.xml/.docx/.pptx/.xlsx/.pdf)
+    void write(const std::filesystem::path& filePath, const std::string& text);
+
+    const std::vector<std::string>& extensions();
+}
+
+#endif // CORPUSGENERATOR_H
@@ -0,0 +1,365 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+#include "CorpusGenerator.h"
+#include "FileReaders.h"
+#include "MatcherCache.h"
+#include "PIIRecognizer.h"
+#include "PatternRegistry.h"
+
+// Microbenchmarks for the strategies and readers: bytes/s and allocations/op.
+// Results can be written as JSON (--json) to diff runs.
+
+namespace
+{
+    std::atomic<uint64_t> allocationCount { 0 };
+    std::atomic<uint64_t> allocationBytes { 0 };
+
+    void* countedAllocate(size_t size)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (void* pointer = std::malloc(size == 0 ? 1 : size))
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+
+    void* countedAllocate(size_t size, std::align_val_t alignment)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+        const auto align = static_cast<size_t>(alignment);
+        if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace
+{
+    using PatternMap = std::map<std::string, std::vector<std::string>>;
+
+    struct BenchResult
+    {
+        std::string name;
+        std::map<std::string, std::string> parameters;
+        uint64_t bytesPerOp;
+        uint64_t iterations;
+        double secondsPerOp;
+        double bytesPerSecond;
+        double allocationsPerOp;
+        double allocatedBytesPerOp;
+    };
+
+    class BenchRunner
+    {
+    public:
+        BenchRunner(double minSeconds, std::string filter)
+            : _minSeconds(minSeconds), _filter(std::move(filter)) {}
+
+        template<typename Operation>
+        void run(const std::string& name, const std::map<std::string, std::string>& parameters,
+                 uint64_t bytesPerOp, Operation&& operation)
+        {
+            if (!isSelected(name))
+                return;
+
+            operation();  // warm-up: lazy RE2 DFA construction, page cache
+
+            uint64_t iterations = 1;
+            double elapsed = 0.0;
+            uint64_t allocations = 0;
+            uint64_t allocated = 0;
+
+            while (true)
+            {
+                const auto countBefore = allocationCount.load(std::memory_order_relaxed);
+                const auto bytesBefore = allocationBytes.load(std::memory_order_relaxed);
+                const auto start = std::chrono::steady_clock::now();
+
+                for (uint64_t i = 0; i < iterations; ++i)
+                    operation();
+
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                allocations = allocationCount.load(std::memory_order_relaxed) - countBefore;
+                allocated = allocationBytes.load(std::memory_order_relaxed) - bytesBefore;
+
+                if (elapsed >= _minSeconds || iterations >= (uint64_t(1) << 30))
+                    break;
+
+                // Aim a little past the target so the final batch usually succeeds
+                const auto scale = elapsed > 0.0 ? _minSeconds * 1.2 / elapsed : 10.0;
+                iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+            }
+
+            BenchResult result
+            {
+                name,
+                parameters,
+                bytesPerOp,
+                iterations,
+                elapsed / iterations,
+                elapsed > 0.0 ? bytesPerOp * iterations / elapsed : 0.0,
+                static_cast<double>(allocations) / iterations,
+                static_cast<double>(allocated) / iterations
+            };
+
+            std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed
+                      << std::setw(12) << std::setprecision(3) << result.secondsPerOp * 1e3 << " ms/op"
+                      << std::setw(12) << std::setprecision(2) << result.bytesPerSecond / (1024.0 * 1024.0) << " MB/s"
+                      << std::setw(14) << std::setprecision(1) << result.allocationsPerOp << " allocs/op"
+                      << std::setw(14) << std::setprecision(0) << result.allocatedBytesPerOp << " B/op" << std::endl;
+
+            _results.push_back(std::move(result));
+        }
+
+        bool isSelected(const std::string& name) const
+        {
+            return _filter.empty() || name.find(_filter) != std::string::npos;
+        }
+
+        const std::vector<BenchResult>& results() const noexcept { return _results; }
+
+    private:
+        double _minSeconds;
+        std::string _filter;
+        std::vector<BenchResult> _results;
+    };
+
+    std::string sizeLabel(size_t bytes)
+    {
+        if (bytes >= 1024 * 1024)
+            return std::to_string(bytes / (1024 * 1024)) + "MiB";
+        return std::to_string(bytes / 1024) + "KiB";
+    }
+
+    // Repeats every category under a new name to grow the pattern set
+    PatternMap scalePatternSet(const PatternMap& patterns, size_t factor)
+    {
+        PatternMap scaled;
+
+        for (size_t copy = 0; copy < factor; ++copy)
+            for (const auto& [category, list] : patterns)
+                scaled[copy == 0 ? category : category + "#" + std::to_string(copy)] = list;
+
+        return scaled;
+    }
+
+    void benchStrategies(BenchRunner& runner, uint64_t seed)
+    {
+        PatternMap patterns;
+        PatternMap keywords;
+        DefaultProvider().provide(patterns, keywords);
+
+        const std::pair<const char*, size_t> densities[] = { { "none", 0 }, { "sparse", 16 * 1024 }, { "dense", 256 } };
+        const size_t sizes[] = { 4 * 1024, 256 * 1024, 4 * 1024 * 1024 };
+        const size_t patternScales[] = { 1, 4 };
+
+        for (const auto scale : patternScales)
+        {
+            std::vector<std::unique_ptr<IStrategyScanner>> strategies;
+            strategies.push_back(PIIStrategyHandler::createRegexStrategy(scalePatternSet(patterns, scale)));
+            strategies.push_back(PIIStrategyHandler::createKeywordStrategy(scalePatternSet(keywords, scale)));
+
+            for (const auto& strategy : strategies)
+            {
+                for (const auto size : sizes)
+                {
+                    for (const auto& [densityName, interval] : densities)
+                    {
+                        const auto name = "strategy/" + strategy->name() + "/" + sizeLabel(size) + "/" +
+                                          densityName + "/patterns_x" + std::to_string(scale);
+
+                        if (!runner.isSelected(name))
+                            continue;
+
+                        CorpusGenerator generator(seed);
+                        const auto text = generator.text(size, interval);
+
+                        runner.run(name,
+                            { { "strategy", strategy->name() }, { "size", sizeLabel(size) },
+                              { "density", densityName }, { "patterns", "x" + std::to_string(scale) } },
+                            text.size(),
+                            [&strategy, &text] { auto matches = strategy->scan(text); (void)matches; });
+                    }
+                }
+            }
+        }
+    }
+
+    void benchReaders(BenchRunner& runner, uint64_t seed, const std::filesystem::path& fixtureDir)
+    {
+        FileReaderFactory readerFactory;
+        readerFactory.registerReader<TxtReader>(".txt");
+        readerFactory.registerReader<PdfReader>(".pdf");
+        readerFactory.registerReader<XlsxReader>(".xlsx");
+        readerFactory.registerReader<PptxReader>(".pptx");
+        readerFactory.registerReader<XmlReader>(".xml");
+        readerFactory.registerReader<DocxReader>(".docx");
+
+        const size_t sizes[] = { 64 * 1024, 1024 * 1024 };
+
+        for (const auto& extension : Fixtures::extensions())
+        {
+            for (const auto size : sizes)
+            {
+                const auto name = "reader/" + extension.substr(1) + "/" + sizeLabel(size);
+                const auto fixture = fixtureDir / (extension.substr(1) + "_" + sizeLabel(size) + extension);
+
+                if (!runner.isSelected(name))
+                    continue;
+
+                CorpusGenerator generator(seed);
+                Fixtures::write(fixture, generator.text(size, 16 * 1024));
+
+                auto reader = readerFactory.getReader(fixture);
+
+                runner.run(name,
+                    { { "reader", extension.substr(1) }, { "size", sizeLabel(size) } },
+                    std::filesystem::file_size(fixture),
+                    [&reader, &fixture] { auto text = reader->readText(fixture); (void)text; });
+            }
+        }
+    }
+
+    // Building the matcher tables of a large dictionary vs mapping them from the cache
+    void benchStartup(BenchRunner& runner, uint64_t seed, const std::filesystem::path& fixtureDir)
+    {
+        const size_t dictionarySizes[] = { 1000, 20000 };
+
+        for (const auto size : dictionarySizes)
+        {
+            const auto label = std::to_string(size / 1000) + "k";
+            const auto buildName = "startup/keyword/" + label + "/build";
+            const auto cacheName = "startup/keyword/" + label + "/cache";
+
+            if (!runner.isSelected(buildName) && !runner.isSelected(cacheName))
+                continue;
+
+            std::mt19937_64 random(seed);
+            PatternMap keywords;
+            uint64_t dictionaryBytes = 0;
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                std::string word(5 + random() % 10, ' ');
+                for (auto& c : word)
+                    c = static_cast<char>('a' + random() % 26);
+
+                dictionaryBytes += word.size();
+                keywords["category" + std::to_string(i % 8)].push_back(std::move(word));
+            }
+
+            const MatcherCache cache(fixtureDir / "matchers");
+
+            runner.run(buildName, { { "keywords", label }, { "source", "build" } }, dictionaryBytes,
+                [&keywords] { auto matchers = CompiledMatchers::build({}, keywords); (void)matchers; });
+
+            runner.run(cacheName, { { "keywords", label }, { "source", "cache" } }, dictionaryBytes,
+                [&keywords, &cache] { auto matchers = cache.get({}, keywords); (void)matchers; });
+        }
+    }
+
+    nlohmann::json resultsToJson(const std::vector<BenchResult>& results, uint64_t seed, double minSeconds)
+    {
+        nlohmann::json json;
+        json["seed"] = seed;
+        json["min_time"] = minSeconds;
+        json["results"] = nlohmann::json::array();
+
+        for (const auto& result : results)
+        {
+            json["results"].push_back({
+                {"name", result.name},
+                {"parameters", result.parameters},
+                {"bytes_per_op", result.bytesPerOp},
+                {"iterations", result.iterations},
+                {"seconds_per_op", result.secondsPerOp},
+                {"bytes_per_second", result.bytesPerSecond},
+                {"allocations_per_op", result.allocationsPerOp},
+                {"allocated_bytes_per_op", result.allocatedBytesPerOp} });
+        }
+
+        return json;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("PIIScannerBench", "Microbenchmarks for PIIScanner strategies and readers");
+    options.add_options()
+        ("f,filter", "Run only benchmarks whose name contains this text", cxxopts::value<std::string>()->default_value(""))
+        ("m,min-time", "Minimum measured seconds per benchmark", cxxopts::value<double>()->default_value("0.2"))
+        ("s,seed", "Corpus generator seed", cxxopts::value<uint64_t>()->default_value("42"))
+        ("j,json", "Write results as JSON to this file", cxxopts::value<std::string>())
+        ("fixtures", "Directory for generated reader fixtures", cxxopts::value<std::string>())
+        ("h,help", "Show help message");
+
+    try
+    {
+        const auto result = options.parse(argc, argv);
+
+        if (result.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+
+        const auto seed = result["seed"].as<uint64_t>();
+        const auto minSeconds = result["min-time"].as<double>();
+
+        const bool ownFixtures = !result.count("fixtures");
+        const std::filesystem::path fixtureDir = ownFixtures
+            ? std::filesystem::temp_directory_path() / ("piis-bench-" + std::to_string(seed))
+            : std::filesystem::path(result["fixtures"].as<std::string>());
+        std::filesystem::create_directories(fixtureDir);
+
+        BenchRunner runner(minSeconds, result["filter"].as<std::string>());
+        benchStrategies(runner, seed);
+        benchReaders(runner, seed, fixtureDir);
+        benchStartup(runner, seed, fixtureDir);
+
+        if (ownFixtures)
+            std::filesystem::remove_all(fixtureDir);
+
+        if (result.count("json"))
+        {
+            std::ofstream out(result["json"].as<std::string>());
+            out << resultsToJson(runner.results(), seed, minSeconds).dump(2) << std::endl;
+
+            if (!out)
+                throw std::runtime_error("Failed to write " + result["json"].as<std::string>());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sys/resource.h>
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+#include "CorpusGenerator.h"
+#include "FileReaders.h"
+#include "PIIDetector.h"
+#include "PIIResultExporter.h"
+#include "PIIResultHandler.h"
+#include "PatternRegistry.h"
+#include "Scanner.h"
+
+// End-to-end benchmark: runs PIIScanner::scan over a PIICorpusGen corpus, reports
+// files/s, MB/s, peak RSS and recall, and fails when a stored baseline regresses.
+
+namespace
+{
+    using FoundValues = std::map<std::string, std::vector<std::string>>;
+
+    // Keeps the matches of every file for scoring against the ground truth
+    class RecordingExporter: public IPIIResultExporter
+    {
+    public:
+        RecordingExporter(const MatchInterner& values, std::map<std::filesystem::path, FoundValues>& found)
+            : _values(values), _found(found) {}
+
+        void processFileResults(const std::filesystem::path& filePath, const PIIMatches& results, double) override
+        {
+            auto& file = _found[filePath.lexically_normal()];
+            file.clear();
+
+            for (const auto& [category, ids] : results)
+                for (const auto id : ids)
+                    file[category].emplace_back(_values.value(id));
+        }
+
+        void finalize(const PIIGeneralStats::Stats&) override {}
+
+    private:
+        const MatchInterner& _values;
+        std::map<std::filesystem::path, FoundValues>& _found;
+    };
+
+    struct Recall
+    {
+        size_t planted = 0;
+        size_t detected = 0;
+        size_t unexpected = 0;
+        std::map<std::string, std::pair<size_t, size_t>> categories;   // detected, planted
+
+        double value() const { return planted > 0 ? static_cast<double>(detected) / planted : 1.0; }
+    };
+
+    Recall scoreRecall(const std::vector<CorpusFile>& groundTruth, const std::filesystem::path& root,
+                       const std::map<std::filesystem::path, FoundValues>& found, const std::vector<std::string>& categories)
+    {
+        Recall recall;
+
+        for (const auto& file : groundTruth)
+        {
+            const auto it = found.find((root / file.relativePath).lexically_normal());
+            std::map<std::string, std::multiset<std::string>> remaining;
+            size_t foundCount = 0;
+
+            if (it != found.end())
+            {
+                for (const auto& [category, values] : it->second)
+                {
+                    remaining[category].insert(values.begin(), values.end());
+                    foundCount += values.size();
+                }
+            }
+
+            size_t matched = 0;
+
+            for (const auto& sample : file.planted)
+            {
+                // Only categories the strategy can detect count towards recall
+                if (std::find(categories.begin(), categories.end(), sample.category) == categories.end())
+                    continue;
+
+                auto& category = recall.categories[sample.category];
+                ++category.second;
+                ++recall.planted;
+
+                auto& values = remaining[sample.category];
+                if (const auto value = values.find(sample.value); value != values.end())
+                {
+                    values.erase(value);
+                    ++category.first;
+                    ++recall.detected;
+                    ++matched;
+                }
+            }
+
+            recall.unexpected += foundCount - matched;
+        }
+
+        return recall;
+    }
+
+    uint64_t peakRssKib()
+    {
+        struct rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss);     // KiB on Linux
+    }
+
+    struct Metric
+    {
+        const char* key;
+        bool higherIsBetter;
+        bool absoluteTolerance;     // recall is compared in absolute points
+    };
+
+    constexpr Metric METRICS[] = {
+        { "files_per_second", true, false },
+        { "megabytes_per_second", true, false },
+        { "peak_rss_kib", false, false },
+        { "recall", true, true }
+    };
+
+    // Prints the comparison and returns true when any metric is worse than the tolerance allows
+    bool compareWithBaseline(const nlohmann::json& current, const nlohmann::json& baseline, double tolerance,
+                             double recallTolerance)
+    {
+        bool regressed = false;
+
+        std::cout << "\n Baseline comparison (tolerance " << tolerance * 100 << "%):\n";
+
+        for (const auto& metric : METRICS)
+        {
+            if (!baseline.contains(metric.key))
+                continue;
+
+            const auto now = current.at(metric.key).get<double>();
+            const auto before = baseline.at(metric.key).get<double>();
+
+            bool worse = false;
+            if (metric.absoluteTolerance)
+                worse = metric.higherIsBetter ? now < before - recallTolerance : now > before + recallTolerance;
+            else
+                worse = metric.higherIsBetter ? now < before * (1.0 - tolerance) : now > before * (1.0 + tolerance);
+
+            const auto change = before != 0.0 ? (now - before) / before * 100.0 : 0.0;
+
+            std::cout << "  - " << std::left << std::setw(22) << metric.key << std::right
+                      << before << " -> " << now << " (" << std::showpos << change << std::noshowpos << "%)"
+                      << (worse ? "  REGRESSION" : "") << '\n';
+
+            regressed = regressed || worse;
+        }
+
+        return regressed;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("PIIScannerE2E", "End-to-end PIIScanner benchmark over a generated corpus");
+    options.add_options()
+        ("c,corpus", "Corpus directory created by PIICorpusGen", cxxopts::value<std::string>())
+        ("s,strategy", "Scanning strategy (regex/keyword)", cxxopts::value<std::string>()->default_value("regex"))
+        ("repeat", "Scan the corpus N times and keep the fastest run", cxxopts::value<size_t>()->default_value("3"))
+        ("b,baseline", "Compare against this baseline and fail on regressions", cxxopts::value<std::string>())
+        ("save-baseline", "Write the results as a new baseline", cxxopts::value<std::string>())
+        ("tolerance", "Allowed relative slowdown / RSS growth", cxxopts::value<double>()->default_value("0.10"))
+        ("recall-tolerance", "Allowed absolute recall drop", cxxopts::value<double>()->default_value("0.005"))
+        ("h,help", "Show help message");
+
+    try
+    {
+        const auto result = options.parse(argc, argv);
+
+        if (result.count("help") || !result.count("corpus"))
+        {
+            std::cout << options.help() << std::endl;
+            return result.count("help") ? 0 : 1;
+        }
+
+        const std::filesystem::path root = result["corpus"].as<std::string>();
+        const auto strategyName = result["strategy"].as<std::string>();
+        const auto groundTruth = Corpus::loadGroundTruth(root);
+
+        uint64_t corpusBytes = 0;
+        for (const auto& file : groundTruth)
+            corpusBytes += std::filesystem::file_size(root / file.relativePath);
+
+        std::map<std::string, std::vector<std::string>> patterns;
+        std::map<std::string, std::vector<std::string>> keywords;
+        DefaultProvider().provide(patterns, keywords);
+
+        FileReaderFactory readerFactory;
+        readerFactory.registerReader<TxtReader>(".txt");
+        readerFactory.registerReader<PdfReader>(".pdf");
+        readerFactory.registerReader<XlsxReader>(".xlsx");
+        readerFactory.registerReader<PptxReader>(".pptx");
+        readerFactory.registerReader<XmlReader>(".xml");
+        readerFactory.registerReader<DocxReader>(".docx");
+
+        double bestSeconds = 0.0;
+        std::map<std::filesystem::path, FoundValues> found;
+        std::vector<std::string> categories;
+
+        for (size_t run = 0; run < std::max<size_t>(1, result["repeat"].as<size_t>()); ++run)
+        {
+            std::unique_ptr<IStrategyScanner> strategy;
+
+            if (strategyName == "regex")
+                strategy = PIIStrategyHandler::createRegexStrategy(patterns);
+            else if (strategyName == "keyword")
+                strategy = PIIStrategyHandler::createKeywordStrategy(keywords);
+            else
+                throw std::invalid_argument("Unsupported strategy type: " + strategyName);
+
+            categories = strategy->categories();
+
+            MatchInterner matchValues;
+            PIIDetector detector(std::move(strategy), matchValues);
+
+            std::vector<std::unique_ptr<IPIIResultExporter>> exporters;
+            exporters.push_back(std::make_unique<RecordingExporter>(matchValues, found));
+
+            PIIResultHandler resultProcessor(std::move(exporters), std::make_unique<PIIGeneralStats>(matchValues));
+            PIIScanner scanner(detector, resultProcessor, readerFactory);
+
+            const auto start = std::chrono::steady_clock::now();
+            scanner.scan(root, true);
+            const auto seconds = secondsSince(start);
+
+            if (run == 0 || seconds < bestSeconds)
+                bestSeconds = seconds;
+        }
+
+        const auto recall = scoreRecall(groundTruth, root, found, categories);
+
+        nlohmann::json report;
+        report["strategy"] = strategyName;
+        report["files"] = groundTruth.size();
+        report["bytes"] = corpusBytes;
+        report["seconds"] = bestSeconds;
+        report["files_per_second"] = bestSeconds > 0.0 ? groundTruth.size() / bestSeconds : 0.0;
+        report["megabytes_per_second"] = bestSeconds > 0.0 ? corpusBytes / (1024.0 * 1024.0) / bestSeconds : 0.0;
+        report["peak_rss_kib"] = peakRssKib();
+        report["recall"] = recall.value();
+        report["planted"] = recall.planted;
+        report["detected"] = recall.detected;
+        report["unexpected_matches"] = recall.unexpected;
+
+        for (const auto& [category, counts] : recall.categories)
+            report["recall_by_category"][category] = counts.second > 0 ? static_cast<double>(counts.first) / counts.second : 1.0;
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "\n============== END-TO-END BENCHMARK ==============\n";
+        std::cout << " Files               : " << groundTruth.size() << " (" << corpusBytes / (1024.0 * 1024.0) << " MB)\n";
+        std::cout << " Best wall time      : " << bestSeconds << "s\n";
+        std::cout << " Throughput          : " << report["files_per_second"].get<double>() << " files/s, "
+                  << report["megabytes_per_second"].get<double>() << " MB/s\n";
+        std::cout << " Peak RSS            : " << peakRssKib() / 1024.0 << " MB\n";
+        std::cout << " Recall              : " << recall.value() * 100 << "% (" << recall.detected << " / "
+                  << recall.planted << ", " << recall.unexpected << " unexpected matches)\n";
+
+        for (const auto& [category, counts] : recall.categories)
+            std::cout << "  - " << category << ": " << counts.first << " / " << counts.second << '\n';
+
+        if (result.count("save-baseline"))
+        {
+            std::ofstream out(result["save-baseline"].as<std::string>());
+            out << report.dump(2) << std::endl;
+
+            if (!out)
+                throw std::runtime_error("Failed to write " + result["save-baseline"].as<std::string>());
+        }
+
+        if (result.count("baseline"))
+        {
+            std::ifstream in(result["baseline"].as<std::string>());
+            if (!in)
+                throw std::runtime_error("Cannot open baseline " + result["baseline"].as<std::string>());
+
+            if (compareWithBaseline(report, nlohmann::json::parse(in), result["tolerance"].as<double>(),
+                                    result["recall-tolerance"].as<double>()))
+            {
+                std::cerr << "Performance regression against baseline" << std::endl;
+                return 2;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef ADMISSIONCONTROL_H
+#define ADMISSIONCONTROL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Rough peak heap of extracting and scanning one file, from its on-disk size.
+// Container formats expand (zip + DOM), xlnt keeps whole workbooks as objects.
+inline uint64_t estimateFootprint(const std::string& fileType, uint64_t fileBytes)
+{
+    uint64_t factor = 3;
+
+    if (fileType == ".txt")
+        factor = 2;         // text + lowercase copy in KeywordStrategy
+    else if (fileType == ".xml")
+        factor = 4;         // markup + pugixml DOM + text
+    else if (fileType == ".pdf")
+        factor = 4;
+    else if (fileType == ".docx" || fileType == ".pptx")
+        factor = 10;        // deflated XML parts are ~5-10x larger
+    else if (fileType == ".xlsx")
+        factor = 30;
+
+    constexpr uint64_t BASE_BYTES = 1ULL * 1024 * 1024;  // reader and strategy overhead
+    return BASE_BYTES + fileBytes * factor;
+}
+
+// Global budget for in-flight extraction. Files are admitted in arrival order
+// while the reserved total stays under the capacity; a file larger than the
+// whole budget waits until it can run alone.
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(uint64_t capacityBytes): _capacity(capacityBytes) {}
+
+    class Reservation
+    {
+    public:
+        Reservation() = default;
+        Reservation(MemoryBudget* budget, uint64_t bytes): _budget(budget), _bytes(bytes) {}
+
+        Reservation(Reservation&& other) noexcept
+            : _budget(std::exchange(other._budget, nullptr)), _bytes(other._bytes) {}
+
+        Reservation& operator=(Reservation&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                _budget = std::exchange(other._budget, nullptr);
+                _bytes = other._bytes;
+            }
+            return *this;
+        }
+
+        ~Reservation() { release(); }
+
+        void release()
+        {
+            if (_budget)
+                std::exchange(_budget, nullptr)->release(_bytes);
+        }
+
+    private:
+        MemoryBudget* _budget = nullptr;
+        uint64_t _bytes = 0;
+    };
+
+    uint64_t capacity() const noexcept { return _capacity; }
+
+    bool exceedsCapacity(uint64_t bytes) const noexcept { return bytes > _capacity; }
+
+    // Blocks until the bytes fit; requests above the capacity are clamped to it
+    Reservation admit(uint64_t bytes)
+    {
+        bytes = std::min(bytes, _capacity);
+
+        std::unique_lock lock(_mutex);
+        const auto ticket = _nextTicket++;
+
+        _changed.wait(lock, [&] { return ticket == _serving && _reserved + bytes <= _capacity; });
+
+        _reserved += bytes;
+        ++_serving;
+        _changed.notify_all();
+
+        return { this, bytes };
+    }
+
+private:
+    void release(uint64_t bytes)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _reserved -= bytes;
+        }
+        _changed.notify_all();
+    }
+
+    const uint64_t _capacity;
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    uint64_t _reserved = 0;
+    uint64_t _nextTicket = 0;
+    uint64_t _serving = 0;
+};
+
+#endif // ADMISSIONCONTROL_H
@@ -0,0 +1,51 @@
+#ifndef BATCHFILEREADER_H
+#define BATCHFILEREADER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Reads whole small files through io_uring. The opens, statx calls and reads
+// of up to MAX_OPEN_FILES files are in flight at once, and every file is handed
+// over as soon as its last read completes, while the kernel works on the rest.
+// Buffers are pooled: the one handed over is taken back when the handler returns.
+//
+// Not thread-safe: one reader per scan thread. Without io_uring (old kernel,
+// seccomp profile, built with -DPIIS_ENABLE_IO_URING=OFF) available() is false
+// and the caller reads the files itself.
+class BatchFileReader
+{
+public:
+    static constexpr size_t MAX_FILE_BYTES = 256 * 1024;    // larger files are left to their reader
+    static constexpr size_t MAX_OPEN_FILES = 32;
+
+    using FileHandler = std::function<void(size_t index, std::string& bytes)>;
+
+    BatchFileReader();
+    ~BatchFileReader();
+
+    BatchFileReader(const BatchFileReader&) = delete;
+    BatchFileReader& operator=(const BatchFileReader&) = delete;
+
+    bool available() const noexcept;
+
+    // Calls onFile with the position and the bytes of every file read, in
+    // completion order. Returns the positions of the files it could not read
+    // (missing, unreadable, grown past MAX_FILE_BYTES), for the caller's own
+    // path to read or report. The handler may change the bytes in place.
+    std::vector<size_t> read(const std::vector<std::filesystem::path>& files, const FileHandler& onFile);
+
+private:
+    struct Ring;
+
+    std::string takeBuffer();
+    void recycle(std::string&& buffer);
+
+    std::unique_ptr<Ring> _ring;
+    std::vector<std::string> _pool;
+};
+
+#endif // BATCHFILEREADER_H
@@ -0,0 +1,46 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+
+// Cooperative stop signal for long-running readers and strategies.
+// Producers call cancel(), workers poll isCancelled() between units of work.
+// With a timeout the token also cancels itself once the deadline has passed.
+class CancellationToken
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+
+    explicit CancellationToken(Clock::duration timeout)
+        : _deadline(Clock::now() + timeout), _hasDeadline(timeout > Clock::duration::zero()) {}
+
+    void cancel() noexcept { _cancelled.store(true, std::memory_order_relaxed); }
+
+    bool isCancelled() const noexcept
+    {
+        if (_cancelled.load(std::memory_order_relaxed))
+            return true;
+
+        if (_hasDeadline && Clock::now() >= _deadline)
+        {
+            _timedOut.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    // The deadline was seen by a worker, as opposed to an explicit cancel()
+    bool timedOut() const noexcept { return _timedOut.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> _cancelled { false };
+    mutable std::atomic<bool> _timedOut { false };
+    Clock::time_point _deadline {};
+    bool _hasDeadline = false;
+};
+
+#endif // CANCELLATION_H
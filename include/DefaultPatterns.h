@@ -0,0 +1,240 @@
+#ifndef DEFAULTPATTERNS_H
+#define DEFAULTPATTERNS_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "KeywordAutomaton.h"
+
+// The built-in pattern set, known at compile time. DefaultProvider hands it out
+// as maps like any other provider; the matcher tables of exactly this set are
+// computed by the compiler (see CompiledMatchers::defaults()), so a run without
+// --pattern-config builds nothing at start-up.
+namespace DefaultPatterns
+{
+    struct Pattern
+    {
+        std::string_view regex;
+        std::string_view literal = {};  // lowercase text every match contains, empty if there is none
+    };
+
+    struct PatternCategory
+    {
+        std::string_view name;
+        std::span<const Pattern> patterns;
+    };
+
+    struct KeywordCategory
+    {
+        std::string_view name;
+        std::span<const std::string_view> keywords;
+    };
+
+    inline constexpr Pattern CARD_NUMBER[] =
+    {
+        { R"((?:\b|\s|^)((\d[ -]?){15,16}\d)(?:\b|\s|$))" },
+        { R"((?:\b|\s|^)(3[47]\d{2}[ -]?\d{6}[ -]?\d{5})(?:\b|\s|$))" }
+    };
+
+    inline constexpr Pattern EMAIL[] =
+    {
+        { R"((?:^|\s)([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,})(?:$|\s))" },
+        { R"(<([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,})>)" },
+        { R"("([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,}))" }
+    };
+
+    inline constexpr Pattern IP[] =
+    {
+        { R"(\b((?:25[0-5]|2[0-4][0-9]|1[0-9]{2}|[1-9]?[0-9])\.(?:25[0-5]|2[0-4][0-9]|1[0-9]{2}|[1-9]?[0-9])\.)"
+          R"((?:25[0-5]|2[0-4][0-9]|1[0-9]{2}|[1-9]?[0-9])\.(?:25[0-5]|2[0-4][0-9]|1[0-9]{2}|[1-9]?[0-9]))\b)" }
+    };
+
+    inline constexpr Pattern PASSPORT[] =
+    {
+        { R"((?:^|\s)(\d{4}[\s-]?\d{6})(?:$|\s))" },
+        { R"(\b\d{2}\s?\d{2}\s?\d{6}\b)" },
+        { R"(\b[A-Za-z]{2}\s?\d{7}\b)" }
+    };
+
+    inline constexpr Pattern PHONE[] =
+    {
+        { R"(\+(\d{11}|\d \d{3} \d{3}-\d{2}-\d{2}|\d \(\d{3}\)\s*\d{3}-\d{4})\b)" },
+        { R"((\+7\s*\(\d{3}\)\s*\d{3}-\d{2}-\d{2}))" }
+    };
+
+    inline constexpr Pattern URL[] =
+    {
+        { R"((?:^|\s)(https?://[A-Za-z0-9\-._~:/?#[\]@!$&'()*+,;=%]+)(?:$|\s))", "http" },
+        { R"((?:^|\s)(www\.[A-Za-z0-9\-._~:/?#[\]@!$&'()*+,;=%]+)(?:$|\s))", "www." },
+        { R"((?:^|\s)([A-Za-z0-9\-.]+\.[A-Za-z]{2,}(?:/[A-Za-z0-9\-._~:/?#[\]@!$&'()*+,;=%]*)?)(?:$|\s))" }
+    };
+
+    // std::map order, so pattern and keyword numbers match the ones of the maps
+    inline constexpr PatternCategory PATTERNS[] =
+    {
+        { "cardNumber", CARD_NUMBER },
+        { "email", EMAIL },
+        { "ip", IP },
+        { "passport", PASSPORT },
+        { "phone", PHONE },
+        { "url", URL }
+    };
+
+    // Which category reports text that several of them match (MatchResolver):
+    // checksummed and tightly shaped numbers before looser ones
+    inline constexpr std::string_view PRIORITY[] = { "cardNumber", "phone", "passport", "ip", "email", "url" };
+
+    inline constexpr std::string_view PERSONAL[] = { "name", "passport", "personal", "identification", "id", "user" };
+    inline constexpr std::string_view SENSITIVE[] = { "confidential", "password", "token", "financial", "secret", "restricted" };
+
+    inline constexpr KeywordCategory KEYWORDS[] =
+    {
+        { "personal", PERSONAL },
+        { "sensitive", SENSITIVE }
+    };
+
+    inline std::map<std::string, std::vector<std::string>> patternMap()
+    {
+        std::map<std::string, std::vector<std::string>> patterns;
+
+        for (const auto& category : PATTERNS)
+            for (const auto& pattern : category.patterns)
+                patterns[std::string(category.name)].emplace_back(pattern.regex);
+
+        return patterns;
+    }
+
+    inline std::map<std::string, std::vector<std::string>> keywordMap()
+    {
+        std::map<std::string, std::vector<std::string>> keywords;
+
+        for (const auto& category : KEYWORDS)
+            for (const auto& keyword : category.keywords)
+                keywords[std::string(category.name)].emplace_back(keyword);
+
+        return keywords;
+    }
+
+    // Flattened views in map order, the shape CompiledMatchers stores
+
+    inline constexpr size_t KEYWORD_COUNT = []
+    {
+        size_t count = 0;
+        for (const auto& category : KEYWORDS)
+            count += category.keywords.size();
+        return count;
+    }();
+
+    inline constexpr auto KEYWORD_LIST = []
+    {
+        std::array<std::string_view, KEYWORD_COUNT> list {};
+        size_t index = 0;
+        for (const auto& category : KEYWORDS)
+            for (const auto& keyword : category.keywords)
+                list[index++] = keyword;
+        return list;
+    }();
+
+    inline constexpr auto KEYWORD_CATEGORIES = []
+    {
+        std::array<uint32_t, KEYWORD_COUNT> categories {};
+        size_t index = 0;
+        for (uint32_t category = 0; category < std::size(KEYWORDS); ++category)
+            for (size_t i = 0; i < KEYWORDS[category].keywords.size(); ++i)
+                categories[index++] = category;
+        return categories;
+    }();
+
+    inline constexpr auto KEYWORD_TABLES = StaticKeywords::build<
+        StaticKeywords::stateCount(KEYWORD_LIST), StaticKeywords::outputCount(KEYWORD_LIST)>(KEYWORD_LIST);
+
+    inline constexpr size_t PATTERN_COUNT = []
+    {
+        size_t count = 0;
+        for (const auto& category : PATTERNS)
+            count += category.patterns.size();
+        return count;
+    }();
+
+    inline constexpr size_t LITERAL_COUNT = []
+    {
+        size_t count = 0;
+        for (const auto& category : PATTERNS)
+            for (const auto& pattern : category.patterns)
+                count += !pattern.literal.empty();
+        return count;
+    }();
+
+    // Prefilter: literal i belongs to pattern LITERAL_PATTERNS[i]
+    inline constexpr auto LITERAL_LIST = []
+    {
+        std::array<std::string_view, LITERAL_COUNT> list {};
+        size_t index = 0;
+        for (const auto& category : PATTERNS)
+            for (const auto& pattern : category.patterns)
+                if (!pattern.literal.empty())
+                    list[index++] = pattern.literal;
+        return list;
+    }();
+
+    inline constexpr auto LITERAL_PATTERNS = []
+    {
+        std::array<uint32_t, LITERAL_COUNT> patterns {};
+        size_t index = 0;
+        uint32_t number = 0;
+        for (const auto& category : PATTERNS)
+            for (const auto& pattern : category.patterns)
+            {
+                if (!pattern.literal.empty())
+                    patterns[index++] = number;
+                ++number;
+            }
+        return patterns;
+    }();
+
+    inline constexpr auto LITERAL_PATTERN_BEGIN = []
+    {
+        std::array<uint32_t, LITERAL_COUNT + 1> begin {};
+        for (uint32_t i = 0; i <= LITERAL_COUNT; ++i)
+            begin[i] = i;
+        return begin;
+    }();
+
+    inline constexpr auto PATTERN_FILTERED = []
+    {
+        std::array<uint8_t, PATTERN_COUNT> filtered {};
+        size_t index = 0;
+        for (const auto& category : PATTERNS)
+            for (const auto& pattern : category.patterns)
+                filtered[index++] = pattern.literal.empty() ? 0 : 1;
+        return filtered;
+    }();
+
+    inline constexpr auto LITERAL_TABLES = StaticKeywords::build<
+        StaticKeywords::stateCount(LITERAL_LIST), StaticKeywords::outputCount(LITERAL_LIST)>(LITERAL_LIST);
+
+    static_assert([]
+    {
+        for (const auto keyword : KEYWORD_LIST)
+            for (const char c : keyword)
+                if (c >= 'A' && c <= 'Z')
+                    return false;
+        for (size_t i = 1; i < std::size(KEYWORDS); ++i)
+            if (!(KEYWORDS[i - 1].name < KEYWORDS[i].name))
+                return false;
+        for (size_t i = 1; i < std::size(PATTERNS); ++i)
+            if (!(PATTERNS[i - 1].name < PATTERNS[i].name))
+                return false;
+        for (size_t i = 0; i < LITERAL_COUNT; ++i)
+            for (size_t j = 0; j < i; ++j)
+                if (LITERAL_LIST[i] == LITERAL_LIST[j])
+                    return false;
+        return true;
+    }(), "Built-in keywords must be lowercase, categories in map order and literals distinct");
+}
+
+#endif // DEFAULTPATTERNS_H
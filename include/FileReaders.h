@@ -6,6 +6,7 @@
 #include <fstream>
 #include <libzippp/libzippp.h>
 #include "pugixml.hpp"
+#include "Cancellation.h"
 
 #include <vector>
 #include <map>
@@ -16,20 +17,50 @@
 class ReaderBase
 {
 public:
+    using ChunkHandler = std::function<void(const std::string& chunk)>;
+
     virtual std::string readText(const std::filesystem::path& filePath) = 0;
+
+    // Delivers the text in natural pieces (pages, sheets, slides) and stops
+    // early once the token is cancelled. Default: the whole text as one chunk.
+    virtual void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                            const CancellationToken& token)
+    {
+        if (!token.isCancelled())
+            onChunk(readText(filePath));
+    }
+
+    // Formats read from nothing but the file's own bytes can take them from a
+    // batched read (BatchFileReader) instead of opening the file themselves.
+    // bytesToText replaces the bytes with the text.
+    virtual bool parsesBytes() const { return false; }
+    virtual void bytesToText(std::string& data, const CancellationToken& token);
+
     virtual ~ReaderBase() {}
 };
 
 class TxtReader: public ReaderBase
 {
 public:
+    static constexpr size_t CHUNK_SIZE = 4ULL * 1024 * 1024;
+
     std::string readText(const std::filesystem::path& filePath) override;
+
+    // The bytes are the text
+    bool parsesBytes() const override { return true; }
+    void bytesToText(std::string&, const CancellationToken&) override {}
+
+    // Blocks of about CHUNK_SIZE, cut after a line break so a value is never split
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
 };
 
 class PdfReader: public ReaderBase
 {
 public:
     std::string readText(const std::filesystem::path& filePath) override;
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
 };
 
 class XmlReader: public ReaderBase
@@ -37,18 +68,28 @@ class XmlReader: public ReaderBase
 public:
     std::string readText(const std::filesystem::path& filePath) override;
 
+    bool parsesBytes() const override { return true; }
+    void bytesToText(std::string& data, const CancellationToken& token) override;
+
+    // One chunk with the text extracted until the document ends or the token is cancelled
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
+
 private:
-    void extractDataFromXml(const std::string& xmlData, std::string& data);
-    void processXmlNode(const pugi::xml_node& node, std::string& data);
+    std::string extractText(const std::filesystem::path& filePath, const CancellationToken& token);
+    void extractDataFromXml(const std::string& xmlData, std::string& data, const CancellationToken& token);
+    void processXmlNode(const pugi::xml_node& node, std::string& data, const CancellationToken& token);
 };
 
 class PptxReader: public ReaderBase
 {
 public:
     std::string readText(const std::filesystem::path& filePath) override;
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
 
 private:
-    void extractPptxData(libzippp::ZipArchive& zip, std::string& content);
+    void extractPptxData(libzippp::ZipArchive& zip, const ChunkHandler& onSlide, const CancellationToken& token);
     void extractSlideData(const std::string& xmlData, std::string& content);
     void processSlideNode(const pugi::xml_node& node, std::string& content);
 };
@@ -57,16 +98,21 @@ class DocxReader: public ReaderBase
 {
 public:
     std::string readText(const std::filesystem::path& filePath) override;
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
 private:
-    void extractDocxData(libzippp::ZipArchive& zip, std::string& resultData);
-    void extractXmlData(const std::string& xmlData, std::string& resultData);
-    void processXmlNode(const pugi::xml_node& node, std::string& resultData);
+    std::string extractText(const std::filesystem::path& filePath, const CancellationToken& token);
+    void extractDocxData(libzippp::ZipArchive& zip, std::string& resultData, const CancellationToken& token);
+    void extractXmlData(const std::string& xmlData, std::string& resultData, const CancellationToken& token);
+    void processXmlNode(const pugi::xml_node& node, std::string& resultData, const CancellationToken& token);
 };
 
 class XlsxReader: public ReaderBase
 {
 public:
     std::string readText(const std::filesystem::path& filePath) override;
+    void readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                    const CancellationToken& token) override;
 };
 
 class FileReaderFactory
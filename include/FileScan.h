@@ -0,0 +1,36 @@
+#ifndef FILESCAN_H
+#define FILESCAN_H
+
+#include "FileReaders.h"
+#include "PIIRecognizer.h"
+
+// Raw (not interned) matches of one file, for callers that outlive a scan
+// run: the C API and the scan daemon
+using RawMatches = std::map<std::string, std::vector<std::string>>;
+
+// Extracts the file chunk by chunk and scans every chunk with the strategy.
+// Extraction stops once every category is capped or the token is cancelled.
+// Holds no state, so concurrent calls only need a thread-safe strategy.
+inline RawMatches scanFileChunks(IStrategyScanner& strategy, const std::vector<std::string>& categories,
+                                 ReaderBase& reader, const std::filesystem::path& filePath,
+                                 MatchQuota& quota, CancellationToken& token)
+{
+    RawMatches matches;
+    quota.watch(token);
+
+    reader.readChunks(filePath, [&](const std::string& chunk)
+        {
+            for (auto& [type, values] : strategy.scan(chunk, quota))
+            {
+                auto& merged = matches[type];
+                merged.insert(merged.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+            }
+
+            if (quota.isSatisfied(categories))
+                token.cancel();
+        }, token);
+
+    return matches;
+}
+
+#endif // FILESCAN_H
@@ -0,0 +1,73 @@
+#ifndef FILESCHEDULER_H
+#define FILESCHEDULER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A file found by the walk, with the size seen there
+struct WalkedFile
+{
+    std::filesystem::path path;
+    uint64_t bytes = 0;
+};
+
+enum class SchedulePolicy
+{
+    Walk,       // directory iteration order
+    Size,       // largest first
+    Cost        // longest estimated scan first (ScanCostModel)
+};
+
+SchedulePolicy parseSchedulePolicy(const std::string& name);
+const char* schedulePolicyName(SchedulePolicy policy);
+
+// Seconds one file takes by type: a fixed cost plus a cost per byte, fitted by
+// least squares to the files of earlier runs. Types without enough history use
+// rough built-in rates, so a PDF still outranks a text file of the same size.
+class ScanCostModel
+{
+public:
+    static constexpr size_t MIN_FILES = 8;      // files of a type before its fit replaces the built-in rate
+
+    ScanCostModel() = default;      // built-in rates only
+
+    // History written by save(); built-in rates when the file is missing or unreadable
+    explicit ScanCostModel(const std::filesystem::path& filePath);
+
+    // History of this and earlier runs; earlier runs weigh half as much at every save
+    void save(const std::filesystem::path& filePath) const;
+
+    double estimate(const std::string& fileType, uint64_t bytes) const;
+
+    // A file of this run; called from every scan worker
+    void record(const std::string& fileType, uint64_t bytes, double seconds);
+
+private:
+    // Sums of the least-squares fit of seconds over bytes
+    struct Fit
+    {
+        double files = 0.0;
+        double bytes = 0.0;
+        double seconds = 0.0;
+        double bytesSeconds = 0.0;
+        double bytesSquared = 0.0;
+
+        void add(const Fit& other, double weight);
+    };
+
+    std::map<std::string, Fit> _history;
+    std::map<std::string, Fit> _run;
+    mutable std::mutex _mutex;
+};
+
+// Puts the files in the order they should be handed to workers. With a shared
+// queue, longest first is LPT list scheduling: the expensive documents start
+// early and the cheap files fill the gaps, instead of one large file starting
+// last and running alone.
+void scheduleFiles(std::vector<WalkedFile>& files, SchedulePolicy policy, const ScanCostModel& costs);
+
+#endif // FILESCHEDULER_H
@@ -5,14 +5,47 @@
 #include <vector>
 #include <map>
 #include <filesystem>
+#include <optional>
 
 struct GeneralConfig
 {
     std::filesystem::path inputPath;
     std::filesystem::path outputJson;
+    std::filesystem::path outputNdjson;
+    std::filesystem::path outputBinary;
+    std::string outputCompression = "none";
+    std::string consoleVerbosity = "full";
     std::filesystem::path patternConfigFile;
+    std::filesystem::path traceFile;
+    std::filesystem::path serveSocket;
+    std::filesystem::path patternCacheDir;          // empty = no matcher cache
+    std::filesystem::path redactDir;                // empty = no redacted copies
+    std::string redactStyle = "mask";
 
     bool recursive = false;
+    size_t topValues = 10;
+    size_t maxMatchesPerType = 0;
+    size_t maxMemoryMiB = 0;
+    size_t memoryBudgetMiB = 0;
+    size_t threads = 1;
+    size_t shardIndex = 0;                          // 0-based
+    size_t shardCount = 1;                          // 1 = scan the whole tree
+    std::string schedule = "cost";                  // order of files handed to the workers
+    bool ioUring = true;                            // batched reads of small TXT/XML files
+    std::vector<std::string> includeGlobs;          // empty = every supported file
+    std::vector<std::string> excludeGlobs;
+    uint64_t minFileBytes = 0;
+    uint64_t maxFileBytes = 0;                      // 0 = no limit
+    std::optional<std::filesystem::file_time_type> modifiedAfter;
+    std::optional<std::filesystem::file_time_type> modifiedBefore;
+    bool ignoreFiles = true;                        // .piiignore in the walked directories
+    double fileTimeoutSeconds = 0.0;
+    bool triage = false;
+    bool profilePatterns = false;
+    bool reloadPatterns = false;
+    bool validateMatches = true;
+    bool resolveOverlaps = true;
+    std::vector<std::string> categoryPriority;      // empty = built-in order
     std::string strategy = "regex";
 
     std::map<std::string, std::vector<std::string>> patterns;
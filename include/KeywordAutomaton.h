@@ -0,0 +1,262 @@
+#ifndef KEYWORDAUTOMATON_H
+#define KEYWORDAUTOMATON_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Aho-Corasick automaton over bytes. The tables are flat arrays of plain
+// structs, so an automaton is either built in memory or viewed in place from
+// a mapped matcher cache file (see MatcherCache.h).
+class KeywordAutomaton
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct State
+    {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        uint32_t fail;
+        uint32_t dictionary;    // nearest state on the fail chain with outputs, NONE if there is none
+        uint32_t firstOutput;
+        uint32_t outputCount;
+    };
+
+    struct Edge
+    {
+        uint32_t byte;          // edges of a state are sorted by byte
+        uint32_t target;
+    };
+
+    struct Tables
+    {
+        std::span<const State> states;
+        std::span<const Edge> edges;
+        std::span<const uint32_t> outputs;      // keyword ids ending in a state
+        std::span<const uint32_t> lengths;      // keyword id -> length
+    };
+
+    KeywordAutomaton() = default;
+    KeywordAutomaton(KeywordAutomaton&&) = default;
+    KeywordAutomaton& operator=(KeywordAutomaton&&) = default;
+    KeywordAutomaton(const KeywordAutomaton&) = delete;
+    KeywordAutomaton& operator=(const KeywordAutomaton&) = delete;
+
+    // Keyword ids are indexes into keywords; empty keywords never match
+    static KeywordAutomaton build(const std::vector<std::string>& keywords);
+
+    // Checks every index, throws std::runtime_error on a corrupted table
+    static KeywordAutomaton view(const Tables& tables);
+
+    bool empty() const noexcept { return _tables.lengths.empty(); }
+    size_t keywordCount() const noexcept { return _tables.lengths.size(); }
+    size_t keywordLength(uint32_t keyword) const noexcept { return _tables.lengths[keyword]; }
+    const Tables& tables() const noexcept { return _tables; }
+
+    // Calls onMatch(keyword, begin) for every occurrence, by end position;
+    // stops as soon as onMatch returns false
+    template<typename OnMatch>
+    void scan(std::string_view text, OnMatch&& onMatch) const
+    {
+        if (empty())
+            return;
+
+        uint32_t state = 0;
+
+        for (size_t pos = 0; pos < text.size(); ++pos)
+        {
+            state = next(state, static_cast<unsigned char>(text[pos]));
+
+            for (uint32_t match = state; match != NONE; match = _tables.states[match].dictionary)
+            {
+                const auto& matched = _tables.states[match];
+
+                for (uint32_t i = 0; i < matched.outputCount; ++i)
+                {
+                    const uint32_t keyword = _tables.outputs[matched.firstOutput + i];
+
+                    if (!onMatch(keyword, pos + 1 - _tables.lengths[keyword]))
+                        return;
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t next(uint32_t state, unsigned char byte) const noexcept
+    {
+        while (state != 0)
+        {
+            const auto& current = _tables.states[state];
+            const Edge* first = _tables.edges.data() + current.firstEdge;
+            const Edge* last = first + current.edgeCount;
+
+            // Dictionary tries fan out near the root only
+            if (current.edgeCount > 8)
+            {
+                const Edge* edge = std::lower_bound(first, last, byte,
+                    [](const Edge& lhs, unsigned char value) { return lhs.byte < value; });
+
+                if (edge != last && edge->byte == byte)
+                    return edge->target;
+            }
+            else
+            {
+                for (const Edge* edge = first; edge != last && edge->byte <= byte; ++edge)
+                    if (edge->byte == byte)
+                        return edge->target;
+            }
+
+            state = current.fail;
+        }
+
+        return _rootNext[byte];
+    }
+
+    void buildRootTable();
+
+    Tables _tables;
+    std::array<uint32_t, 256> _rootNext {};
+
+    // Backing storage of a built automaton; empty for a view
+    std::vector<State> _states;
+    std::vector<Edge> _edges;
+    std::vector<uint32_t> _outputs;
+    std::vector<uint32_t> _lengths;
+};
+
+// Automaton tables computed by the compiler for a keyword list known at build
+// time (the built-in keywords), laid out exactly like KeywordAutomaton::build().
+template<size_t KeywordCount, size_t StateCount, size_t OutputCount>
+struct StaticKeywordTables
+{
+    std::array<KeywordAutomaton::State, StateCount> states {};
+    std::array<KeywordAutomaton::Edge, StateCount - 1> edges {};
+    std::array<uint32_t, OutputCount> outputs {};
+    std::array<uint32_t, KeywordCount> lengths {};
+
+    KeywordAutomaton::Tables tables() const noexcept { return { states, edges, outputs, lengths }; }
+};
+
+namespace StaticKeywords
+{
+    // Root plus one state per distinct non-empty prefix
+    template<size_t KeywordCount>
+    constexpr size_t stateCount(const std::array<std::string_view, KeywordCount>& keywords)
+    {
+        size_t count = 1;
+
+        for (size_t i = 0; i < KeywordCount; ++i)
+        {
+            for (size_t length = 1; length <= keywords[i].size(); ++length)
+            {
+                bool seen = false;
+
+                for (size_t j = 0; j < i && !seen; ++j)
+                    seen = keywords[j].substr(0, length) == keywords[i].substr(0, length);
+
+                if (!seen)
+                    ++count;
+            }
+        }
+
+        return count;
+    }
+
+    template<size_t KeywordCount>
+    constexpr size_t outputCount(const std::array<std::string_view, KeywordCount>& keywords)
+    {
+        return static_cast<size_t>(std::count_if(keywords.begin(), keywords.end(),
+            [](std::string_view keyword) { return !keyword.empty(); }));
+    }
+
+    template<size_t StateCount, size_t OutputCount, size_t KeywordCount>
+    constexpr auto build(const std::array<std::string_view, KeywordCount>& keywords)
+    {
+        StaticKeywordTables<KeywordCount, StateCount, OutputCount> result;
+
+        // Dense trie while building; 0 means no child since the root is nobody's child
+        std::array<std::array<uint32_t, 256>, StateCount> children {};
+        std::array<uint32_t, KeywordCount> endState {};
+        uint32_t states = 1;
+
+        for (size_t id = 0; id < KeywordCount; ++id)
+        {
+            uint32_t state = 0;
+
+            for (const char c : keywords[id])
+            {
+                auto& child = children[state][static_cast<unsigned char>(c)];
+                if (child == 0)
+                    child = states++;
+                state = child;
+            }
+
+            endState[id] = state;
+            result.lengths[id] = static_cast<uint32_t>(keywords[id].size());
+        }
+
+        uint32_t edge = 0;
+        uint32_t output = 0;
+
+        for (uint32_t state = 0; state < StateCount; ++state)
+        {
+            auto& flat = result.states[state];
+            flat.firstEdge = edge;
+            flat.fail = 0;
+            flat.dictionary = KeywordAutomaton::NONE;
+            flat.firstOutput = output;
+
+            for (uint32_t byte = 0; byte < 256; ++byte)
+                if (children[state][byte] != 0)
+                    result.edges[edge++] = { byte, children[state][byte] };
+
+            for (uint32_t id = 0; id < KeywordCount; ++id)
+                if (!keywords[id].empty() && endState[id] == state)
+                    result.outputs[output++] = id;
+
+            flat.edgeCount = edge - flat.firstEdge;
+            flat.outputCount = output - flat.firstOutput;
+        }
+
+        std::array<uint32_t, StateCount> queue {};
+        size_t tail = 0;
+
+        for (uint32_t byte = 0; byte < 256; ++byte)
+            if (children[0][byte] != 0)
+                queue[tail++] = children[0][byte];
+
+        for (size_t head = 0; head < tail; ++head)
+        {
+            const uint32_t state = queue[head];
+
+            for (uint32_t byte = 0; byte < 256; ++byte)
+            {
+                const uint32_t child = children[state][byte];
+                if (child == 0)
+                    continue;
+
+                uint32_t fail = result.states[state].fail;
+                while (fail != 0 && children[fail][byte] == 0)
+                    fail = result.states[fail].fail;
+
+                auto& target = result.states[child];
+                target.fail = children[fail][byte];
+
+                const auto& failState = result.states[target.fail];
+                target.dictionary = failState.outputCount != 0 ? target.fail : failState.dictionary;
+
+                queue[tail++] = child;
+            }
+        }
+
+        return result;
+    }
+}
+
+#endif // KEYWORDAUTOMATON_H
@@ -0,0 +1,116 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Log-bucketed latency histogram: 8 linear sub-buckets per power of two
+// (~12% relative error), nanosecond resolution, fixed 4 KiB footprint.
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        uint64_t count = 0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        std::vector<std::pair<uint32_t, uint64_t>> buckets;     // non-empty (bucket, count), merge() takes them back
+    };
+
+    void record(double seconds, uint64_t count = 1)
+    {
+        const auto nanos = seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e9) : 0;
+
+        _buckets[bucketOf(nanos)] += count;
+        _count += count;
+        _maxNanos = std::max(_maxNanos, nanos);
+    }
+
+    // Adds the buckets of another histogram's summary, as written to a partial result;
+    // percentiles of the sum are as exact as those of one histogram that saw everything
+    void merge(const std::vector<std::pair<uint32_t, uint64_t>>& buckets, double maxSeconds)
+    {
+        for (const auto& [bucket, count] : buckets)
+        {
+            if (bucket >= BUCKET_COUNT)
+                throw std::out_of_range("Latency bucket out of range: " + std::to_string(bucket));
+
+            _buckets[bucket] += count;
+            _count += count;
+        }
+
+        _maxNanos = std::max(_maxNanos, static_cast<uint64_t>(std::max(0.0, maxSeconds) * 1e9));
+    }
+
+    Summary summary() const
+    {
+        Summary summary { _count, percentile(0.50), percentile(0.95), percentile(0.99), _maxNanos / 1e9, {} };
+
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+            if (_buckets[bucket] != 0)
+                summary.buckets.emplace_back(static_cast<uint32_t>(bucket), _buckets[bucket]);
+
+        return summary;
+    }
+
+private:
+    static constexpr size_t SUB_BITS = 3;
+    static constexpr size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static constexpr size_t LINEAR_LIMIT = SUB_COUNT * 2;
+    static constexpr size_t BUCKET_COUNT = LINEAR_LIMIT + (64 - SUB_BITS - 1) * SUB_COUNT;
+
+    static size_t bucketOf(uint64_t nanos)
+    {
+        if (nanos < LINEAR_LIMIT)
+            return static_cast<size_t>(nanos);
+
+        const auto exponent = static_cast<size_t>(std::bit_width(nanos) - 1);
+        const auto sub = static_cast<size_t>(nanos >> (exponent - SUB_BITS)) & (SUB_COUNT - 1);
+        return LINEAR_LIMIT + (exponent - SUB_BITS - 1) * SUB_COUNT + sub;
+    }
+
+    // Midpoint of the bucket, in nanoseconds
+    static double bucketValue(size_t bucket)
+    {
+        if (bucket < LINEAR_LIMIT)
+            return static_cast<double>(bucket);
+
+        const auto exponent = (bucket - LINEAR_LIMIT) / SUB_COUNT + SUB_BITS + 1;
+        const auto sub = (bucket - LINEAR_LIMIT) % SUB_COUNT;
+        const auto width = static_cast<double>(uint64_t(1) << (exponent - SUB_BITS));
+        return static_cast<double>(uint64_t(1) << exponent) + (static_cast<double>(sub) + 0.5) * width;
+    }
+
+    double percentile(double quantile) const
+    {
+        if (_count == 0)
+            return 0.0;
+
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(_count))));
+        uint64_t seen = 0;
+
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+        {
+            seen += _buckets[bucket];
+            if (seen >= rank)
+                return std::min(bucketValue(bucket), static_cast<double>(_maxNanos)) / 1e9;
+        }
+
+        return _maxNanos / 1e9;
+    }
+
+    std::array<uint64_t, BUCKET_COUNT> _buckets {};
+    uint64_t _count = 0;
+    uint64_t _maxNanos = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,178 @@
+#ifndef MATCHINTERNER_H
+#define MATCHINTERNER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Run-wide table of distinct match values. Ids are dense (0..size()-1) and
+// stable for the whole run; value(id) is lock-free for ids already handed out.
+class MatchInterner
+{
+public:
+    using Id = uint32_t;
+
+    struct TopValue
+    {
+        std::string value;
+        uint64_t occurrences;
+        uint64_t files;
+    };
+
+    MatchInterner(): _chunks(std::make_unique<std::atomic<Entry*>[]>(MAX_CHUNKS))
+    {
+        for (size_t i = 0; i < MAX_CHUNKS; ++i)
+            _chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~MatchInterner()
+    {
+        for (size_t i = 0; i < MAX_CHUNKS; ++i)
+            delete[] _chunks[i].load(std::memory_order_relaxed);
+    }
+
+    MatchInterner(const MatchInterner&) = delete;
+    MatchInterner& operator=(const MatchInterner&) = delete;
+
+    // Interns every match of one file, counting occurrences and distinct files
+    std::map<std::string, std::vector<Id>> internFile(const std::map<std::string, std::vector<std::string>>& matches)
+    {
+        std::map<std::string, std::vector<Id>> result;
+        std::vector<Id> fileIds;
+
+        for (const auto& [type, values] : matches)
+        {
+            auto& ids = result[type];
+            ids.reserve(values.size());
+
+            for (const auto& value : values)
+                ids.push_back(intern(value));
+
+            fileIds.insert(fileIds.end(), ids.begin(), ids.end());
+        }
+
+        std::sort(fileIds.begin(), fileIds.end());
+        fileIds.erase(std::unique(fileIds.begin(), fileIds.end()), fileIds.end());
+
+        for (const auto id : fileIds)
+            entry(id).files.fetch_add(1, std::memory_order_relaxed);
+
+        return result;
+    }
+
+    Id intern(std::string_view value)
+    {
+        auto& shard = _shards[std::hash<std::string_view>{}(value) % SHARD_COUNT];
+        std::lock_guard lock(shard.mutex);
+
+        if (auto it = shard.index.find(value); it != shard.index.end())
+        {
+            entry(it->second).occurrences.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+
+        const auto id = allocate();
+        auto& newEntry = entry(id);
+        newEntry.value.assign(value);
+        newEntry.occurrences.store(1, std::memory_order_relaxed);
+
+        shard.index.emplace(newEntry.value, id);
+        return id;
+    }
+
+    std::string_view value(Id id) const
+    {
+        return entry(id).value;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size.load(std::memory_order_acquire);
+    }
+
+    // Most frequent values by occurrence count; meant for the end of a run
+    std::vector<TopValue> top(size_t count) const
+    {
+        std::vector<Id> ids(size());
+        for (Id id = 0; id < ids.size(); ++id)
+            ids[id] = id;
+
+        const auto shown = std::min(count, ids.size());
+        auto occurrences = [this](Id id) { return entry(id).occurrences.load(std::memory_order_relaxed); };
+
+        std::partial_sort(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(shown), ids.end(),
+            [&occurrences](Id lhs, Id rhs) { return occurrences(lhs) > occurrences(rhs); });
+
+        std::vector<TopValue> result;
+        result.reserve(shown);
+
+        for (size_t i = 0; i < shown; ++i)
+        {
+            const auto& topEntry = entry(ids[i]);
+            result.push_back({ topEntry.value,
+                               topEntry.occurrences.load(std::memory_order_relaxed),
+                               topEntry.files.load(std::memory_order_relaxed) });
+        }
+
+        return result;
+    }
+
+private:
+    static constexpr size_t SHARD_COUNT = 64;
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 16;
+
+    struct Entry
+    {
+        std::string value;
+        std::atomic<uint64_t> occurrences { 0 };
+        std::atomic<uint64_t> files { 0 };
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, Id> index;
+    };
+
+    Entry& entry(Id id) const
+    {
+        return _chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+
+    Id allocate()
+    {
+        std::lock_guard lock(_allocMutex);
+
+        const auto id = _size.load(std::memory_order_relaxed);
+        const auto chunk = id >> CHUNK_BITS;
+
+        if (chunk >= MAX_CHUNKS)
+            throw std::overflow_error("Too many distinct match values");
+
+        if (!_chunks[chunk].load(std::memory_order_relaxed))
+            _chunks[chunk].store(new Entry[CHUNK_SIZE], std::memory_order_release);
+
+        _size.store(id + 1, std::memory_order_release);
+        return static_cast<Id>(id);
+    }
+
+    std::array<Shard, SHARD_COUNT> _shards;
+    std::unique_ptr<std::atomic<Entry*>[]> _chunks;
+    std::mutex _allocMutex;
+    std::atomic<size_t> _size { 0 };
+};
+
+using PIIMatches = std::map<std::string, std::vector<MatchInterner::Id>>;
+
+#endif // MATCHINTERNER_H
@@ -0,0 +1,48 @@
+#ifndef MATCHRESOLVER_H
+#define MATCHRESOLVER_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// A match as a byte range of the scanned text, before it becomes a string
+struct MatchSpan
+{
+    size_t begin;
+    size_t end;
+    uint32_t category;      // index of the category in map order
+};
+
+// Decides which of several matches covering the same text is reported.
+// Within a category overlapping matches collapse into the one that starts
+// first (the longest of those); across categories the one whose category
+// comes first in the priority list wins, so "3782 822463 10005" is an Amex
+// card and not a passport number followed by noise.
+class MatchResolver
+{
+public:
+    MatchResolver() = default;      // disabled: every match is reported
+
+    // Categories listed first win; unlisted ones rank after, in map order
+    explicit MatchResolver(std::vector<std::string> priority): _enabled(true), _priority(std::move(priority)) {}
+
+    // Priority of the built-in categories (DefaultPatterns::PRIORITY)
+    static MatchResolver defaults();
+
+    bool isEnabled() const noexcept { return _enabled; }
+    const std::vector<std::string>& priority() const noexcept { return _priority; }
+
+    // Rank of each category (lower wins), for categories given in map order
+    std::vector<uint32_t> ranks(const std::vector<std::string>& categories) const;
+
+    // Keeps the winning spans, sorted by begin. One sort plus one sweep:
+    // kept spans never overlap, so a new span can only collide with the last one.
+    void resolve(std::vector<MatchSpan>& spans, std::span<const uint32_t> ranks) const;
+
+private:
+    bool _enabled = false;
+    std::vector<std::string> _priority;
+};
+
+#endif // MATCHRESOLVER_H
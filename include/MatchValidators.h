@@ -0,0 +1,90 @@
+#ifndef MATCHVALIDATORS_H
+#define MATCHVALIDATORS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Second opinion on regex matches of one category: a regex finds text shaped
+// like a card number or an IP address, a validator rejects the ones that
+// cannot be one (bad check digit, octet out of range, ...). RegexStrategy
+// hands matches over in batches before they are counted against the quota.
+class IMatchValidator
+{
+public:
+    static constexpr size_t BATCH_SIZE = 64;
+
+    virtual ~IMatchValidator() = default;
+    virtual std::string name() const = 0;
+
+    // valid[i] = 1 when matches[i] passes, 0 otherwise; at most BATCH_SIZE matches
+    virtual void validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const = 0;
+};
+
+// Luhn check digit over 12 to 19 digits; spaces and dashes between them are ignored
+class LuhnValidator: public IMatchValidator
+{
+public:
+    std::string name() const override { return "luhn"; }
+    void validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const override;
+};
+
+// Dotted quad of decimal octets 0-255 without leading zeros, first octet not 0
+class IpOctetValidator: public IMatchValidator
+{
+public:
+    std::string name() const override { return "ip-octets"; }
+    void validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const override;
+};
+
+// Passport numbers carry no check digit outside the MRZ, so this rejects what
+// cannot be issued: a Russian series with region 00, an all-zero number, ten
+// identical digits
+class PassportValidator: public IMatchValidator
+{
+public:
+    std::string name() const override { return "passport"; }
+    void validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const override;
+};
+
+// E.164 length (8-15 digits) plus numbering plan rules for +7 (Russia and
+// Kazakhstan: no area code starts with 0, 1, 2 or 5) and +1 (area code and
+// exchange start with 2-9)
+class PhoneValidator: public IMatchValidator
+{
+public:
+    std::string name() const override { return "phone"; }
+    void validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const override;
+};
+
+// Validators by pattern category. Cheap to copy, validators are shared.
+class MatchValidators
+{
+public:
+    MatchValidators() = default;    // none: every match is reported
+
+    // Validators of the built-in categories: cardNumber, ip, passport, phone.
+    // A --pattern-config that reuses these names gets them too.
+    static MatchValidators defaults();
+
+    void add(const std::string& category, std::shared_ptr<const IMatchValidator> validator)
+    {
+        _validators[category] = std::move(validator);
+    }
+
+    const IMatchValidator* find(const std::string& category) const
+    {
+        const auto it = _validators.find(category);
+        return it != _validators.end() ? it->second.get() : nullptr;
+    }
+
+    bool empty() const noexcept { return _validators.empty(); }
+
+private:
+    std::map<std::string, std::shared_ptr<const IMatchValidator>> _validators;
+};
+
+#endif // MATCHVALIDATORS_H
@@ -0,0 +1,152 @@
+#ifndef MATCHERCACHE_H
+#define MATCHERCACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "KeywordAutomaton.h"
+
+// Matcher cache file (.piim), native byte order, sections 8-byte aligned like .piib.
+// One file holds the prebuilt tables of one pattern set and is named after
+// its fingerprint, so an edited config simply misses and writes a new file.
+namespace PIIMatcherCache
+{
+    inline constexpr char MAGIC[4] = { 'P', 'I', 'I', 'M' };
+    inline constexpr uint32_t VERSION = 1;
+
+    // Shorter literals would let nearly every text through the prefilter
+    inline constexpr int MIN_ATOM_LENGTH = 3;
+
+    enum Section : uint32_t
+    {
+        KeywordStates,
+        KeywordEdges,
+        KeywordOutputs,
+        KeywordLengths,
+        KeywordCategories,  // u32 per keyword -> index of its category in map order
+        AtomStates,
+        AtomEdges,
+        AtomOutputs,
+        AtomLengths,
+        AtomPatternBegin,   // u32[atomCount + 1]
+        AtomPatterns,       // u32 -> pattern number in map order
+        PatternFiltered,    // u8 per pattern
+        SectionCount
+    };
+
+    struct SectionRef
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t fingerprint;
+        SectionRef sections[SectionCount];
+    };
+}
+
+// Prebuilt matcher tables for one set of patterns and keywords:
+//  - the keyword strategy's automaton over every lowercased keyword;
+//  - the regex strategy's prefilter: the literals (RE2 "atoms") that every
+//    match of a pattern contains, in one automaton. A filtered pattern is only
+//    run on text where at least one of its atoms occurs.
+// Built in memory or mapped read-only from a cache file; immutable either way.
+class CompiledMatchers
+{
+public:
+    using PatternMap = std::map<std::string, std::vector<std::string>>;
+
+    ~CompiledMatchers();
+
+    CompiledMatchers(const CompiledMatchers&) = delete;
+    CompiledMatchers& operator=(const CompiledMatchers&) = delete;
+
+    static std::shared_ptr<const CompiledMatchers> build(const PatternMap& patterns, const PatternMap& keywords);
+
+    // The built-in pattern set (DefaultPatterns.h), viewed from tables the compiler built
+    static std::shared_ptr<const CompiledMatchers> defaults();
+    static uint64_t defaultFingerprint();
+
+    // Throws std::runtime_error when the file is not a valid cache for this fingerprint
+    static std::shared_ptr<const CompiledMatchers> load(const std::filesystem::path& filePath, uint64_t fingerprint);
+
+    // Writes to a temporary file and renames it, so readers never see a partial file
+    void save(const std::filesystem::path& filePath) const;
+
+    static uint64_t fingerprint(const PatternMap& patterns, const PatternMap& keywords);
+
+    uint64_t fingerprint() const noexcept { return _fingerprint; }
+    bool isMapped() const noexcept { return _mapping != nullptr; }
+    bool isBuiltIn() const noexcept { return _builtIn; }
+
+    const KeywordAutomaton& keywords() const noexcept { return _keywords; }
+    std::span<const uint32_t> keywordCategories() const noexcept { return _keywordCategories; }
+
+    const KeywordAutomaton& atoms() const noexcept { return _atoms; }
+    std::span<const uint32_t> atomPatternBegin() const noexcept { return _atomPatternBegin; }
+    std::span<const uint32_t> atomPatterns() const noexcept { return _atomPatterns; }
+    std::span<const uint8_t> patternFiltered() const noexcept { return _patternFiltered; }
+    bool hasFilteredPatterns() const noexcept { return !_atoms.empty(); }
+
+private:
+    CompiledMatchers() = default;
+
+    std::string_view bytes(PIIMatcherCache::Section section) const;
+    template<typename T>
+    std::span<const T> column(PIIMatcherCache::Section section) const;
+
+    uint64_t _fingerprint = 0;
+
+    KeywordAutomaton _keywords;
+    std::span<const uint32_t> _keywordCategories;
+
+    KeywordAutomaton _atoms;
+    std::span<const uint32_t> _atomPatternBegin;
+    std::span<const uint32_t> _atomPatterns;
+    std::span<const uint8_t> _patternFiltered;
+
+    // Backing storage: a built set owns vectors, a loaded one the mapping
+    std::vector<uint32_t> _ownKeywordCategories;
+    std::vector<uint32_t> _ownAtomPatternBegin;
+    std::vector<uint32_t> _ownAtomPatterns;
+    std::vector<uint8_t> _ownPatternFiltered;
+
+    const char* _mapping = nullptr;
+    size_t _mappingSize = 0;
+    bool _builtIn = false;
+};
+
+// Directory of .piim files. get() maps the file of the pattern set when it is
+// there and valid, otherwise builds the tables and stores them for next time;
+// cache I/O problems never fail a scan, they only cost the rebuild. The
+// built-in set needs neither and is served from CompiledMatchers::defaults().
+class MatcherCache
+{
+public:
+    MatcherCache() = default;   // disabled: every get() builds in memory
+    explicit MatcherCache(std::filesystem::path directory): _directory(std::move(directory)) {}
+
+    // $XDG_CACHE_HOME/piiscanner, else ~/.cache/piiscanner; empty when neither is set
+    static std::filesystem::path defaultDirectory();
+
+    bool isEnabled() const noexcept { return !_directory.empty(); }
+    const std::filesystem::path& directory() const noexcept { return _directory; }
+
+    std::shared_ptr<const CompiledMatchers> get(const CompiledMatchers::PatternMap& patterns,
+                                                const CompiledMatchers::PatternMap& keywords) const;
+
+    std::filesystem::path fileFor(uint64_t fingerprint) const;
+
+private:
+    std::filesystem::path _directory;
+};
+
+#endif // MATCHERCACHE_H
@@ -0,0 +1,94 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+// Heap accounting through the global operator new/delete hooks in
+// MemoryAccounting.cpp. Counters are per thread, so a scope measures what
+// its own thread allocates; memory malloc'ed directly by C libraries
+// (libzip, zlib) is only visible in the RSS figures.
+namespace MemoryAccounting
+{
+    struct ThreadCounters
+    {
+        uint64_t allocatedBytes = 0;    // monotonic
+        uint64_t allocations = 0;
+        int64_t liveBytes = 0;          // may go negative when other threads free our blocks
+        int64_t peakLiveBytes = 0;
+        int64_t limitLiveBytes = 0;     // 0 = no budget
+    };
+
+    ThreadCounters& threadCounters() noexcept;
+
+    uint64_t currentRssBytes();
+    uint64_t peakRssBytes();
+}
+
+class MemoryBudgetExceeded: public std::bad_alloc
+{
+public:
+    const char* what() const noexcept override { return "per-file memory budget exceeded"; }
+};
+
+// Measures the bytes allocated and the peak live heap of the current thread
+// between construction and stop(). With a budget, allocations that would
+// raise the live heap more than budgetBytes above the starting level throw
+// MemoryBudgetExceeded.
+class AllocationScope
+{
+public:
+    explicit AllocationScope(uint64_t budgetBytes = 0)
+        : _counters(MemoryAccounting::threadCounters()),
+          _startAllocated(_counters.allocatedBytes),
+          _startLive(_counters.liveBytes),
+          _outerPeak(_counters.peakLiveBytes),
+          _outerLimit(_counters.limitLiveBytes)
+    {
+        _counters.peakLiveBytes = _counters.liveBytes;
+
+        if (budgetBytes != 0)
+        {
+            const auto limit = _startLive + static_cast<int64_t>(budgetBytes);
+            _counters.limitLiveBytes = _outerLimit != 0 ? std::min(_outerLimit, limit) : limit;
+        }
+    }
+
+    ~AllocationScope()
+    {
+        stop();
+    }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    void stop() noexcept
+    {
+        if (_stopped)
+            return;
+
+        _stopped = true;
+        _allocatedBytes = _counters.allocatedBytes - _startAllocated;
+        _peakBytes = static_cast<uint64_t>(std::max<int64_t>(0, _counters.peakLiveBytes - _startLive));
+
+        _counters.peakLiveBytes = std::max(_outerPeak, _counters.peakLiveBytes);
+        _counters.limitLiveBytes = _outerLimit;
+    }
+
+    uint64_t allocatedBytes() const noexcept { return _allocatedBytes; }
+    uint64_t peakBytes() const noexcept { return _peakBytes; }
+
+private:
+    MemoryAccounting::ThreadCounters& _counters;
+    uint64_t _startAllocated;
+    int64_t _startLive;
+    int64_t _outerPeak;
+    int64_t _outerLimit;
+
+    bool _stopped = false;
+    uint64_t _allocatedBytes = 0;
+    uint64_t _peakBytes = 0;
+};
+
+#endif // MEMORYACCOUNTING_H
@@ -0,0 +1,163 @@
+#ifndef OUTPUTWRITERS_H
+#define OUTPUTWRITERS_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class OutputCompression
+{
+    None,
+    Gzip,
+    Zstd
+};
+
+OutputCompression parseCompression(const std::string& name);
+
+class IOutputSink
+{
+public:
+    virtual ~IOutputSink() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() = 0;
+    virtual void close() = 0;
+};
+
+class FileSink: public IOutputSink
+{
+public:
+    explicit FileSink(const std::filesystem::path& filePath);
+    ~FileSink() override;
+
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    void close() override;
+
+private:
+    std::filesystem::path _filePath;
+    std::FILE* _file = nullptr;
+};
+
+// Writes to a stream owned by someone else (stdout, stderr)
+class StreamSink: public IOutputSink
+{
+public:
+    explicit StreamSink(std::FILE* stream): _stream(stream) {}
+
+    void write(const char* data, size_t size) override;
+    void flush() override { std::fflush(_stream); }
+    void close() override { flush(); }
+
+private:
+    std::FILE* _stream;
+};
+
+std::unique_ptr<IOutputSink> createOutputSink(const std::filesystem::path& filePath, OutputCompression compression);
+
+// Accumulates small appends and hands them to the sink in large batches
+class BufferedWriter
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4ULL * 1024 * 1024;
+
+    explicit BufferedWriter(std::unique_ptr<IOutputSink> sink, size_t capacity = DEFAULT_CAPACITY)
+        : _sink(std::move(sink)), _capacity(capacity)
+    {
+        _buffer.reserve(_capacity);
+    }
+
+    ~BufferedWriter()
+    {
+        try { close(); } catch (...) {}
+    }
+
+    std::string& buffer() noexcept { return _buffer; }
+
+    void append(std::string_view data)
+    {
+        _buffer.append(data);
+        commit();
+    }
+
+    // Call after writing into buffer() directly
+    void commit()
+    {
+        if (_buffer.size() >= _capacity)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!_sink)
+            return;
+
+        if (!_buffer.empty())
+            _sink->write(_buffer.data(), _buffer.size());
+
+        _buffer.clear();
+        _sink->flush();
+    }
+
+    void close()
+    {
+        if (!_sink)
+            return;
+
+        flush();
+        _sink->close();
+        _sink.reset();
+    }
+
+private:
+    std::unique_ptr<IOutputSink> _sink;
+    size_t _capacity;
+    std::string _buffer;
+};
+
+// Moves writes to a dedicated thread; producers only pay for a queue push.
+// Output is batched while the queue is busy and flushed as soon as it drains.
+class AsyncWriter
+{
+public:
+    static constexpr size_t MAX_PENDING_BYTES = 64ULL * 1024 * 1024;
+
+    explicit AsyncWriter(std::unique_ptr<IOutputSink> sink, size_t capacity = BufferedWriter::DEFAULT_CAPACITY);
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // Blocks only when more than MAX_PENDING_BYTES are waiting for the sink
+    void submit(std::string&& text);
+
+    // Drains the queue, flushes and stops the writer thread
+    void close();
+
+private:
+    void run();
+
+    BufferedWriter _writer;
+    std::mutex _mutex;
+    std::condition_variable _hasWork;
+    std::condition_variable _hasSpace;
+    std::vector<std::string> _pending;
+    size_t _pendingBytes = 0;
+    bool _stopping = false;
+    std::thread _thread;
+};
+
+namespace JsonText
+{
+    // Appends a quoted JSON string; invalid UTF-8 is replaced with U+FFFD
+    void appendString(std::string& out, std::string_view value);
+    void appendNumber(std::string& out, double value);
+    void appendNumber(std::string& out, long long value);
+}
+
+#endif // OUTPUTWRITERS_H
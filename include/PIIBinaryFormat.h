@@ -0,0 +1,170 @@
+#ifndef PIIBINARYFORMAT_H
+#define PIIBINARYFORMAT_H
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Column-oriented results file (.piib), little-endian, sections 8-byte aligned.
+//
+//   Header | section* ...
+//
+// String tables: u64 count, u64 offsets[count + 1], char data[]
+// File columns are indexed by file number, match columns by match number;
+// matches of file i are [fileMatchBegin[i], fileMatchBegin[i + 1]).
+namespace PIIBinary
+{
+    inline constexpr char MAGIC[4] = { 'P', 'I', 'I', 'B' };
+    inline constexpr uint32_t VERSION = 1;
+
+    enum Section : uint32_t
+    {
+        PathStrings,
+        DirectoryStrings,
+        CategoryStrings,
+        ValueStrings,
+        FilePath,           // u32 -> PathStrings
+        FileDirectory,      // u32 -> DirectoryStrings
+        FileDuration,       // f64
+        FileTimestamp,      // i64
+        FileMatchBegin,     // u64[fileCount + 1]
+        MatchCategory,      // u32 -> CategoryStrings
+        MatchValue,         // u32 -> ValueStrings
+        StatisticsJson,     // UTF-8 JSON object
+        SectionCount
+    };
+
+    struct SectionRef
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t fileCount;
+        uint64_t matchCount;
+        SectionRef sections[SectionCount];
+    };
+
+    class StringTable
+    {
+    public:
+        StringTable() = default;
+        StringTable(const char* base, uint64_t size);
+
+        size_t size() const noexcept { return _count; }
+        std::string_view operator[](size_t index) const noexcept
+        {
+            return { _data + _offsets[index], static_cast<size_t>(_offsets[index + 1] - _offsets[index]) };
+        }
+
+    private:
+        size_t _count = 0;
+        const uint64_t* _offsets = nullptr;
+        const char* _data = nullptr;
+    };
+}
+
+// Accumulates columns and dictionaries in memory, writes the file in one pass.
+// Match values arrive as ids into a table owned by the caller.
+class PIIBinaryWriter
+{
+public:
+    using ValueLookup = std::function<std::string_view(uint32_t)>;
+
+    void addFile(const std::filesystem::path& filePath, double duration, int64_t timestamp);
+    void addMatch(std::string_view category, uint32_t valueId);
+    void write(const std::filesystem::path& outputFile, size_t valueCount, const ValueLookup& value,
+               std::string_view statisticsJson) const;
+
+private:
+    class Dictionary
+    {
+    public:
+        uint32_t intern(std::string_view value);
+        const std::deque<std::string>& strings() const noexcept { return _strings; }
+
+    private:
+        std::deque<std::string> _strings;
+        std::unordered_map<std::string_view, uint32_t> _index;
+    };
+
+    Dictionary _paths;
+    Dictionary _directories;
+    Dictionary _categories;
+
+    std::vector<uint32_t> _filePath;
+    std::vector<uint32_t> _fileDirectory;
+    std::vector<double> _fileDuration;
+    std::vector<int64_t> _fileTimestamp;
+    std::vector<uint64_t> _fileMatchBegin;
+    std::vector<uint32_t> _matchCategory;
+    std::vector<uint32_t> _matchValue;
+};
+
+// Read-only mmap view of a .piib file; accessors do not copy or parse.
+// Every id and match range is checked once on open, so they can be used
+// as indexes without further checks.
+class PIIBinaryResult
+{
+public:
+    explicit PIIBinaryResult(const std::filesystem::path& filePath);
+    ~PIIBinaryResult();
+
+    PIIBinaryResult(const PIIBinaryResult&) = delete;
+    PIIBinaryResult& operator=(const PIIBinaryResult&) = delete;
+
+    size_t fileCount() const noexcept { return _header->fileCount; }
+    size_t matchCount() const noexcept { return _header->matchCount; }
+
+    const PIIBinary::StringTable& paths() const noexcept { return _paths; }
+    const PIIBinary::StringTable& directories() const noexcept { return _directories; }
+    const PIIBinary::StringTable& categories() const noexcept { return _categories; }
+    const PIIBinary::StringTable& values() const noexcept { return _values; }
+
+    std::span<const uint32_t> filePaths() const noexcept { return _filePath; }
+    std::span<const uint32_t> fileDirectories() const noexcept { return _fileDirectory; }
+    std::span<const double> fileDurations() const noexcept { return _fileDuration; }
+    std::span<const int64_t> fileTimestamps() const noexcept { return _fileTimestamp; }
+    std::span<const uint64_t> fileMatchBegin() const noexcept { return _fileMatchBegin; }
+    std::span<const uint32_t> matchCategories() const noexcept { return _matchCategory; }
+    std::span<const uint32_t> matchValues() const noexcept { return _matchValue; }
+
+    std::string_view statisticsJson() const noexcept { return _statistics; }
+
+private:
+    template<typename T>
+    std::span<const T> column(PIIBinary::Section section, size_t expectedCount) const;
+    std::string_view bytes(PIIBinary::Section section) const;
+    static void validateIds(std::span<const uint32_t> ids, const PIIBinary::StringTable& table,
+                            PIIBinary::Section section);
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+    const PIIBinary::Header* _header = nullptr;
+
+    PIIBinary::StringTable _paths;
+    PIIBinary::StringTable _directories;
+    PIIBinary::StringTable _categories;
+    PIIBinary::StringTable _values;
+
+    std::span<const uint32_t> _filePath;
+    std::span<const uint32_t> _fileDirectory;
+    std::span<const double> _fileDuration;
+    std::span<const int64_t> _fileTimestamp;
+    std::span<const uint64_t> _fileMatchBegin;
+    std::span<const uint32_t> _matchCategory;
+    std::span<const uint32_t> _matchValue;
+    std::string_view _statistics;
+};
+
+#endif // PIIBINARYFORMAT_H
@@ -1,31 +1,111 @@
 #ifndef PIIDETECTOR_H
 #define PIIDETECTOR_H
 
+#include <chrono>
 #include "PIIRecognizer.h"
+#include "MatchInterner.h"
+#include "StrategySlot.h"
+#include "TraceRecorder.h"
 
 class PIIDetector
 {
 public:
-    explicit PIIDetector(std::unique_ptr<IStrategyScanner> strategy): _strategy(std::move(strategy)) {}
+    PIIDetector(std::unique_ptr<IStrategyScanner> strategy, MatchInterner& values)
+        : _strategies(std::move(strategy)), _values(values) {}
 
     struct DetectorResult
     {
-        std::map<std::string, std::vector<std::string>> matches;
+        PIIMatches matches;
         double duration;
     };
 
+    // Raw matches of a file scanned piece by piece, interned once in finish().
+    // The first chunk pins the strategy, so a reload never splits a file.
+    struct PartialResult
+    {
+        std::map<std::string, std::vector<std::string>> matches;
+        double duration = 0.0;
+        std::shared_ptr<const StrategySlot::Snapshot> strategy;
+    };
+
     DetectorResult scan(const std::string& data)
     {
+        MatchQuota unlimited;
+        return scan(data, unlimited);
+    }
+
+    DetectorResult scan(const std::string& data, MatchQuota& quota)
+    {
+        PartialResult partial;
+        scanChunk(data, quota, partial);
+        return finish(std::move(partial));
+    }
+
+    void scanChunk(const std::string& data, MatchQuota& quota, PartialResult& partial)
+    {
+        PIIS_TRACE_SPAN("detect");
+
+        if (!partial.strategy)
+            partial.strategy = _strategies.current();
+
         auto start = std::chrono::high_resolution_clock::now();
-        auto results = _strategy->scan(data);
-        auto duration = std::chrono::duration<double>(
+        auto results = partial.strategy->strategy->scan(data, quota);
+        partial.duration += std::chrono::duration<double>(
             std::chrono::high_resolution_clock::now() - start).count();
 
-        return { std::move(results), duration };
+        for (auto& [type, values] : results)
+        {
+            auto& merged = partial.matches[type];
+            merged.insert(merged.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        }
     }
 
+    // scanChunk that also returns where the matches are in data, for redaction.
+    // Only matches that begin before settledBytes are kept: the caller scans the
+    // rest of data again together with what follows it.
+    std::vector<MatchSpan> scanChunkSpans(const std::string& data, MatchQuota& quota, PartialResult& partial,
+                                          size_t settledBytes = std::string::npos)
+    {
+        PIIS_TRACE_SPAN("detect");
+
+        if (!partial.strategy)
+            partial.strategy = _strategies.current();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        auto spans = partial.strategy->strategy->findSpans(data, quota);
+        partial.duration += std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        std::erase_if(spans, [settledBytes](const MatchSpan& span) { return span.begin >= settledBytes; });
+
+        for (const auto& span : spans)
+            partial.matches[partial.strategy->categories[span.category]].emplace_back(data, span.begin, span.end - span.begin);
+
+        return spans;
+    }
+
+    DetectorResult finish(PartialResult&& partial)
+    {
+        return { _values.internFile(partial.matches), partial.duration };
+    }
+
+    std::string strategyName() const
+    {
+        return _strategies.current()->strategy->name();
+    }
+
+    // Every category of the file's strategy has reached the quota, the rest of the file can be skipped
+    bool isSatisfied(const MatchQuota& quota, const PartialResult& partial) const
+    {
+        return partial.strategy && quota.isSatisfied(partial.strategy->categories);
+    }
+
+    // Target of pattern reloads
+    StrategySlot& strategies() noexcept { return _strategies; }
+
 private:
-    std::unique_ptr<IStrategyScanner> _strategy;
+    StrategySlot _strategies;
+    MatchInterner& _values;
 };
 
-#endif // PIIDETECTOR_H
\ No newline at end of file
+#endif // PIIDETECTOR_H
@@ -1,16 +1,63 @@
 #ifndef PIIGENERALSTATS_H
 #define PIIGENERALSTATS_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
 #include <nlohmann/json.hpp>
+#include "LatencyHistogram.h"
+#include "MatchInterner.h"
+#include "PatternProfiler.h"
+#include "MemoryAccounting.h"
+
+enum class ScanStage
+{
+    Walk,
+    Admit,
+    Stat,
+    Read,
+    Detect,
+    Export,
+    Count
+};
+
+inline const char* stageName(ScanStage stage)
+{
+    static constexpr const char* names[] = { "walk", "admit", "stat", "read", "detect", "export" };
+    return names[static_cast<size_t>(stage)];
+}
+
+// Per-file measurements collected by PIIFileProcess
+struct FileMetrics
+{
+    std::string filePath;
+    std::string fileType;
+    std::string strategy;
+    uint64_t bytes = 0;
+    double statSeconds = 0.0;
+    double readSeconds = 0.0;
+
+    // Heap use of readText and PIIDetector::scan, see AllocationScope
+    uint64_t readAllocatedBytes = 0;
+    uint64_t readPeakBytes = 0;
+    uint64_t detectAllocatedBytes = 0;
+    uint64_t detectPeakBytes = 0;
+    uint64_t peakBytes = 0;         // whole file: text, raw matches and reader internals
+    uint64_t rssBytes = 0;          // process RSS once the file is done
+    bool streamed = false;          // took the low-memory chunked path
+    bool timedOut = false;          // hit --file-timeout, the matches are partial
+};
 
 class PIIGeneralStats
 {
 public:
-    PIIGeneralStats() = default;
+    explicit PIIGeneralStats(const MatchInterner& values, size_t topValueCount = 10, size_t topMemoryCount = 10)
+        : _values(values), _topValueCount(topValueCount), _topMemoryCount(topMemoryCount) {}
 
-    void addRecord(const std::map<std::string, std::vector<std::string>>& results, double duration)
+    void addRecord(const PIIMatches& results, double duration)
     {
         totalFiles++;
         totalDuration += duration;
@@ -22,6 +69,99 @@ public:
         }
     }
 
+    void addFileMetrics(const FileMetrics& metrics, double detectSeconds)
+    {
+        addStageTime(ScanStage::Stat, metrics.statSeconds);
+        addStageTime(ScanStage::Read, metrics.readSeconds);
+        addStageTime(ScanStage::Detect, detectSeconds);
+
+        auto& fileType = _fileTypes[metrics.fileType];
+        fileType.files++;
+        fileType.bytes += metrics.bytes;
+        fileType.readSeconds += metrics.readSeconds;
+        fileType.readLatency.record(metrics.readSeconds);
+        fileType.fileLatency.record(metrics.statSeconds + metrics.readSeconds + detectSeconds);
+        fileType.readAllocatedBytes += metrics.readAllocatedBytes;
+        fileType.peakBytes += metrics.peakBytes;
+        fileType.maxPeakBytes = std::max(fileType.maxPeakBytes, metrics.peakBytes);
+
+        _strategyLatency[metrics.strategy].record(detectSeconds);
+        addMemoryHungryFile(metrics);
+
+        if (metrics.streamed)
+            _streamedFiles++;
+
+        if (metrics.timedOut)
+            _timedOutFiles.push_back(metrics.filePath);
+    }
+
+    void addStageTime(ScanStage stage, double seconds)
+    {
+        _stageSeconds[static_cast<size_t>(stage)] += seconds;
+    }
+
+    // Part of a multi-node scan (--shard), recorded so a merge can check it has every part
+    void setShard(size_t index, size_t count)
+    {
+        _shardIndex = index;
+        _shardCount = count;
+    }
+
+    // How well the workers were kept busy: their summed file time against threads x wall time
+    void setSchedule(std::string policy, size_t threads, double wallSeconds, double busySeconds, double longestFileSeconds)
+    {
+        _schedule = { std::move(policy), threads, wallSeconds, busySeconds, longestFileSeconds, 0.0, 0.0 };
+
+        const double capacity = static_cast<double>(threads) * wallSeconds;
+        if (capacity > 0.0)
+            _schedule.efficiency = std::min(1.0, busySeconds / capacity);
+
+        // No order finishes before the busy time spread evenly, nor before the longest file
+        const double bestWall = std::max(busySeconds / std::max<size_t>(threads, 1), longestFileSeconds);
+        if (threads > 0 && bestWall > 0.0)
+            _schedule.bestEfficiency = std::min(1.0, busySeconds / (static_cast<double>(threads) * bestWall));
+    }
+
+    // Adds the per-pattern cost ranking to the report (--profile-patterns)
+    void setPatternProfiler(const PatternProfiler* profiler, size_t count = 10)
+    {
+        _profiler = profiler;
+        _patternCostCount = count;
+    }
+
+    struct FileTypeSummary
+    {
+        size_t files;
+        uint64_t bytes;
+        double readSeconds;
+        double megabytesPerSecond;
+        LatencyHistogram::Summary readLatency;
+        LatencyHistogram::Summary fileLatency;
+        uint64_t avgReadAllocatedBytes;
+        uint64_t avgPeakBytes;
+        uint64_t maxPeakBytes;
+    };
+
+    struct ScheduleSummary
+    {
+        std::string policy;             // empty when no files were scanned
+        size_t threads;
+        double wallSeconds;
+        double busySeconds;             // file time summed over workers
+        double longestFileSeconds;
+        double efficiency;              // busy / (threads x wall)
+        double bestEfficiency;          // bound from the longest file and an even spread
+    };
+
+    struct FileMemory
+    {
+        std::string filePath;
+        std::string fileType;
+        uint64_t peakBytes;
+        uint64_t allocatedBytes;
+        uint64_t rssBytes;
+    };
+
     struct Stats
     {
         size_t totalFiles;
@@ -29,25 +169,130 @@ public:
         double totalDuration;
         double avgDuration;
         std::map<std::string, size_t> piiCounts;
+        size_t distinctValues;
+        std::vector<MatchInterner::TopValue> topValues;
+        std::vector<std::pair<std::string, double>> stageSeconds;   // pipeline order
+        std::map<std::string, FileTypeSummary> fileTypes;
+        std::map<std::string, LatencyHistogram::Summary> strategyLatency;
+        std::vector<PatternProfiler::PatternCost> patternCosts;    // most expensive first
+        uint64_t peakRssBytes;
+        std::vector<FileMemory> memoryHungryFiles;                  // highest peak first
+        size_t streamedFiles;                                       // over the --memory-budget
+        std::vector<std::string> timedOutFiles;                     // partial results, in scan order
+        size_t shardIndex;                                          // 0-based, of shardCount
+        size_t shardCount;                                          // 1 = the whole tree
+        ScheduleSummary schedule;
     };
 
     Stats getStats() const
     {
-        return
+        Stats stats
         {
             totalFiles,
             totalPII,
             totalDuration,
             totalFiles > 0 ? totalDuration / totalFiles : 0.0,
-            piiCounts
+            piiCounts,
+            _values.size(),
+            _values.top(_topValueCount),
+            {},
+            {},
+            {},
+            _profiler ? _profiler->report(_patternCostCount) : std::vector<PatternProfiler::PatternCost> {},
+            MemoryAccounting::peakRssBytes(),
+            _memoryHungryFiles,
+            _streamedFiles,
+            _timedOutFiles,
+            _shardIndex,
+            _shardCount,
+            _schedule
         };
+
+        std::sort(stats.memoryHungryFiles.begin(), stats.memoryHungryFiles.end(),
+            [](const FileMemory& lhs, const FileMemory& rhs) { return lhs.peakBytes > rhs.peakBytes; });
+
+        for (size_t stage = 0; stage < _stageSeconds.size(); ++stage)
+            stats.stageSeconds.emplace_back(stageName(static_cast<ScanStage>(stage)), _stageSeconds[stage]);
+
+        for (const auto& [type, fileType] : _fileTypes)
+        {
+            stats.fileTypes[type] =
+            {
+                fileType.files,
+                fileType.bytes,
+                fileType.readSeconds,
+                fileType.readSeconds > 0.0 ? fileType.bytes / (1024.0 * 1024.0) / fileType.readSeconds : 0.0,
+                fileType.readLatency.summary(),
+                fileType.fileLatency.summary(),
+                fileType.files > 0 ? fileType.readAllocatedBytes / fileType.files : 0,
+                fileType.files > 0 ? fileType.peakBytes / fileType.files : 0,
+                fileType.maxPeakBytes
+            };
+        }
+
+        for (const auto& [strategy, histogram] : _strategyLatency)
+            stats.strategyLatency[strategy] = histogram.summary();
+
+        return stats;
     }
 
 private:
+    struct FileTypeAccumulator
+    {
+        size_t files = 0;
+        uint64_t bytes = 0;
+        double readSeconds = 0.0;
+        LatencyHistogram readLatency;
+        LatencyHistogram fileLatency;
+        uint64_t readAllocatedBytes = 0;
+        uint64_t peakBytes = 0;
+        uint64_t maxPeakBytes = 0;
+    };
+
+    // Keeps the _topMemoryCount files with the highest peak heap
+    void addMemoryHungryFile(const FileMetrics& metrics)
+    {
+        if (_topMemoryCount == 0)
+            return;
+
+        auto lowest = [](const FileMemory& lhs, const FileMemory& rhs) { return lhs.peakBytes > rhs.peakBytes; };
+
+        if (_memoryHungryFiles.size() == _topMemoryCount)
+        {
+            if (metrics.peakBytes <= _memoryHungryFiles.front().peakBytes)
+                return;
+
+            std::pop_heap(_memoryHungryFiles.begin(), _memoryHungryFiles.end(), lowest);
+            _memoryHungryFiles.pop_back();
+        }
+
+        _memoryHungryFiles.push_back({ metrics.filePath, metrics.fileType, metrics.peakBytes,
+            metrics.readAllocatedBytes + metrics.detectAllocatedBytes, metrics.rssBytes });
+        std::push_heap(_memoryHungryFiles.begin(), _memoryHungryFiles.end(), lowest);
+    }
+
+    const MatchInterner& _values;
+    size_t _topValueCount;
+    size_t _topMemoryCount;
+
     size_t totalFiles = 0;
     size_t totalPII = 0;
     double totalDuration = 0.0;
     std::map<std::string, size_t> piiCounts;
+
+    std::array<double, static_cast<size_t>(ScanStage::Count)> _stageSeconds {};
+    std::map<std::string, FileTypeAccumulator> _fileTypes;
+    std::map<std::string, LatencyHistogram> _strategyLatency;
+
+    const PatternProfiler* _profiler = nullptr;
+    size_t _patternCostCount = 10;
+
+    std::vector<FileMemory> _memoryHungryFiles;     // min-heap on peakBytes
+    size_t _streamedFiles = 0;
+    std::vector<std::string> _timedOutFiles;
+    size_t _shardIndex = 0;
+    size_t _shardCount = 1;
+    ScheduleSummary _schedule {};
 };
 
 #endif // PIIGENERALSTATS_H
@@ -1,10 +1,71 @@
 #ifndef PIISCANNER_H
 #define PIISCANNER_H
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <regex>
 #include <re2/re2.h>
+#include "Cancellation.h"
+#include "MatchResolver.h"
+#include "MatchValidators.h"
+#include "MatcherCache.h"
+#include "PatternProfiler.h"
+#include "SpecializedMatchers.h"
+
+// Per-file cap on matches of each type, shared by every chunk of the file.
+// A watched token that gets cancelled exhausts every type, so strategies stop
+// between patterns and matches without knowing about timeouts.
+class MatchQuota
+{
+public:
+    static constexpr size_t UNLIMITED = 0;
+
+    explicit MatchQuota(size_t perType = UNLIMITED): _perType(perType) {}
+
+    bool isLimited() const noexcept { return _perType != UNLIMITED; }
+
+    size_t remaining(const std::string& type) const
+    {
+        if (!isLimited())
+            return std::numeric_limits<size_t>::max();
+
+        auto it = _used.find(type);
+        const size_t used = it != _used.end() ? it->second : 0;
+        return used < _perType ? _perType - used : 0;
+    }
+
+    void watch(const CancellationToken& token) noexcept { _token = &token; }
+
+    bool isCancelled() const noexcept { return _token && _token->isCancelled(); }
+
+    bool isExhausted(const std::string& type) const { return isCancelled() || remaining(type) == 0; }
+
+    void consume(const std::string& type, size_t count = 1)
+    {
+        if (isLimited())
+            _used[type] += count;
+    }
+
+    // True once every listed type has reached its cap
+    bool isSatisfied(const std::vector<std::string>& types) const
+    {
+        if (!isLimited() || types.empty())
+            return false;
+
+        for (const auto& type : types)
+            if (!isExhausted(type))
+                return false;
+
+        return true;
+    }
+
+private:
+    size_t _perType;
+    std::map<std::string, size_t> _used;
+    const CancellationToken* _token = nullptr;
+};
 
 class IStrategyScanner
 {
@@ -12,71 +73,169 @@ public:
     virtual ~IStrategyScanner() = default;
     virtual void onStart() {}
     virtual void onStop() {}
-    virtual std::map<std::string, std::vector<std::string>> scan(const std::string& text) = 0;
+    virtual std::string name() const = 0;
+    virtual std::vector<std::string> categories() const = 0;
+    virtual std::map<std::string, std::vector<std::string>> scan(const std::string& text, MatchQuota& quota) = 0;
+
+    // Where the matches of scan() are: byte ranges of text, category an index into categories().
+    // Redaction rewrites these ranges of the file.
+    virtual std::vector<MatchSpan> findSpans(const std::string& text, MatchQuota& quota) = 0;
+
+    // Registers every pattern with the profiler and times them from now on
+    virtual void enableProfiling(PatternProfiler& /*profiler*/) {}
+
+    std::map<std::string, std::vector<std::string>> scan(const std::string& text)
+    {
+        MatchQuota unlimited;
+        return scan(text, unlimited);
+    }
 };
 
 class RegexStrategy: public IStrategyScanner
 {
 public:
-    explicit RegexStrategy(const std::map<std::string, std::vector<std::string>>& patterns)
+    // Without matchers (or with ones built for other patterns) the prefilter is built here.
+    // Matches of a category with a validator are only reported when they pass it,
+    // and the resolver picks one match where several cover the same text.
+    explicit RegexStrategy(const std::map<std::string, std::vector<std::string>>& patterns,
+                           std::shared_ptr<const CompiledMatchers> matchers = nullptr,
+                           MatchValidators validators = MatchValidators::defaults(),
+                           MatchResolver resolver = MatchResolver::defaults())
+        : _validators(std::move(validators)), _resolver(std::move(resolver))
     {
+        size_t patternCount = 0;
+
         for (const auto& [type, regexList] : patterns)
         {
             for (const auto& pattern : regexList)
             {
-                auto re = std::make_unique<re2::RE2>(pattern);
+                CompiledPattern compiled { pattern, nullptr, findSpecializedMatcher(pattern) };
 
-                if (!re->ok())
-                    throw std::invalid_argument("Invalid regex pattern: " + pattern +
-                                              " (error: " + re->error() + ")");
+                if (!compiled.matcher)
+                {
+                    compiled.re = std::make_unique<re2::RE2>(pattern);
 
-                _cmpPatterns[type].push_back(std::move(re));
+                    if (!compiled.re->ok())
+                        throw std::invalid_argument("Invalid regex pattern: " + pattern +
+                                                  " (error: " + compiled.re->error() + ")");
+                }
+
+                _cmpPatterns[type].push_back(std::move(compiled));
+                ++patternCount;
             }
 
+            _categoryNames.push_back(type);
         }
+
+        _categoryRanks = _resolver.ranks(_categoryNames);
+
+        if (!matchers || matchers->patternFiltered().size() != patternCount)
+            matchers = CompiledMatchers::build(patterns, {});
+
+        _matchers = std::move(matchers);
     }
 
-    std::map<std::string, std::vector<std::string>> scan(const std::string& text) override;
+    using IStrategyScanner::scan;
+    std::string name() const override { return "regex"; }
+    std::vector<std::string> categories() const override;
+    std::map<std::string, std::vector<std::string>> scan(const std::string& text, MatchQuota& quota) override;
+    std::vector<MatchSpan> findSpans(const std::string& text, MatchQuota& quota) override;
+    void enableProfiling(PatternProfiler& profiler) override;
 
 private:
-    std::map<std::string, std::vector<std::unique_ptr<re2::RE2>>> _cmpPatterns;
+    // Pattern numbers (map order) that may match text: unfiltered ones and those with an atom in it
+    std::vector<uint8_t> candidatePatterns(const std::string& text) const;
+
+    // Built-in patterns with a hand-written scanner skip RE2 altogether.
+    // A pattern without a capturing group reports its whole match.
+    struct CompiledPattern
+    {
+        std::string pattern;
+        std::unique_ptr<re2::RE2> re;
+        SpecializedMatcher matcher = nullptr;
+    };
+
+    std::map<std::string, std::vector<CompiledPattern>> _cmpPatterns;
+    std::shared_ptr<const CompiledMatchers> _matchers;
+    MatchValidators _validators;
+    MatchResolver _resolver;
+    std::vector<std::string> _categoryNames;
+    std::vector<uint32_t> _categoryRanks;
+    std::map<std::string, std::vector<PatternProfiler::Id>> _profileIds;
+    PatternProfiler::Id _prefilterProfileId = 0;
+    PatternProfiler* _profiler = nullptr;
 };
 
 class KeywordStrategy: public IStrategyScanner
 {
 public:
-    explicit KeywordStrategy(const std::map<std::string, std::vector<std::string>>& keywords)
+    // Without matchers (or with ones built for other keywords) the automaton is built here
+    explicit KeywordStrategy(const std::map<std::string, std::vector<std::string>>& keywords,
+                             std::shared_ptr<const CompiledMatchers> matchers = nullptr)
         : _keywords(keywords)
     {
+        size_t keywordCount = 0;
+
         for (auto& [category, words] : _keywords)
         {
-            for (auto& word : words)
-            {
-                std::string lowerWord = word;
-                std::transform(lowerWord.begin(), lowerWord.end(), lowerWord.begin(),
-                               [](unsigned char c) { return std::tolower(c); });
-                _lowerKeywords[category].push_back(lowerWord);
-            }
+            _categoryNames.push_back(category);
+            keywordCount += words.size();
         }
+
+        if (!matchers || matchers->keywords().keywordCount() != keywordCount ||
+            !std::all_of(matchers->keywordCategories().begin(), matchers->keywordCategories().end(),
+                         [this](uint32_t category) { return category < _categoryNames.size(); }))
+            matchers = CompiledMatchers::build({}, keywords);
+
+        _matchers = std::move(matchers);
     }
 
-    std::map<std::string, std::vector<std::string>> scan(const std::string& text) override;
+    using IStrategyScanner::scan;
+    std::string name() const override { return "keyword"; }
+    std::vector<std::string> categories() const override;
+    std::map<std::string, std::vector<std::string>> scan(const std::string& text, MatchQuota& quota) override;
+    std::vector<MatchSpan> findSpans(const std::string& text, MatchQuota& quota) override;
+    void enableProfiling(PatternProfiler& profiler) override;
 
 private:
     std::map<std::string, std::vector<std::string>> _keywords; // ???
-    std::map<std::string, std::vector<std::string>> _lowerKeywords;
+    std::vector<std::string> _categoryNames;
+    std::shared_ptr<const CompiledMatchers> _matchers;
+    PatternProfiler::Id _profileId = 0;
+    PatternProfiler* _profiler = nullptr;
 };
 
 struct PIIStrategyHandler
 {
-    static std::unique_ptr<IStrategyScanner> createRegexStrategy(const std::map<std::string, std::vector<std::string>>& patterns)
+    static std::unique_ptr<IStrategyScanner> createRegexStrategy(const std::map<std::string, std::vector<std::string>>& patterns,
+                                                                 std::shared_ptr<const CompiledMatchers> matchers = nullptr,
+                                                                 MatchValidators validators = MatchValidators::defaults(),
+                                                                 MatchResolver resolver = MatchResolver::defaults())
     {
-        return std::make_unique<RegexStrategy>(patterns);
+        return std::make_unique<RegexStrategy>(patterns, std::move(matchers), std::move(validators), std::move(resolver));
     }
 
-    static std::unique_ptr<IStrategyScanner> createKeywordStrategy(const std::map<std::string, std::vector<std::string>>& keywords)
+    static std::unique_ptr<IStrategyScanner> createKeywordStrategy(const std::map<std::string, std::vector<std::string>>& keywords,
+                                                                   std::shared_ptr<const CompiledMatchers> matchers = nullptr)
     {
-        return std::make_unique<KeywordStrategy>(keywords);
+        return std::make_unique<KeywordStrategy>(keywords, std::move(matchers));
+    }
+
+    // By --strategy name; used at start-up and when patterns are reloaded.
+    // Prebuilt tables come from the cache when it has them for this pattern set.
+    static std::unique_ptr<IStrategyScanner> createStrategy(const std::string& name,
+        const std::map<std::string, std::vector<std::string>>& patterns,
+        const std::map<std::string, std::vector<std::string>>& keywords,
+        const MatcherCache& cache = {},
+        const MatchValidators& validators = MatchValidators::defaults(),
+        const MatchResolver& resolver = MatchResolver::defaults())
+    {
+        if (name == "regex")
+            return createRegexStrategy(patterns, cache.get(patterns, keywords), validators, resolver);
+        if (name == "keyword")
+            return createKeywordStrategy(keywords, cache.get(patterns, keywords));
+
+        throw std::invalid_argument("Unsupported strategy type: " + name);
     }
 };
 
@@ -2,6 +2,8 @@
 #define PIIRESULTEXPORTER_H
 
 #include "PIIGeneralStats.h"
+#include "OutputWriters.h"
+#include "PIIBinaryFormat.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -13,33 +15,99 @@ class IPIIResultExporter
 public:
     virtual ~IPIIResultExporter() = default;
     virtual void processFileResults(const std::filesystem::path& filePath,
-        const std::map<std::string, std::vector<std::string>>& results, double duration) = 0;
+        const PIIMatches& results, double duration) = 0;
 
     virtual void finalize(const PIIGeneralStats::Stats& stats) = 0;
 };
 
+// Formats on the calling thread, writes to stdout from a dedicated writer thread
 class ConsoleExporter : public IPIIResultExporter
 {
 public:
+    enum class Verbosity
+    {
+        Full,       // every match of every file
+        Line,       // one line per file
+        Summary     // final summary only
+    };
+
+    static Verbosity parseVerbosity(const std::string& name);
+
+    explicit ConsoleExporter(const MatchInterner& values, Verbosity verbosity = Verbosity::Full);
+
     void processFileResults(const std::filesystem::path& filePath,
-        const std::map<std::string, std::vector<std::string>>& results, double duration) override;
+        const PIIMatches& results, double duration) override;
 
     void finalize(const PIIGeneralStats::Stats& stats) override;
+
+private:
+    const MatchInterner& _values;
+    Verbosity _verbosity;
+    AsyncWriter _writer;
 };
 
 class JsonExporter : public IPIIResultExporter
 {
 public:
-    explicit JsonExporter(const std::filesystem::path& outputFile);
+    JsonExporter(const std::filesystem::path& outputFile, const MatchInterner& values);
     ~JsonExporter();
 
     void processFileResults(const std::filesystem::path& filePath,
-        const std::map<std::string, std::vector<std::string>>& results, double duration) override;
+        const PIIMatches& results, double duration) override;
 
     void finalize(const PIIGeneralStats::Stats& stats) override;
 private:
     std::filesystem::path outputFile;
+    const MatchInterner& _values;
     nlohmann::json jsonData;
 };
 
+// JSON Lines: one record per scanned file, statistics record last. Records
+// are formatted under the result handler's lock and handed over in batches
+// of SUBMIT_BYTES: compression and writes run on the writer's thread.
+class NdjsonExporter : public IPIIResultExporter
+{
+public:
+    NdjsonExporter(const std::filesystem::path& outputFile, const MatchInterner& values,
+        OutputCompression compression = OutputCompression::None);
+
+    void processFileResults(const std::filesystem::path& filePath,
+        const PIIMatches& results, double duration) override;
+
+    void finalize(const PIIGeneralStats::Stats& stats) override;
+
+    static void appendRecord(std::string& out, const std::filesystem::path& filePath,
+        const PIIMatches& results, const MatchInterner& values, double duration);
+
+    // Same record shape for matches that were never interned (scan daemon)
+    static void appendRecord(std::string& out, const std::filesystem::path& filePath,
+        const std::map<std::string, std::vector<std::string>>& results, double duration);
+
+private:
+    static constexpr size_t SUBMIT_BYTES = 256 * 1024;
+
+    const MatchInterner& _values;
+    std::string _pending;
+    AsyncWriter _writer;
+};
+
+// Column-oriented .piib file, see PIIBinaryFormat.h; match values are
+// written as interned ids with the run's value table as dictionary
+class BinaryExporter : public IPIIResultExporter
+{
+public:
+    BinaryExporter(const std::filesystem::path& outputFile, const MatchInterner& values)
+        : _outputFile(outputFile), _values(values) {}
+
+    void processFileResults(const std::filesystem::path& filePath,
+        const PIIMatches& results, double duration) override;
+
+    void finalize(const PIIGeneralStats::Stats& stats) override;
+
+private:
+    std::filesystem::path _outputFile;
+    const MatchInterner& _values;
+    PIIBinaryWriter _writer;
+};
+
 #endif // PIIRESULTEXPORTER_H
\ No newline at end of file
@@ -1,13 +1,17 @@
 #ifndef PIIRESULTHANDLER_H
 #define PIIRESULTHANDLER_H
 
+#include <mutex>
 #include "PIIGeneralStats.h"
+#include "TraceRecorder.h"
 
+// Called from every scan worker; stats and exporters are updated under one lock.
+// Exporters only format or collect under it, file output runs on writer threads.
 class PIIResultHandler
 {
 public:
     explicit PIIResultHandler(std::vector<std::unique_ptr<IPIIResultExporter>> exporters,
-        std::unique_ptr<PIIGeneralStats> stats = std::make_unique<PIIGeneralStats>())
+        std::unique_ptr<PIIGeneralStats> stats)
         : _stats(std::move(stats)), _exporters(std::move(exporters))
     {
         if (_exporters.empty())
@@ -15,16 +19,39 @@ public:
     }
 
     void processResult(const std::filesystem::path& filePath,
-        const PIIDetector::DetectorResult& result)
+        const PIIDetector::DetectorResult& result, const FileMetrics& metrics)
     {
+        std::lock_guard lock(_mutex);
+
         _stats->addRecord(result.matches, result.duration);
+        _stats->addFileMetrics(metrics, result.duration);
+
+        PIIS_TRACE_SPAN("export");
+        auto start = std::chrono::steady_clock::now();
 
         for (auto& exporter : _exporters)
             exporter->processFileResults(filePath, result.matches, result.duration);
+
+        _stats->addStageTime(ScanStage::Export, std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    void recordStageTime(ScanStage stage, double seconds)
+    {
+        std::lock_guard lock(_mutex);
+        _stats->addStageTime(stage, seconds);
+    }
+
+    void recordSchedule(std::string policy, size_t threads, double wallSeconds, double busySeconds, double longestFileSeconds)
+    {
+        std::lock_guard lock(_mutex);
+        _stats->setSchedule(std::move(policy), threads, wallSeconds, busySeconds, longestFileSeconds);
     }
 
     void finalize()
     {
+        PIIS_TRACE_SPAN("finalize");
+        std::lock_guard lock(_mutex);
         auto stats = _stats->getStats();
 
         for (auto& exporter: _exporters)
@@ -32,6 +59,7 @@ public:
     }
 
 private:
+    std::mutex _mutex;
     std::unique_ptr<PIIGeneralStats> _stats;
     std::vector<std::unique_ptr<IPIIResultExporter>> _exporters;
 };
@@ -0,0 +1,85 @@
+#ifndef PATHFILTER_H
+#define PATHFILTER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Which entries of a directory walk are scanned: include and exclude globs,
+// .piiignore files, and windows on file size and modification time.
+//
+// Globs follow .gitignore rules: one without a slash matches a name at any
+// depth, one with a slash is anchored to the directory it applies to, "**"
+// spans directories, a trailing slash matches directories only and "!" keeps
+// what an earlier line excluded. Every set of globs is compiled into one
+// RE2::Set, so a path is tested against all of them in a single pass. An
+// excluded directory is pruned: the walker never lists what is below it.
+class PathFilter
+{
+public:
+    static constexpr const char* IGNORE_FILE = ".piiignore";
+
+    struct Options
+    {
+        std::vector<std::string> include;       // files to scan, relative to the walked directory; empty = all
+        std::vector<std::string> exclude;       // files and directories to skip; ignore files cannot bring them back
+        uint64_t minBytes = 0;
+        uint64_t maxBytes = 0;                  // 0 = no limit
+        std::optional<std::filesystem::file_time_type> modifiedAfter;
+        std::optional<std::filesystem::file_time_type> modifiedBefore;
+        bool ignoreFiles = true;                // read IGNORE_FILE in every directory walked
+    };
+
+    // Throws std::invalid_argument for a glob that does not compile
+    explicit PathFilter(Options options);
+    ~PathFilter();
+
+    PathFilter(const PathFilter&) = delete;
+    PathFilter& operator=(const PathFilter&) = delete;
+
+    class GlobSet;
+
+    // The state of one walk: the ignore files of the directories above the
+    // current entry. Entries must come in walk order, every directory before
+    // what is below it, with their depth under the root (0 = in the root).
+    class Walk
+    {
+    public:
+        Walk(const PathFilter& filter, const std::filesystem::path& root);
+        ~Walk();
+
+        // False when the directory is excluded and must not be descended into
+        bool entersDirectory(const std::filesystem::path& directory, const std::filesystem::path& relative, int depth);
+
+        // Globs and ignore files; checked before the file is stat'ed
+        bool acceptsPath(const std::filesystem::path& relative, int depth);
+
+        // Size and modification time
+        bool acceptsFile(const std::filesystem::directory_entry& entry, uint64_t bytes) const;
+
+    private:
+        struct IgnoreFile
+        {
+            int depth;                          // of the entries it applies to
+            std::string base;                   // its directory, relative to the root
+            std::unique_ptr<GlobSet> globs;
+        };
+
+        void leaveDirectories(int depth);
+        bool excludes(const std::string& relative, bool isDirectory) const;
+        void loadIgnoreFile(const std::filesystem::path& directory, std::string base, int depth);
+
+        const PathFilter& _filter;
+        std::vector<IgnoreFile> _ignoreFiles;   // outermost first
+    };
+
+private:
+    Options _options;
+    std::unique_ptr<GlobSet> _include;
+    std::unique_ptr<GlobSet> _exclude;
+};
+
+#endif // PATHFILTER_H
@@ -0,0 +1,96 @@
+#ifndef PATTERNPROFILER_H
+#define PATTERNPROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Opt-in per-pattern cost accounting for strategies (--profile-patterns).
+// Patterns are registered once at setup; counters are updated lock-free.
+class PatternProfiler
+{
+public:
+    using Id = size_t;
+
+    struct PatternCost
+    {
+        std::string strategy;
+        std::string category;
+        std::string pattern;
+        double seconds;
+        uint64_t bytesScanned;
+        uint64_t matches;
+        uint64_t calls;
+        int programSize;        // RE2 program size, 0 for keywords and specialized matchers
+        int64_t memoryBudget;   // RE2 max_mem, 0 for keywords
+    };
+
+    Id registerPattern(const std::string& strategy, const std::string& category, const std::string& pattern,
+                       int programSize = 0, int64_t memoryBudget = 0)
+    {
+        auto& entry = _entries.emplace_back();
+        entry.strategy = strategy;
+        entry.category = category;
+        entry.pattern = pattern;
+        entry.programSize = programSize;
+        entry.memoryBudget = memoryBudget;
+        return _entries.size() - 1;
+    }
+
+    void record(Id id, uint64_t nanos, uint64_t bytes, uint64_t matches)
+    {
+        auto& entry = _entries[id];
+        entry.nanos.fetch_add(nanos, std::memory_order_relaxed);
+        entry.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        entry.matches.fetch_add(matches, std::memory_order_relaxed);
+        entry.calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool isEmpty() const noexcept { return _entries.empty(); }
+
+    // Most expensive patterns first
+    std::vector<PatternCost> report(size_t count) const
+    {
+        std::vector<PatternCost> costs;
+        costs.reserve(_entries.size());
+
+        for (const auto& entry : _entries)
+        {
+            costs.push_back({ entry.strategy, entry.category, entry.pattern,
+                              entry.nanos.load(std::memory_order_relaxed) / 1e9,
+                              entry.bytes.load(std::memory_order_relaxed),
+                              entry.matches.load(std::memory_order_relaxed),
+                              entry.calls.load(std::memory_order_relaxed),
+                              entry.programSize, entry.memoryBudget });
+        }
+
+        std::sort(costs.begin(), costs.end(),
+            [](const PatternCost& lhs, const PatternCost& rhs) { return lhs.seconds > rhs.seconds; });
+
+        if (costs.size() > count)
+            costs.resize(count);
+
+        return costs;
+    }
+
+private:
+    struct Entry
+    {
+        std::string strategy;
+        std::string category;
+        std::string pattern;
+        int programSize = 0;
+        int64_t memoryBudget = 0;
+        std::atomic<uint64_t> nanos { 0 };
+        std::atomic<uint64_t> bytes { 0 };
+        std::atomic<uint64_t> matches { 0 };
+        std::atomic<uint64_t> calls { 0 };
+    };
+
+    std::deque<Entry> _entries;
+};
+
+#endif // PATTERNPROFILER_H
@@ -0,0 +1,59 @@
+#ifndef PATTERNRELOADER_H
+#define PATTERNRELOADER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include "MatchResolver.h"
+#include "MatchValidators.h"
+#include "MatcherCache.h"
+#include "StrategySlot.h"
+
+// Rebuilds the strategy from the --pattern-config file on SIGHUP or when the
+// file changes, on its own thread, and publishes it to the slot. Patterns are
+// compiled off the scanning threads; a config that fails to load or compile
+// is reported and the current patterns stay in use.
+class PatternReloader
+{
+public:
+    PatternReloader(StrategySlot& slot, std::filesystem::path configFile, std::string strategyName,
+                    MatcherCache cache = {}, MatchValidators validators = MatchValidators::defaults(),
+                    MatchResolver resolver = MatchResolver::defaults(),
+                    std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+    ~PatternReloader();
+
+    PatternReloader(const PatternReloader&) = delete;
+    PatternReloader& operator=(const PatternReloader&) = delete;
+
+    // Async-signal-safe
+    void requestReload() noexcept { _reloadRequested.store(true, std::memory_order_relaxed); }
+
+    // Loads, compiles and publishes now; false when the current patterns were kept
+    bool reload();
+
+private:
+    struct FileState
+    {
+        std::filesystem::file_time_type modified {};
+        uintmax_t size = 0;
+
+        bool operator==(const FileState&) const = default;
+    };
+
+    FileState fileState() const;
+    void run(std::stop_token stopToken);
+
+    StrategySlot& _slot;
+    const std::filesystem::path _configFile;
+    const std::string _strategyName;
+    const MatcherCache _cache;
+    const MatchValidators _validators;
+    const MatchResolver _resolver;
+    const std::chrono::milliseconds _pollInterval;
+    std::atomic<bool> _reloadRequested { false };
+    std::jthread _thread;
+};
+
+#endif // PATTERNRELOADER_H
@@ -0,0 +1,51 @@
+#ifndef REDACTOR_H
+#define REDACTOR_H
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "MatchResolver.h"
+
+enum class RedactionStyle
+{
+    Mask,       // every matched byte becomes '*', offsets and line lengths stay as they were
+    Token       // a match becomes [REDACTED:<category>]
+};
+
+RedactionStyle parseRedactionStyle(const std::string& name);
+
+// Writes sanitized copies of plain-text files under an output directory, in
+// the layout they have under the input root. Only formats whose scanned text
+// is the file itself qualify, so match spans are file offsets: TXT, and XML
+// scanned as markup (attribute values are redacted too). The ranges between
+// matches are copied by the kernel with copy_file_range, so neither the file
+// nor its copy is ever held in memory.
+class Redactor
+{
+public:
+    Redactor(std::filesystem::path inputRoot, std::filesystem::path outputDirectory,
+             RedactionStyle style = RedactionStyle::Mask);
+
+    static bool isSupported(const std::filesystem::path& filePath);
+
+    std::filesystem::path outputPath(const std::filesystem::path& filePath) const;
+
+    // Copies filePath to outputPath() with the spans replaced. Spans are file
+    // offsets in any order and may overlap; categories names their category.
+    void redact(const std::filesystem::path& filePath, std::vector<MatchSpan> spans,
+                const std::vector<std::string>& categories);
+
+    const std::filesystem::path& outputDirectory() const noexcept { return _outputDirectory; }
+    size_t filesWritten() const noexcept { return _filesWritten.load(std::memory_order_relaxed); }
+    size_t rangesRedacted() const noexcept { return _rangesRedacted.load(std::memory_order_relaxed); }
+
+private:
+    std::filesystem::path _inputRoot;
+    std::filesystem::path _outputDirectory;
+    RedactionStyle _style;
+    std::atomic<size_t> _filesWritten { 0 };
+    std::atomic<size_t> _rangesRedacted { 0 };
+};
+
+#endif // REDACTOR_H
@@ -0,0 +1,21 @@
+#ifndef RESULTMERGE_H
+#define RESULTMERGE_H
+
+#include <filesystem>
+#include <vector>
+#include "OutputWriters.h"
+
+// Combines the NDJSON results of several runs, typically the --shard parts of
+// a multi-node scan, into one file that reads as if a single run had scanned
+// everything. Every input is written in completion order, so file records go
+// through a k-way merge on their timestamp and are copied out as they come.
+// The statistics records are folded into one written last: counters add up,
+// latency percentiles come from the summed histograms, and top values and the
+// distinct count are recounted from the records in fixed-size sketches (see
+// ValueSketch.h). They are exact while the inputs hold fewer distinct values
+// than HeavyHitters::CAPACITY; past that the merged statistics say
+// "distinct_values_estimated" and "top_values_estimated". Beyond the sketches,
+// only the timed-out file lists of the inputs are kept.
+void mergeNdjsonResults(const std::vector<std::filesystem::path>& inputs, BufferedWriter& writer);
+
+#endif // RESULTMERGE_H
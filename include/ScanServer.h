@@ -0,0 +1,109 @@
+#ifndef SCANSERVER_H
+#define SCANSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FileReaders.h"
+#include "GeneralConfig.h"
+#include "PIIGeneralStats.h"
+#include "PIIRecognizer.h"
+#include "StrategySlot.h"
+
+struct ScanServerOptions
+{
+    size_t workers = 1;
+    size_t maxMatchesPerType = MatchQuota::UNLIMITED;
+    double fileTimeoutSeconds = 0.0;
+    size_t maxQueuedRequests = 1024;                        // readers block once the queue is full
+    uint64_t maxPayloadBytes = GeneralConfig::MAX_TXT_SIZE;
+};
+
+// Scan daemon on a Unix domain socket. Patterns and readers stay compiled for
+// the life of the process (each request pins the slot's current pattern set);
+// requests are pipelined and answered by a worker pool.
+//
+// Every frame is a header line followed by exactly <length> payload bytes:
+//   request:   PATH <id> <length>\n<path>
+//              DATA <id> <length> [name]\n<text bytes>
+//              STATS <id> 0\n
+//   response:  OK|PARTIAL|ERR <id> <length>\n<payload>
+// <id> is any token chosen by the client and echoed back; responses arrive in
+// completion order. OK/PARTIAL carry one NDJSON record (PARTIAL: --file-timeout
+// hit), ERR a message, STATS a JSON object.
+class ScanServer
+{
+public:
+    ScanServer(const StrategySlot& strategies, const FileReaderFactory& readers, const ScanServerOptions& options = {});
+    ~ScanServer();
+
+    ScanServer(const ScanServer&) = delete;
+    ScanServer& operator=(const ScanServer&) = delete;
+
+    // Serves until SIGINT/SIGTERM or stop(); returns the process exit code
+    int run(const std::filesystem::path& socketPath);
+
+    // Async-signal-safe
+    void stop() noexcept;
+
+private:
+    struct Connection;
+
+    struct Request
+    {
+        std::shared_ptr<Connection> connection;
+        std::string op;
+        std::string id;
+        std::string name;
+        std::string payload;
+    };
+
+    enum class Status { Ok, Partial, Error };
+
+    int openSocket(const std::filesystem::path& socketPath);
+    void serveConnection(std::shared_ptr<Connection> connection);
+    void workerLoop();
+    void handle(Request& request);
+    void respond(Connection& connection, Status status, const std::string& id, const std::string& payload);
+
+    bool enqueue(Request&& request);
+    std::string statsJson();
+
+    const StrategySlot& _strategies;
+    const FileReaderFactory& _readers;
+    const ScanServerOptions _options;
+
+    int _wakeFds[2] = { -1, -1 };
+    std::atomic<bool> _stopping { false };
+
+    std::mutex _queueMutex;
+    std::condition_variable _queueNotEmpty;
+    std::condition_variable _queueNotFull;
+    std::deque<Request> _queue;
+
+    std::mutex _connectionsMutex;
+    std::condition_variable _connectionsDone;
+    std::set<Connection*> _connections;
+
+    std::mutex _statsMutex;
+    std::chrono::steady_clock::time_point _started;
+    uint64_t _totalConnections = 0;
+    std::map<std::string, uint64_t> _requests;
+    uint64_t _errors = 0;
+    uint64_t _timedOut = 0;
+    uint64_t _bytesScanned = 0;
+    size_t _inFlight = 0;
+    std::map<std::string, uint64_t> _piiCounts;
+    LatencyHistogram _latency;
+};
+
+#endif // SCANSERVER_H
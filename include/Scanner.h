@@ -6,16 +6,57 @@
 #include <functional>
 #include <memory>
 #include <iostream>
+#include <chrono>
+#include <atomic>
+#include <optional>
+#include <set>
+#include <thread>
 #include "PIIDetector.h"
 #include "PIIResultHandler.h"
 #include "FileReaders.h"
+#include "TraceRecorder.h"
+#include "MemoryAccounting.h"
+#include "AdmissionControl.h"
+#include "Redactor.h"
+#include "FileScheduler.h"
+#include "BatchFileReader.h"
+#include "PathFilter.h"
+
+// One of N disjoint parts of a tree for multi-node scans. Files are assigned
+// by FNV-1a of their path relative to the scanned root, in generic form, so
+// every node agrees on the split wherever the share is mounted and without
+// talking to the others.
+struct FileShard
+{
+    size_t index = 0;       // 0-based
+    size_t count = 1;
+
+    bool isWhole() const noexcept { return count <= 1; }
+
+    bool contains(const std::filesystem::path& relativePath) const
+    {
+        if (isWhole())
+            return true;
+
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const unsigned char c : relativePath.generic_string())
+            hash = (hash ^ c) * 0x100000001b3ULL;
+
+        return hash % count == index;
+    }
+};
 
 struct DirWalker
 {
-    static std::vector<std::filesystem::path> getFiles(const std::filesystem::path& path, bool recursive,
-        std::function<bool(const std::filesystem::path&)> fileFilter = {})
+    // Entries outside the shard are dropped before anything is asked about them,
+    // so a node never stats the files of another node. Sizes come from the one
+    // stat of the walk; 0 when it failed. Directories the path filter excludes
+    // are not descended into.
+    static std::vector<WalkedFile> getFiles(const std::filesystem::path& path, bool recursive,
+        std::function<bool(const std::filesystem::path&)> fileFilter = {}, const FileShard& shard = {},
+        const PathFilter* pathFilter = nullptr)
     {
-        std::vector<std::filesystem::path> files;
+        std::vector<WalkedFile> files;
 
         try
         {
@@ -25,24 +66,52 @@ struct DirWalker
                 return files;
             }
 
-            auto processEntry = [&fileFilter, &files](const auto& entry)
+            std::optional<PathFilter::Walk> filterWalk;
+            if (pathFilter)
+                filterWalk.emplace(*pathFilter, path);
+
+            auto processEntry = [&fileFilter, &files, &shard, &path, &filterWalk](const auto& entry, int depth)
             {
+                std::filesystem::path relative;
+                if (!shard.isWhole() || filterWalk)
+                    relative = entry.path().lexically_relative(path);
+
+                if (!shard.isWhole() && !shard.contains(relative))
+                    return;
+
                 if (entry.is_regular_file())
                 {
                     const auto& filePath = entry.path();
 
-                    if (!fileFilter || fileFilter(filePath))
-                        files.push_back(filePath);
+                    if ((!fileFilter || fileFilter(filePath)) && (!filterWalk || filterWalk->acceptsPath(relative, depth)))
+                    {
+                        std::error_code error;
+                        auto bytes = entry.file_size(error);
+                        if (error)
+                            bytes = 0;
+
+                        if (!filterWalk || filterWalk->acceptsFile(entry, bytes))
+                            files.push_back({ filePath, bytes });
+                    }
                 }
             };
 
             if (recursive)
             {
-                for (const auto& entry : std::filesystem::recursive_directory_iterator(path,
+                std::filesystem::recursive_directory_iterator it(path,
                     std::filesystem::directory_options::skip_permission_denied |
-                    std::filesystem::directory_options::follow_directory_symlink))
+                    std::filesystem::directory_options::follow_directory_symlink);
+
+                for (const std::filesystem::recursive_directory_iterator end; it != end; ++it)
                 {
-                    processEntry(entry);
+                    if (filterWalk && it->is_directory())
+                    {
+                        if (!filterWalk->entersDirectory(it->path(), it->path().lexically_relative(path), it.depth()))
+                            it.disable_recursion_pending();
+                        continue;
+                    }
+
+                    processEntry(*it, it.depth());
                 }
             }
 
@@ -52,7 +121,7 @@ struct DirWalker
                     std::filesystem::directory_options::skip_permission_denied |
                     std::filesystem::directory_options::follow_directory_symlink))
                 {
-                    processEntry(entry);
+                    processEntry(entry, 0);
                 }
             }
         }
@@ -66,16 +135,50 @@ struct DirWalker
     }
 };
 
+inline double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct ScanOptions
+{
+    size_t maxMatchesPerType = MatchQuota::UNLIMITED;   // 1 = triage: stop a type at its first hit
+    uint64_t maxFileMemoryBytes = 0;                    // heap budget of one file's read + detect, 0 = none
+    uint64_t memoryBudgetBytes = 0;                     // estimated footprint of all files in flight, 0 = none
+    size_t threads = 1;
+    double fileTimeoutSeconds = 0.0;                    // wall-clock budget per file, 0 = none
+    Redactor* redactor = nullptr;                       // writes redacted copies of text files, null = none
+    FileShard shard;                                    // part of a directory this node scans
+    SchedulePolicy schedule = SchedulePolicy::Cost;     // order in which files are handed to workers
+    ScanCostModel* costs = nullptr;                     // estimates for the cost schedule, learns from this run; null = built-in rates
+    bool batchReads = true;                             // small TXT/XML files through io_uring where the kernel allows it
+    const PathFilter* pathFilter = nullptr;             // globs, .piiignore, size and time windows; null = every supported file
+};
+
 class PIIFileProcess
 {
 public:
-    PIIFileProcess(PIIDetector& detector, PIIResultHandler& resultHandler, const FileReaderFactory& readerFactory):
+    PIIFileProcess(PIIDetector& detector, PIIResultHandler& resultHandler, const FileReaderFactory& readerFactory,
+        const ScanOptions& options = {}):
           _detector(detector),
           _resultHandler(resultHandler),
-          _reader(readerFactory) {}
+          _reader(readerFactory),
+          _options(options),
+          _strategyName(detector.strategyName()) {}
 
-    void processFile(const std::filesystem::path& filePath)
+    // lowMemory: extract and scan piece by piece (pages, sheets, slides, text blocks)
+    // instead of holding the whole text of the file. With a file timeout the
+    // chunked path is taken as well, and a file that runs out of time is
+    // reported with the matches found so far. A size known from the walk spares the stat.
+    void processFile(const std::filesystem::path& filePath, bool lowMemory = false,
+                     std::optional<uint64_t> knownBytes = std::nullopt)
     {
+        PIIS_TRACE_SPAN("file", filePath.string());
+
+        const auto timeout = std::chrono::duration_cast<CancellationToken::Clock::duration>(
+            std::chrono::duration<double>(_options.fileTimeoutSeconds));
+        CancellationToken token(timeout);
+
         try
         {
             if (!_reader.isSupported(filePath))
@@ -84,12 +187,109 @@ public:
                 return;
             }
 
+            auto metrics = startFile(filePath, knownBytes);
+            metrics.streamed = lowMemory;
+
             auto reader = _reader.getReader(filePath);
-            auto data = reader->readText(filePath);
 
+            // Covers the file text and the raw matches, both alive until the scan ends
+            AllocationScope fileMemory(_options.maxFileMemoryBytes);
+
+            if (redacts(filePath))
+            {
+                const auto stageStart = std::chrono::steady_clock::now();
+                auto scanResult = scanAndRedact(filePath, token);
+                metrics.readSeconds = std::max(0.0, secondsSince(stageStart) - scanResult.duration);
+                metrics.streamed = true;
+                finishFile(filePath, metrics, fileMemory, scanResult, token);
+                return;
+            }
+
+            if (lowMemory || _options.maxMatchesPerType != MatchQuota::UNLIMITED || _options.fileTimeoutSeconds > 0.0)
+            {
+                // Extraction and detection interleave here, reading is the remainder
+                const auto stageStart = std::chrono::steady_clock::now();
+                AllocationScope readMemory;
+                auto scanResult = scanChunks(*reader, filePath, token);
+                readMemory.stop();
+                metrics.readSeconds = std::max(0.0, secondsSince(stageStart) - scanResult.duration);
+                metrics.readAllocatedBytes = readMemory.allocatedBytes();
+                metrics.readPeakBytes = readMemory.peakBytes();
+                finishFile(filePath, metrics, fileMemory, scanResult, token);
+                return;
+            }
+
+            const auto stageStart = std::chrono::steady_clock::now();
+            std::string data;
+            {
+                PIIS_TRACE_SPAN("readText");
+                AllocationScope readMemory;
+                data = reader->readText(filePath);
+                readMemory.stop();
+                metrics.readAllocatedBytes = readMemory.allocatedBytes();
+                metrics.readPeakBytes = readMemory.peakBytes();
+            }
+            metrics.readSeconds = secondsSince(stageStart);
+
+            AllocationScope detectMemory;
             auto scanResult = _detector.scan(data);
+            detectMemory.stop();
+            metrics.detectAllocatedBytes = detectMemory.allocatedBytes();
+            metrics.detectPeakBytes = detectMemory.peakBytes();
+            finishFile(filePath, metrics, fileMemory, scanResult, token);
+        }
 
-            _resultHandler.processResult(filePath, scanResult);
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error processing file " << filePath.string()
+                      << ": " << e.what() << std::endl;
+        }
+    }
+
+    // A small file whose bytes came from a batched read, scanned as one chunk
+    // under the quota: all that readChunks makes of a file this small. The bytes
+    // are left as a buffer to reuse.
+    void processBytes(const std::filesystem::path& filePath, std::string& data, double readSeconds)
+    {
+        PIIS_TRACE_SPAN("file", filePath.string());
+
+        const auto timeout = std::chrono::duration_cast<CancellationToken::Clock::duration>(
+            std::chrono::duration<double>(_options.fileTimeoutSeconds));
+        CancellationToken token(timeout);
+
+        try
+        {
+            // The statx was part of the batched read, its time is in readSeconds
+            auto metrics = startFile(filePath, data.size());
+
+            auto reader = _reader.getReader(filePath);
+
+            // The bytes are already held: they count against the budget as if read in the scope
+            const uint64_t heldBytes = data.capacity();
+            if (_options.maxFileMemoryBytes != 0 && heldBytes >= _options.maxFileMemoryBytes)
+                throw MemoryBudgetExceeded();
+
+            AllocationScope fileMemory(_options.maxFileMemoryBytes != 0 ? _options.maxFileMemoryBytes - heldBytes : 0);
+
+            const auto stageStart = std::chrono::steady_clock::now();
+            {
+                PIIS_TRACE_SPAN("bytesToText");
+                AllocationScope readMemory;
+                reader->bytesToText(data, token);
+                readMemory.stop();
+                metrics.readAllocatedBytes = readMemory.allocatedBytes();
+                metrics.readPeakBytes = readMemory.peakBytes();
+            }
+            metrics.readSeconds = readSeconds + secondsSince(stageStart);
+
+            AllocationScope detectMemory;
+            MatchQuota quota(_options.maxMatchesPerType);
+            quota.watch(token);
+            auto scanResult = _detector.scan(data, quota);
+            detectMemory.stop();
+            metrics.detectAllocatedBytes = detectMemory.allocatedBytes();
+            metrics.detectPeakBytes = detectMemory.peakBytes();
+            finishFile(filePath, metrics, fileMemory, scanResult, token, heldBytes);
         }
 
         catch (const std::exception& e)
@@ -100,35 +300,185 @@ public:
     }
 
 private:
+    bool redacts(const std::filesystem::path& filePath) const
+    {
+        return _options.redactor && Redactor::isSupported(filePath);
+    }
+
+    // Where every path starts: what the file is, and its size unless the walk gave it
+    FileMetrics startFile(const std::filesystem::path& filePath, std::optional<uint64_t> knownBytes)
+    {
+        FileMetrics metrics;
+        metrics.filePath = filePath.string();
+        metrics.fileType = FileReaderFactory::normalizeExtension(filePath.extension().string());
+        metrics.strategy = _strategyName;
+
+        const auto statStart = std::chrono::steady_clock::now();
+        if (knownBytes)
+            metrics.bytes = *knownBytes;
+        else
+        {
+            PIIS_TRACE_SPAN("stat");
+            metrics.bytes = std::filesystem::file_size(filePath);
+        }
+        metrics.statSeconds = secondsSince(statStart);
+
+        return metrics;
+    }
+
+    // Where every path ends: closes the file's memory scope, reports a timeout and
+    // hands the result on. heldBytes were allocated before the scope was opened.
+    void finishFile(const std::filesystem::path& filePath, FileMetrics& metrics, AllocationScope& fileMemory,
+                    const PIIDetector::DetectorResult& scanResult, const CancellationToken& token,
+                    uint64_t heldBytes = 0)
+    {
+        fileMemory.stop();
+        metrics.peakBytes = heldBytes + fileMemory.peakBytes();
+        metrics.rssBytes = MemoryAccounting::currentRssBytes();
+        metrics.timedOut = token.timedOut();
+
+        if (metrics.timedOut)
+            std::cerr << "Warning: " << filePath.string() << " exceeded --file-timeout of "
+                      << _options.fileTimeoutSeconds << "s, "
+                      << (redacts(filePath) ? "no redacted copy was written" : "results are partial") << std::endl;
+
+        _resultHandler.processResult(filePath, scanResult, metrics);
+    }
+
+    // Scans chunk by chunk and cancels extraction once every category is capped
+    // or the file's deadline has passed
+    PIIDetector::DetectorResult scanChunks(ReaderBase& reader, const std::filesystem::path& filePath,
+                                           CancellationToken& token)
+    {
+        MatchQuota quota(_options.maxMatchesPerType);
+        quota.watch(token);
+        PIIDetector::PartialResult partial;
+
+        PIIS_TRACE_SPAN("readChunks");
+        reader.readChunks(filePath, [&](const std::string& chunk)
+            {
+                _detector.scanChunk(chunk, quota, partial);
+
+                if (_detector.isSatisfied(quota, partial))
+                    token.cancel();
+            }, token);
+
+        return _detector.finish(std::move(partial));
+    }
+
+    // Scans the file's own bytes block by block, so match spans are file offsets,
+    // then writes the redacted copy. There is no match cap here: a copy with a
+    // value left in it would be worse than none, and so is a copy of a file that
+    // ran out of time.
+    //
+    // Blocks are cut at whitespace, which a card or phone number may contain, so
+    // the last REDACT_OVERLAP bytes of every block are scanned again with the next
+    // one. A match is taken from the first window it begins in at least
+    // REDACT_OVERLAP bytes before the end; only a value longer than that can be cut.
+    PIIDetector::DetectorResult scanAndRedact(const std::filesystem::path& filePath, CancellationToken& token)
+    {
+        MatchQuota quota;
+        quota.watch(token);
+        PIIDetector::PartialResult partial;
+        std::vector<MatchSpan> spans;
+        std::string window;
+        size_t offset = 0;      // of window in the file
+
+        auto scanWindow = [&](size_t settledBytes)
+        {
+            size_t settledEnd = 0;
+
+            for (auto span : _detector.scanChunkSpans(window, quota, partial, settledBytes))
+            {
+                settledEnd = std::max(settledEnd, span.end);
+                spans.push_back({ span.begin + offset, span.end + offset, span.category });
+            }
+
+            return settledEnd;
+        };
+
+        PIIS_TRACE_SPAN("redact");
+        TxtReader().readChunks(filePath, [&](const std::string& chunk)
+            {
+                window += chunk;
+
+                if (window.size() <= REDACT_OVERLAP)
+                    return;
+
+                // A cut after whitespace keeps the next window's first word whole
+                size_t cut = window.size() - REDACT_OVERLAP;
+                if (const auto space = window.find_last_of(" \t\r\n", cut - 1);
+                    space != std::string::npos && space + 1 + REDACT_OVERLAP >= cut)
+                    cut = space + 1;
+
+                // Matches running past the cut are settled too; what follows them is rescanned
+                const auto next = std::max(cut, scanWindow(cut));
+                window.erase(0, next);
+                offset += next;
+            }, token);
+
+        if (!token.isCancelled() && !window.empty())
+            scanWindow(window.size());
+
+        if (!token.isCancelled())
+            _options.redactor->redact(filePath, std::move(spans),
+                partial.strategy ? partial.strategy->categories : std::vector<std::string> {});
+
+        return _detector.finish(std::move(partial));
+    }
+
+    static constexpr size_t REDACT_OVERLAP = 64 * 1024;
+
     PIIDetector& _detector;
     PIIResultHandler& _resultHandler;
     const FileReaderFactory& _reader;
+    ScanOptions _options;
+    std::string _strategyName;
 };
 
 class PIIScanner
 {
 public:
-    PIIScanner(PIIDetector& detector, PIIResultHandler& resultHandler,  const FileReaderFactory& readerFactory)
+    PIIScanner(PIIDetector& detector, PIIResultHandler& resultHandler,  const FileReaderFactory& readerFactory,
+        const ScanOptions& options = {})
         : _detector(detector),
           _resultHandler(resultHandler),
           _reader(readerFactory),
-          _fileProcess(detector, resultHandler, readerFactory) {}
+          _options(options),
+          _fileProcess(detector, resultHandler, readerFactory, options)
+    {
+        if (_options.memoryBudgetBytes != 0)
+            _budget = std::make_unique<MemoryBudget>(_options.memoryBudgetBytes);
+
+        // Formats a batched read can feed; files to redact read their own bytes
+        if (_options.batchReads && !_options.redactor)
+        {
+            for (const auto& extension : _reader.getSupportedExtensions())
+            {
+                if (_reader.getReader("file" + extension)->parsesBytes())
+                    _batchTypes.insert(extension);
+            }
+        }
+    }
 
     void scan(const std::filesystem::path& path, bool recursive = false)
     {
-        std::vector<std::filesystem::path> files;
+        std::vector<WalkedFile> files;
 
         if (std::filesystem::is_directory(path))
         {
+            const auto walkStart = std::chrono::steady_clock::now();
+            PIIS_TRACE_SPAN("walk", path.string());
             files = DirWalker::getFiles(path, recursive,
                 [this](const auto& filePath)
                 {
                     return _reader.isSupported(filePath);
-                });
+                }, _options.shard, _options.pathFilter);
+            _resultHandler.recordStageTime(ScanStage::Walk, secondsSince(walkStart));
         }
 
         else if (std::filesystem::is_regular_file(path) && _reader.isSupported(path))
-            files.push_back(path);
+            files.push_back({ path, std::filesystem::file_size(path) });
 
         else
         {
@@ -143,16 +493,182 @@ public:
             return;
         }
 
-        for (const auto& file: files)
-            _fileProcess.processFile(file);
+        processFiles(files);
 
         _resultHandler.finalize();
     }
 
 private:
+    static constexpr size_t BATCH_FILES = 256;      // small files one worker takes from the queue at once
+
+    using WorkerTime = std::pair<double, double>;   // busy, longest file
+
+    // Workers take files from a shared index in schedule order; runs of small
+    // TXT/XML files are read together through io_uring. Every file's time goes
+    // into the cost model and into the parallel efficiency of the summary.
+    void processFiles(std::vector<WalkedFile>& files)
+    {
+        const ScanCostModel builtInCosts;
+        scheduleFiles(files, _options.schedule, _options.costs ? *_options.costs : builtInCosts);
+
+        const auto threadCount = std::clamp<size_t>(_options.threads, 1, files.size());
+        std::vector<WorkerTime> workerTimes(threadCount);
+        std::atomic<size_t> next { 0 };
+        const auto scanStart = std::chrono::steady_clock::now();
+
+        auto worker = [this, &files, &next, &workerTimes](size_t workerIndex)
+        {
+            auto& workerTime = workerTimes[workerIndex];
+            std::unique_ptr<BatchFileReader> batchReader;     // set up at the first small file
+            bool batching = !_batchTypes.empty();
+            std::vector<const WalkedFile*> batch;
+
+            auto takeNext = [&next] { return next.fetch_add(1, std::memory_order_relaxed); };
+
+            for (size_t index = takeNext(); index < files.size(); )
+            {
+                if (batching && isBatchable(files[index]) && !batchReader)
+                {
+                    batchReader = std::make_unique<BatchFileReader>();
+                    batching = batchReader->available();
+                }
+
+                if (!batching || !isBatchable(files[index]))
+                {
+                    recordFileTime(files[index], processAdmitted(files[index]), workerTime);
+                    index = takeNext();
+                    continue;
+                }
+
+                // The run of small files from here, ended by the first other one
+                batch.clear();
+
+                do
+                {
+                    batch.push_back(&files[index]);
+                    index = takeNext();
+                }
+                while (batch.size() < BATCH_FILES && index < files.size() && isBatchable(files[index]));
+
+                processBatch(batch, *batchReader, workerTime);
+            }
+        };
+
+        if (threadCount == 1)
+            worker(0);
+
+        else
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(threadCount);
+
+            for (size_t i = 0; i < threadCount; ++i)
+                workers.emplace_back(worker, i);
+        }
+
+        double busy = 0.0;
+        double longest = 0.0;
+
+        for (const auto& [workerBusy, workerLongest] : workerTimes)
+        {
+            busy += workerBusy;
+            longest = std::max(longest, workerLongest);
+        }
+
+        _resultHandler.recordSchedule(schedulePolicyName(_options.schedule), threadCount,
+                                      secondsSince(scanStart), busy, longest);
+    }
+
+    bool isBatchable(const WalkedFile& file) const
+    {
+        return file.bytes <= BatchFileReader::MAX_FILE_BYTES
+            && _batchTypes.contains(FileReaderFactory::normalizeExtension(file.path.extension().string()));
+    }
+
+    void recordFileTime(const WalkedFile& file, double seconds, WorkerTime& workerTime)
+    {
+        workerTime.first += seconds;
+        workerTime.second = std::max(workerTime.second, seconds);
+
+        if (_options.costs)
+            _options.costs->record(FileReaderFactory::normalizeExtension(file.path.extension().string()),
+                                   file.bytes, seconds);
+    }
+
+    // Small files read together, each scanned as soon as its bytes are in. One
+    // reservation covers the batch at the XML factor, the larger of the two
+    // formats. A file's read time is the wait for it after the previous one.
+    // Files the batch could not read go through their reader, which reports why.
+    void processBatch(const std::vector<const WalkedFile*>& batch, BatchFileReader& reader, WorkerTime& workerTime)
+    {
+        MemoryBudget::Reservation reservation;
+
+        if (_budget)
+        {
+            uint64_t bytes = 0;
+            for (const auto* file : batch)
+                bytes += file->bytes;
+
+            const auto waitStart = std::chrono::steady_clock::now();
+            reservation = _budget->admit(estimateFootprint(".xml", bytes));
+            _resultHandler.recordStageTime(ScanStage::Admit, secondsSince(waitStart));
+        }
+
+        std::vector<std::filesystem::path> paths;
+        paths.reserve(batch.size());
+
+        for (const auto* file : batch)
+            paths.push_back(file->path);
+
+        PIIS_TRACE_SPAN("batch", std::to_string(batch.size()) + " files");
+        auto lastDelivery = std::chrono::steady_clock::now();
+
+        const auto failed = reader.read(paths, [&](size_t position, std::string& bytes)
+            {
+                const auto readSeconds = secondsSince(lastDelivery);
+                const auto start = std::chrono::steady_clock::now();
+                _fileProcess.processBytes(paths[position], bytes, readSeconds);
+                recordFileTime(*batch[position], readSeconds + secondsSince(start), workerTime);
+                lastDelivery = std::chrono::steady_clock::now();
+            });
+
+        for (const auto position : failed)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            _fileProcess.processFile(paths[position]);
+            recordFileTime(*batch[position], secondsSince(start), workerTime);
+        }
+    }
+
+    // Waits for room in the memory budget; files larger than the whole budget take the low-memory path.
+    // Returns the seconds spent on the file, without the wait.
+    double processAdmitted(const WalkedFile& file)
+    {
+        if (!_budget)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            _fileProcess.processFile(file.path, false, file.bytes);
+            return secondsSince(start);
+        }
+
+        const auto footprint = estimateFootprint(
+            FileReaderFactory::normalizeExtension(file.path.extension().string()), file.bytes);
+
+        const auto waitStart = std::chrono::steady_clock::now();
+        auto reservation = _budget->admit(footprint);
+        _resultHandler.recordStageTime(ScanStage::Admit, secondsSince(waitStart));
+
+        const auto start = std::chrono::steady_clock::now();
+        _fileProcess.processFile(file.path, _budget->exceedsCapacity(footprint), file.bytes);
+        return secondsSince(start);
+    }
+
     PIIDetector& _detector;
     PIIResultHandler& _resultHandler;
     const FileReaderFactory& _reader;
+    ScanOptions _options;
+    std::unique_ptr<MemoryBudget> _budget;
+    std::set<std::string> _batchTypes;      // normalized extensions of readers that parse bytes
 
     PIIFileProcess _fileProcess; //
 };
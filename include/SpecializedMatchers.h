@@ -0,0 +1,17 @@
+#ifndef SPECIALIZEDMATCHERS_H
+#define SPECIALIZEDMATCHERS_H
+
+#include <string_view>
+
+// Hand-written scanners for built-in patterns (DefaultPatterns.h) that are hot
+// on real data: the email, phone, card number and IP expressions. Each one
+// behaves exactly like RE2::FindAndConsume with its regex: it finds the
+// leftmost match in input, stores the first capture group in capture and
+// consumes input up to the end of the match. Same signature as the RE2 loop in
+// RegexStrategy, so a pattern either has a specialized matcher or runs through RE2.
+using SpecializedMatcher = bool (*)(std::string_view& input, std::string_view& capture);
+
+// nullptr unless pattern is, byte for byte, a built-in pattern with a scanner
+SpecializedMatcher findSpecializedMatcher(std::string_view pattern);
+
+#endif // SPECIALIZEDMATCHERS_H
@@ -0,0 +1,89 @@
+#ifndef STRATEGYSLOT_H
+#define STRATEGYSLOT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PIIRecognizer.h"
+
+// The current pattern set, replaced as a whole when patterns are reloaded.
+// A file pins one snapshot for its whole scan, so in-flight files finish on
+// the set they started with while new files pick up the new one.
+//
+// current() compares an atomic generation with a thread-local copy of the
+// last snapshot the thread saw: the hot path takes no lock. A thread only
+// goes through the publish mutex on its first call and once after a reload.
+class StrategySlot
+{
+public:
+    struct Snapshot
+    {
+        std::unique_ptr<IStrategyScanner> strategy;
+        std::vector<std::string> categories;
+        uint64_t generation = 0;
+    };
+
+    explicit StrategySlot(std::unique_ptr<IStrategyScanner> strategy): _id(nextSlotId())
+    {
+        publish(std::move(strategy));
+    }
+
+    StrategySlot(const StrategySlot&) = delete;
+    StrategySlot& operator=(const StrategySlot&) = delete;
+
+    std::shared_ptr<const Snapshot> current() const
+    {
+        struct Cache
+        {
+            uint64_t slot = 0;
+            uint64_t generation = 0;
+            std::shared_ptr<const Snapshot> snapshot;
+        };
+        thread_local Cache cache;
+
+        const auto generation = _generation.load(std::memory_order_acquire);
+
+        if (cache.slot != _id || cache.generation != generation)
+        {
+            std::lock_guard lock(_publishMutex);
+            cache.slot = _id;
+            cache.snapshot = _snapshot;
+            cache.generation = _snapshot->generation;
+        }
+
+        return cache.snapshot;
+    }
+
+    // Makes the strategy current for every file that starts after this call
+    uint64_t publish(std::unique_ptr<IStrategyScanner> strategy)
+    {
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->categories = strategy->categories();
+        snapshot->strategy = std::move(strategy);
+
+        std::lock_guard lock(_publishMutex);
+        snapshot->generation = _generation.load(std::memory_order_relaxed) + 1;
+        _snapshot = std::move(snapshot);
+        _generation.store(_snapshot->generation, std::memory_order_release);
+        return _snapshot->generation;
+    }
+
+    uint64_t generation() const noexcept { return _generation.load(std::memory_order_acquire); }
+
+private:
+    // Slot ids keep thread-local caches from matching a new slot at a reused address
+    static uint64_t nextSlotId()
+    {
+        static std::atomic<uint64_t> next { 1 };
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const uint64_t _id;
+    std::atomic<uint64_t> _generation { 0 };
+    mutable std::mutex _publishMutex;
+    std::shared_ptr<const Snapshot> _snapshot;
+};
+
+#endif // STRATEGYSLOT_H
@@ -0,0 +1,112 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+// Timeline instrumentation for --trace. Built only with -DPIIS_ENABLE_TRACING=ON;
+// otherwise PIIS_TRACE_SPAN expands to nothing and no recorder code is compiled.
+
+#ifdef PIIS_ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class TraceRecorder
+{
+public:
+    // Events kept per thread, the oldest ones are overwritten
+    static constexpr size_t RING_CAPACITY = 1 << 16;
+
+    static TraceRecorder& instance();
+
+    void enable();
+    bool isEnabled() const noexcept { return _enabled.load(std::memory_order_relaxed); }
+
+    uint64_t nowNanos() const noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _origin).count());
+    }
+
+    // name must be a string literal; detail is copied (e.g. the file path)
+    void record(const char* name, uint64_t startNanos, uint64_t endNanos, std::string detail = {});
+
+    // Chrome/Perfetto trace-event JSON; call once the traced threads are done
+    void write(const std::filesystem::path& outputFile) const;
+
+private:
+    struct Event
+    {
+        const char* name = nullptr;
+        uint64_t startNanos = 0;
+        uint64_t endNanos = 0;
+        std::string detail;
+    };
+
+    // Single producer: only the owning thread writes, the exporter reads after it is done
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(uint32_t id): threadId(id), events(RING_CAPACITY) {}
+
+        uint32_t threadId;
+        std::vector<Event> events;
+        std::atomic<uint64_t> written { 0 };
+    };
+
+    TraceRecorder() = default;
+
+    ThreadBuffer& localBuffer();
+
+    std::atomic<bool> _enabled { false };
+    std::chrono::steady_clock::time_point _origin = std::chrono::steady_clock::now();
+
+    mutable std::mutex _buffersMutex;   // taken once per thread, on its first event
+    std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+};
+
+// Records [construction, destruction) as one complete event
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name, std::string detail = {})
+        : _recorder(TraceRecorder::instance())
+    {
+        if (!_recorder.isEnabled())
+            return;
+
+        _name = name;
+        _detail = std::move(detail);
+        _startNanos = _recorder.nowNanos();
+    }
+
+    ~TraceSpan()
+    {
+        if (_name)
+            _recorder.record(_name, _startNanos, _recorder.nowNanos(), std::move(_detail));
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceRecorder& _recorder;
+    const char* _name = nullptr;
+    std::string _detail;
+    uint64_t _startNanos = 0;
+};
+
+#define PIIS_TRACE_CONCAT_IMPL(a, b) a##b
+#define PIIS_TRACE_CONCAT(a, b) PIIS_TRACE_CONCAT_IMPL(a, b)
+#define PIIS_TRACE_SPAN(...) TraceSpan PIIS_TRACE_CONCAT(piisTraceSpan, __LINE__)(__VA_ARGS__)
+
+#else
+
+#define PIIS_TRACE_SPAN(...) ((void)0)
+
+#endif // PIIS_ENABLE_TRACING
+
+#endif // TRACERECORDER_H
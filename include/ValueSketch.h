@@ -0,0 +1,149 @@
+#ifndef VALUESKETCH_H
+#define VALUESKETCH_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Most frequent match values in a fixed number of entries (Space-Saving).
+// Counts are exact until the table first fills. After that a new value takes
+// the place of the least frequent one and inherits its counts, so a count is
+// over by at most the smallest count at that time, and any value seen more
+// than total / CAPACITY times is guaranteed to be in the table.
+class HeavyHitters
+{
+public:
+    static constexpr size_t CAPACITY = 64 * 1024;
+
+    struct Entry
+    {
+        std::string value;
+        uint64_t occurrences;
+        uint64_t files;
+    };
+
+    void add(std::string_view value, uint64_t occurrences, uint64_t files)
+    {
+        auto it = _counts.find(value);
+
+        if (it == _counts.end())
+        {
+            if (_counts.size() < CAPACITY)
+                it = _counts.emplace(std::string(value), Counts {}).first;
+            else
+            {
+                // The node of the least frequent value is reused under the new key
+                const auto victim = _counts.find(_order.begin()->second);
+                _order.erase(_order.begin());
+
+                auto node = _counts.extract(victim);
+                node.key() = value;
+                it = _counts.insert(std::move(node)).position;
+                _saturated = true;
+            }
+        }
+        else
+            _order.erase({ it->second.occurrences, it->first });
+
+        it->second.occurrences += occurrences;
+        it->second.files += files;
+        _order.insert({ it->second.occurrences, it->first });
+    }
+
+    // Once a value has been evicted, counts are upper bounds
+    bool exact() const noexcept { return !_saturated; }
+    size_t size() const noexcept { return _counts.size(); }
+
+    std::vector<Entry> top(size_t count) const
+    {
+        std::vector<Entry> entries;
+
+        for (auto it = _order.rbegin(); it != _order.rend() && entries.size() < count; ++it)
+        {
+            const auto& counts = _counts.find(it->second)->second;
+            entries.push_back({ std::string(it->second), counts.occurrences, counts.files });
+        }
+
+        return entries;
+    }
+
+private:
+    struct Counts
+    {
+        uint64_t occurrences = 0;
+        uint64_t files = 0;
+    };
+
+    struct Hash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view> {}(value); }
+    };
+
+    std::unordered_map<std::string, Counts, Hash, std::equal_to<>> _counts;
+    std::set<std::pair<uint64_t, std::string_view>> _order;     // views of the keys of _counts
+    bool _saturated = false;
+};
+
+// Number of distinct values (HyperLogLog, 2^14 registers: 16 KiB, ~0.8% standard error)
+class DistinctCounter
+{
+public:
+    void add(std::string_view value)
+    {
+        const auto hash = mix(std::hash<std::string_view> {}(value));
+        const auto index = static_cast<size_t>(hash >> (64 - BITS));
+
+        // The guard bit caps the rank when the remaining bits are all zero
+        const auto rest = (hash << BITS) | (uint64_t { 1 } << (BITS - 1));
+        _registers[index] = std::max(_registers[index], static_cast<uint8_t>(std::countl_zero(rest) + 1));
+    }
+
+    uint64_t estimate() const
+    {
+        constexpr double m = REGISTERS;
+        double sum = 0.0;
+        size_t zeros = 0;
+
+        for (const auto value : _registers)
+        {
+            sum += std::ldexp(1.0, -value);
+            zeros += value == 0;
+        }
+
+        const double raw = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+
+        // Small cardinalities: linear counting over the empty registers is closer
+        if (raw <= 2.5 * m && zeros > 0)
+            return static_cast<uint64_t>(std::llround(m * std::log(m / static_cast<double>(zeros))));
+
+        return static_cast<uint64_t>(std::llround(raw));
+    }
+
+private:
+    static constexpr unsigned BITS = 14;
+    static constexpr size_t REGISTERS = size_t { 1 } << BITS;
+
+    // std::hash need not spread its bits; the register index takes the top ones
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::array<uint8_t, REGISTERS> _registers {};
+};
+
+#endif // VALUESKETCH_H
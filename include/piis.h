@@ -0,0 +1,85 @@
+#ifndef PIIS_H
+#define PIIS_H
+
+/*
+ * C API of libpiis.
+ *
+ * A scanner is created once (patterns compiled, readers registered) and can
+ * then be shared by any number of threads: every scan call only reads the
+ * scanner. Results are returned as one heap block that owns all of its
+ * strings and is released with piis_result_free().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIIS_API __attribute__((visibility("default")))
+
+/* Bumped on every incompatible change of the structs or functions below */
+#define PIIS_API_VERSION 1
+
+typedef enum piis_status
+{
+    PIIS_OK = 0,
+    PIIS_ERROR_INVALID_ARGUMENT = 1,    /* NULL handle, unknown strategy, bad pattern */
+    PIIS_ERROR_CONFIG = 2,              /* pattern config missing or malformed */
+    PIIS_ERROR_UNSUPPORTED_FORMAT = 3,  /* no reader for the file extension */
+    PIIS_ERROR_READ = 4,                /* file missing, too large or corrupt */
+    PIIS_ERROR_OUT_OF_MEMORY = 5,
+    PIIS_ERROR_INTERNAL = 6
+} piis_status;
+
+typedef struct piis_options
+{
+    const char* strategy;               /* "regex" (default when NULL) or "keyword" */
+    const char* pattern_config;         /* JSON pattern file, NULL = built-in patterns */
+    size_t max_matches_per_type;        /* 0 = unlimited */
+    double file_timeout_seconds;        /* per piis_scan_file call, 0 = no limit */
+} piis_options;
+
+typedef struct piis_match
+{
+    const char* value;                  /* NUL-terminated, owned by the result */
+    uint32_t length;                    /* bytes, without the terminator */
+    uint32_t category;                  /* index into piis_result.categories */
+} piis_match;
+
+typedef struct piis_result
+{
+    const char* const* categories;      /* categories with at least one match */
+    size_t category_count;
+    const piis_match* matches;          /* grouped by category */
+    size_t match_count;
+    double seconds;                     /* extraction and detection time */
+    int timed_out;                      /* 1 when file_timeout_seconds cut the scan short */
+} piis_result;
+
+typedef struct piis_scanner piis_scanner;
+
+PIIS_API int piis_api_version(void);
+
+/* options may be NULL for the regex strategy with the built-in patterns */
+PIIS_API piis_status piis_scanner_create(const piis_options* options, piis_scanner** scanner);
+PIIS_API void piis_scanner_destroy(piis_scanner* scanner);
+
+/* Scans text already in memory */
+PIIS_API piis_status piis_scan_buffer(const piis_scanner* scanner, const char* data, size_t size,
+                                      piis_result** result);
+
+/* Extracts and scans a .txt/.pdf/.xlsx/.pptx/.xml/.docx file */
+PIIS_API piis_status piis_scan_file(const piis_scanner* scanner, const char* path, piis_result** result);
+
+PIIS_API void piis_result_free(piis_result* result);
+
+/* Message of the last failed call on this thread, "" when there was none */
+PIIS_API const char* piis_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIIS_H */
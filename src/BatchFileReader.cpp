@@ -0,0 +1,485 @@
+#include "BatchFileReader.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+#include <system_error>
+
+#if defined(PIIS_ENABLE_IO_URING) && __has_include(<linux/io_uring.h>)
+#define PIIS_HAVE_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef PIIS_HAVE_IO_URING
+
+// The rings of one io_uring instance, driven through the raw syscalls so there
+// is no library to depend on
+struct BatchFileReader::Ring
+{
+    // Every open file has at most an open and a statx, or a read, in flight,
+    // and each finished file one close
+    static constexpr unsigned ENTRIES = 4 * MAX_OPEN_FILES;
+
+    int fd = -1;
+    void* sqMemory = MAP_FAILED;
+    size_t sqSize = 0;
+    void* cqMemory = MAP_FAILED;
+    size_t cqSize = 0;
+    void* sqeMemory = MAP_FAILED;
+    size_t sqeSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned tail = 0;      // ours until submit() publishes it
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    Ring()
+    {
+        io_uring_params params {};
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, ENTRIES, &params));
+
+        if (fd < 0)
+            return;
+
+        sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+            sqSize = cqSize = std::max(sqSize, cqSize);
+
+        sqMemory = ::mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqMemory = singleMap ? sqMemory
+            : ::mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqeSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqeMemory = ::mmap(nullptr, sqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+        if (sqMemory == MAP_FAILED || cqMemory == MAP_FAILED || sqeMemory == MAP_FAILED)
+            return;
+
+        auto* sq = static_cast<char*>(sqMemory);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+        auto* cq = static_cast<char*>(cqMemory);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        tail = *sqTail;
+    }
+
+    ~Ring()
+    {
+        if (sqeMemory != MAP_FAILED)
+            ::munmap(sqeMemory, sqeSize);
+        if (cqMemory != MAP_FAILED && cqMemory != sqMemory)
+            ::munmap(cqMemory, cqSize);
+        if (sqMemory != MAP_FAILED)
+            ::munmap(sqMemory, sqSize);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    // Set up, and the kernel knows every operation a file needs (openat and statx came in 5.6)
+    bool usable() const
+    {
+        if (!sqes || !cqes)
+            return false;
+
+        constexpr size_t OPS = 256;
+        std::array<uint64_t, (sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op)) / sizeof(uint64_t)> buffer {};
+        auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+
+        if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, OPS) < 0)
+            return false;
+
+        for (const auto op : { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE })
+        {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+
+        return true;
+    }
+
+    io_uring_sqe* next()
+    {
+        if (tail - std::atomic_ref(*sqHead).load(std::memory_order_acquire) >= sqEntries)
+        {
+            submit(0);
+
+            if (tail - std::atomic_ref(*sqHead).load(std::memory_order_acquire) >= sqEntries)
+                throw std::system_error(EBUSY, std::generic_category(), "io_uring submission queue is full");
+        }
+
+        const unsigned index = tail & sqMask;
+        auto* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        ++tail;
+        return sqe;
+    }
+
+    // Hands the queued entries to the kernel and waits for that many completions
+    void submit(unsigned waitFor)
+    {
+        std::atomic_ref(*sqTail).store(tail, std::memory_order_release);
+
+        for (;;)
+        {
+            const unsigned pending = tail - std::atomic_ref(*sqHead).load(std::memory_order_acquire);
+
+            if (pending == 0 && waitFor == 0)
+                return;
+
+            const auto result = ::syscall(__NR_io_uring_enter, fd, pending, waitFor,
+                                          waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (result >= 0)
+                return;
+
+            if (errno != EINTR)
+                throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+        }
+    }
+
+    template<typename Handler>
+    void reap(Handler&& onCompletion)
+    {
+        unsigned head = *cqHead;
+        const unsigned end = std::atomic_ref(*cqTail).load(std::memory_order_acquire);
+
+        for (; head != end; ++head)
+        {
+            const auto& cqe = cqes[head & cqMask];
+            onCompletion(cqe.user_data, cqe.res);
+        }
+
+        std::atomic_ref(*cqHead).store(head, std::memory_order_release);
+    }
+};
+
+namespace
+{
+    enum Operation : uint64_t { Open, Stat, Read, OPERATIONS };
+    constexpr uint64_t CLOSE = ~0ULL;      // nobody waits for it
+
+    // One file in flight
+    struct Slot
+    {
+        size_t position = 0;
+        int fd = -1;
+        struct statx stat {};
+        std::string buffer;
+        size_t size = 0;
+        size_t done = 0;
+        unsigned pending = 0;
+        bool failed = false;
+        bool busy = false;
+    };
+}
+
+BatchFileReader::BatchFileReader()
+{
+    auto ring = std::make_unique<Ring>();
+
+    if (ring->usable())
+        _ring = std::move(ring);
+}
+
+std::vector<size_t> BatchFileReader::read(const std::vector<std::filesystem::path>& files, const FileHandler& onFile)
+{
+    std::vector<bool> delivered(files.size(), false);
+
+    auto undelivered = [&delivered]
+    {
+        std::vector<size_t> positions;
+
+        for (size_t position = 0; position < delivered.size(); ++position)
+        {
+            if (!delivered[position])
+                positions.push_back(position);
+        }
+
+        return positions;
+    };
+
+    if (!_ring)
+        return undelivered();
+
+    std::vector<size_t> failed;
+    // On the heap: if the ring fails with operations in flight, the kernel may
+    // still write into them after this returns
+    auto slotArray = std::make_unique<std::array<Slot, MAX_OPEN_FILES>>();
+    auto& slots = *slotArray;
+    std::vector<std::pair<size_t, std::string>> ready;     // handed over after the next submit
+    size_t nextFile = 0;
+    size_t inFlight = 0;
+
+    auto queue = [this, &inFlight](uint8_t opcode, int fd, uint64_t userData) -> io_uring_sqe&
+    {
+        auto* sqe = _ring->next();
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->user_data = userData;
+        ++inFlight;
+        return *sqe;
+    };
+
+    auto start = [&](size_t slotIndex)
+    {
+        auto& slot = slots[slotIndex];
+
+        if (nextFile == files.size())
+        {
+            slot.busy = false;
+            return;
+        }
+
+        slot.position = nextFile++;
+        slot.fd = -1;
+        slot.size = slot.done = 0;
+        slot.failed = false;
+        slot.busy = true;
+        slot.pending = 2;
+
+        // Both by path, so neither waits for the other
+        const auto* path = files[slot.position].c_str();
+
+        auto& open = queue(IORING_OP_OPENAT, AT_FDCWD, slotIndex * OPERATIONS + Open);
+        open.addr = reinterpret_cast<uint64_t>(path);
+        open.open_flags = O_RDONLY | O_CLOEXEC;
+
+        auto& stat = queue(IORING_OP_STATX, AT_FDCWD, slotIndex * OPERATIONS + Stat);
+        stat.addr = reinterpret_cast<uint64_t>(path);
+        stat.len = STATX_SIZE;
+        stat.off = reinterpret_cast<uint64_t>(&slot.stat);
+    };
+
+    auto readRest = [&](size_t slotIndex)
+    {
+        auto& slot = slots[slotIndex];
+        auto& read = queue(IORING_OP_READ, slot.fd, slotIndex * OPERATIONS + Read);
+        read.addr = reinterpret_cast<uint64_t>(slot.buffer.data() + slot.done);
+        read.len = static_cast<uint32_t>(slot.size - slot.done);
+        read.off = slot.done;
+    };
+
+    auto finish = [&](size_t slotIndex, bool succeeded)
+    {
+        auto& slot = slots[slotIndex];
+
+        if (slot.fd >= 0)
+            queue(IORING_OP_CLOSE, slot.fd, CLOSE);
+
+        if (succeeded)
+            ready.emplace_back(slot.position, std::move(slot.buffer));
+        else
+        {
+            failed.push_back(slot.position);
+            delivered[slot.position] = true;
+            recycle(std::move(slot.buffer));
+        }
+
+        slot.buffer = {};
+        start(slotIndex);
+    };
+
+    auto complete = [&](uint64_t userData, int result)
+    {
+        --inFlight;
+
+        if (userData == CLOSE)
+            return;
+
+        const size_t slotIndex = userData / OPERATIONS;
+        auto& slot = slots[slotIndex];
+
+        switch (userData % OPERATIONS)
+        {
+            case Open:
+            case Stat:
+                if (result < 0)
+                    slot.failed = true;
+                else if (userData % OPERATIONS == Open)
+                    slot.fd = result;
+                else
+                    slot.size = slot.stat.stx_size;
+
+                if (--slot.pending > 0)
+                    return;
+
+                if (slot.failed || slot.size > MAX_FILE_BYTES)
+                    finish(slotIndex, false);
+
+                else if (slot.size == 0)
+                    finish(slotIndex, true);
+
+                else
+                {
+                    slot.buffer = takeBuffer();
+                    slot.buffer.resize(slot.size);
+                    readRest(slotIndex);
+                }
+                return;
+
+            case Read:
+                if (result == -EINTR || result == -EAGAIN)
+                    readRest(slotIndex);
+
+                else if (result < 0)
+                    finish(slotIndex, false);
+
+                else if (result == 0)
+                {
+                    // Shrank since the statx: what is there is the file
+                    slot.buffer.resize(slot.done);
+                    finish(slotIndex, true);
+                }
+
+                else if ((slot.done += static_cast<size_t>(result)) < slot.size)
+                    readRest(slotIndex);
+
+                else
+                    finish(slotIndex, true);
+                return;
+        }
+    };
+
+    try
+    {
+        for (size_t slotIndex = 0; slotIndex < slots.size(); ++slotIndex)
+            start(slotIndex);
+
+        while (inFlight > 0 || !ready.empty())
+        {
+            _ring->submit(ready.empty() ? 1 : 0);
+            _ring->reap(complete);
+
+            // The next reads are queued; submit them before the caller works on these
+            if (!ready.empty())
+                _ring->submit(0);
+
+            for (auto& [position, bytes] : ready)
+            {
+                delivered[position] = true;
+                onFile(position, bytes);
+                recycle(std::move(bytes));
+            }
+
+            ready.clear();
+        }
+    }
+
+    catch (const std::system_error&)
+    {
+        // The ring itself failed: the caller reads the rest, and later batches as well.
+        // Every operation still in flight is waited for first, keeping the fds it opens.
+        try
+        {
+            while (inFlight > 0)
+            {
+                _ring->submit(1);
+                _ring->reap([&](uint64_t userData, int result)
+                    {
+                        --inFlight;
+
+                        if (userData != CLOSE && userData % OPERATIONS == Open && result >= 0)
+                            slots[userData / OPERATIONS].fd = result;
+                    });
+            }
+        }
+        catch (const std::system_error&)
+        {
+        }
+
+        if (inFlight > 0)
+        {
+            // Not even waiting works: the ring and the slots it writes into are left to the process
+            static_cast<void>(slotArray.release());
+            static_cast<void>(_ring.release());
+        }
+        else
+        {
+            for (const auto& slot : slots)
+            {
+                if (slot.busy && slot.fd >= 0)
+                    ::close(slot.fd);
+            }
+
+            _ring.reset();
+        }
+
+        const auto rest = undelivered();
+        failed.insert(failed.end(), rest.begin(), rest.end());
+        return failed;
+    }
+
+    return failed;
+}
+
+#else
+
+struct BatchFileReader::Ring {};
+
+BatchFileReader::BatchFileReader() = default;
+
+std::vector<size_t> BatchFileReader::read(const std::vector<std::filesystem::path>& files, const FileHandler&)
+{
+    std::vector<size_t> positions(files.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    return positions;
+}
+
+#endif
+
+BatchFileReader::~BatchFileReader() = default;
+
+bool BatchFileReader::available() const noexcept
+{
+    return _ring != nullptr;
+}
+
+std::string BatchFileReader::takeBuffer()
+{
+    if (_pool.empty())
+        return {};
+
+    auto buffer = std::move(_pool.back());
+    _pool.pop_back();
+    return buffer;
+}
+
+void BatchFileReader::recycle(std::string&& buffer)
+{
+    if (buffer.capacity() > 0 && _pool.size() < MAX_OPEN_FILES)
+    {
+        buffer.clear();
+        _pool.push_back(std::move(buffer));
+    }
+}
@@ -1,7 +1,99 @@
 #include "CLI.h"
+#include "MatcherCache.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <stdexcept>
 
+// "i/N" with 1 <= i <= N, as given to --shard
+static void parseShard(const std::string& spec, size_t& index, size_t& count)
+{
+    const auto slash = spec.find('/');
+    const auto parse = [&spec](const char* begin, const char* end, size_t& value)
+    {
+        const auto [ptr, error] = std::from_chars(begin, end, value);
+        if (error != std::errc() || ptr != end)
+            throw std::invalid_argument("Invalid --shard " + spec + " (expected i/N)");
+    };
+
+    if (slash == std::string::npos)
+        throw std::invalid_argument("Invalid --shard " + spec + " (expected i/N)");
+
+    size_t number = 0;
+    parse(spec.data(), spec.data() + slash, number);
+    parse(spec.data() + slash + 1, spec.data() + spec.size(), count);
+
+    if (count == 0 || number == 0 || number > count)
+        throw std::invalid_argument("Invalid --shard " + spec + " (expected 1 <= i <= N)");
+
+    index = number - 1;
+}
+
+// A byte count with an optional K/M/G suffix (powers of 1024), as given to --min-size and --max-size
+static uint64_t parseByteSize(const std::string& spec, const char* option)
+{
+    uint64_t value = 0;
+    const auto [ptr, error] = std::from_chars(spec.data(), spec.data() + spec.size(), value);
+    const std::string suffix(ptr, spec.data() + spec.size());
+
+    int shift = -1;
+    if (suffix.empty() || suffix == "B")
+        shift = 0;
+    else if (suffix == "K" || suffix == "k")
+        shift = 10;
+    else if (suffix == "M" || suffix == "m")
+        shift = 20;
+    else if (suffix == "G" || suffix == "g")
+        shift = 30;
+
+    if (error != std::errc() || ptr == spec.data() || shift < 0 || value > (UINT64_MAX >> shift))
+        throw std::invalid_argument(std::string("Invalid ") + option + " " + spec + " (expected a size such as 512K, 10M or 2G)");
+
+    return value << shift;
+}
+
+// A UTC date (YYYY-MM-DD) or an age counted back from now (30d, 12h, 2w), as given to --newer-than and --older-than
+static std::filesystem::file_time_type parseTimeBound(const std::string& spec, const char* option)
+{
+    using namespace std::chrono;
+
+    int year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    int consumed = 0;
+
+    if (std::sscanf(spec.c_str(), "%4d-%2u-%2u%n", &year, &month, &day, &consumed) == 3
+        && static_cast<size_t>(consumed) == spec.size())
+    {
+        const auto date = std::chrono::year(year) / std::chrono::month(month) / std::chrono::day(day);
+        if (date.ok())
+            return file_clock::from_sys(time_point_cast<seconds>(sys_days(date)));
+    }
+
+    uint64_t count = 0;
+    const auto [ptr, error] = std::from_chars(spec.data(), spec.data() + spec.size(), count);
+    const std::string unit(ptr, spec.data() + spec.size());
+
+    seconds perUnit { 0 };
+    if (unit == "s")
+        perUnit = seconds(1);
+    else if (unit == "m")
+        perUnit = minutes(1);
+    else if (unit == "h")
+        perUnit = hours(1);
+    else if (unit == "d")
+        perUnit = days(1);
+    else if (unit == "w")
+        perUnit = weeks(1);
+
+    if (error != std::errc() || ptr == spec.data() || perUnit.count() == 0)
+        throw std::invalid_argument(std::string("Invalid ") + option + " " + spec + " (expected YYYY-MM-DD or an age such as 30d, 12h, 2w)");
+
+    return file_clock::now() - perUnit * static_cast<int64_t>(count);
+}
+
 CLI::CLI(int argc, char* argv[])
     : _options("PIIScanner", "Tool for detecting personally identifiable information in files")
 {
@@ -11,7 +103,38 @@ CLI::CLI(int argc, char* argv[])
         ("r,recursive", "Recursive scanning", cxxopts::value<bool>()->default_value("false"))
         ("s,strategy", "Scanning strategy (regex/keyword/combined)", cxxopts::value<std::string>()->default_value("regex"))
         ("j,json", "Enable JSON export (saves to statistics.json)", cxxopts::value<std::string>()->implicit_value("statistics.json"))
+        ("n,ndjson", "Stream results as JSON Lines (saves to results.ndjson)", cxxopts::value<std::string>()->implicit_value("results.ndjson"))
+        ("b,binary", "Export columnar binary results (saves to results.piib)", cxxopts::value<std::string>()->implicit_value("results.piib"))
+        ("compress", "Compression for streamed output (none/gzip/zstd)", cxxopts::value<std::string>()->default_value("none"))
+        ("v,verbosity", "Console output (full/line/summary)", cxxopts::value<std::string>()->default_value("full"))
+        ("t,triage", "Stop at the first match of each type and skip the rest of the file once all types hit", cxxopts::value<bool>()->default_value("false"))
+        ("max-matches-per-type", "Stop scanning a type in a file after N matches (0 = unlimited)", cxxopts::value<size_t>()->default_value("0"))
+        ("max-memory", "Heap budget per file in MiB, larger files fail with an error (0 = unlimited)", cxxopts::value<size_t>()->default_value("0"))
+        ("memory-budget", "Total MiB of in-flight extraction; files wait for room, oversized ones are streamed (0 = unlimited)", cxxopts::value<size_t>()->default_value("0"))
+        ("threads", "Number of files scanned in parallel", cxxopts::value<size_t>()->default_value("1"))
+        ("shard", "Scan only part i of N of the directory (1-based), for multi-node scans; combine the parts with PIIResultTool merge", cxxopts::value<std::string>())
+        ("schedule", "Order in which files are handed to the threads (walk/size/cost); cost learns per-type scan times in the pattern cache", cxxopts::value<std::string>()->default_value("cost"))
+        ("no-io-uring", "Read every file on its own instead of batching small TXT/XML files through io_uring", cxxopts::value<bool>()->default_value("false"))
+        ("include", "Scan only files matching these globs (.gitignore syntax, relative to the directory)", cxxopts::value<std::vector<std::string>>())
+        ("exclude", "Skip files and directories matching these globs; excluded directories are not descended into", cxxopts::value<std::vector<std::string>>())
+        ("min-size", "Skip files smaller than this (e.g. 1K)", cxxopts::value<std::string>())
+        ("max-size", "Skip files larger than this (e.g. 512M)", cxxopts::value<std::string>())
+        ("newer-than", "Scan only files modified after a date (YYYY-MM-DD) or within an age (e.g. 30d, 12h)", cxxopts::value<std::string>())
+        ("older-than", "Scan only files modified before a date or longer ago than an age", cxxopts::value<std::string>())
+        ("no-ignore-files", "Do not read .piiignore files in the scanned directories", cxxopts::value<bool>()->default_value("false"))
+        ("file-timeout", "Stop extracting a file after N seconds and report its partial results (0 = no limit)", cxxopts::value<double>()->default_value("0"))
+        ("profile-patterns", "Time every pattern and report the most expensive ones", cxxopts::value<bool>()->default_value("false"))
+        ("serve", "Run as a scan daemon on this Unix socket (PATH/DATA/STATS requests, see README)", cxxopts::value<std::string>())
+        ("reload-patterns", "Reload --pattern-config on SIGHUP or when the file changes, without stopping the scan", cxxopts::value<bool>()->default_value("false"))
+        ("trace", "Write a Chrome/Perfetto trace of the scan (needs -DPIIS_ENABLE_TRACING=ON)", cxxopts::value<std::string>())
+        ("top-values", "Number of most recurring match values in the summary", cxxopts::value<size_t>()->default_value("10"))
         ("p,pattern-config", "Pattern configuration file", cxxopts::value<std::string>()->default_value(""))
+        ("no-validate", "Report every regex match, without the Luhn/octet/passport/phone checks of built-in categories", cxxopts::value<bool>()->default_value("false"))
+        ("category-priority", "Categories in order of precedence where matches overlap (default: cardNumber,phone,passport,ip,email,url)", cxxopts::value<std::vector<std::string>>())
+        ("keep-overlaps", "Report every match, including duplicates and overlaps between patterns", cxxopts::value<bool>()->default_value("false"))
+        ("redact", "Write redacted copies of TXT and XML files to this directory", cxxopts::value<std::string>())
+        ("redact-style", "Replacement of redacted matches (mask/token)", cxxopts::value<std::string>()->default_value("mask"))
+        ("pattern-cache", "Directory of prebuilt matcher tables reused across runs, 'none' to disable (default: ~/.cache/piiscanner)", cxxopts::value<std::string>()->default_value(""))
         ("h,help", "Show help message");
 
     try
@@ -51,6 +174,91 @@ GeneralConfig CLI::parse()
     if (_result.count("json"))
         config.outputJson = _result["json"].as<std::string>();
 
+    if (_result.count("ndjson"))
+        config.outputNdjson = _result["ndjson"].as<std::string>();
+
+    if (_result.count("binary"))
+        config.outputBinary = _result["binary"].as<std::string>();
+
+    if (_result.count("trace"))
+        config.traceFile = _result["trace"].as<std::string>();
+
+    if (_result.count("serve"))
+        config.serveSocket = _result["serve"].as<std::string>();
+
+    if (_result.count("redact"))
+        config.redactDir = _result["redact"].as<std::string>();
+
+    config.redactStyle = _result["redact-style"].as<std::string>();
+    config.outputCompression = _result["compress"].as<std::string>();
+    config.triage = _result["triage"].as<bool>();
+    config.maxMatchesPerType = _result["max-matches-per-type"].as<size_t>();
+
+    if (config.triage && config.maxMatchesPerType != 1)
+    {
+        if (config.maxMatchesPerType > 1)
+            std::cerr << "Warning: --triage overrides --max-matches-per-type" << std::endl;
+        config.maxMatchesPerType = 1;
+    }
+
+    config.maxMemoryMiB = _result["max-memory"].as<size_t>();
+    config.memoryBudgetMiB = _result["memory-budget"].as<size_t>();
+    config.threads = std::max<size_t>(1, _result["threads"].as<size_t>());
+
+    if (_result.count("shard"))
+        parseShard(_result["shard"].as<std::string>(), config.shardIndex, config.shardCount);
+
+    config.schedule = _result["schedule"].as<std::string>();
+    config.ioUring = !_result["no-io-uring"].as<bool>();
+
+    if (_result.count("include"))
+        config.includeGlobs = _result["include"].as<std::vector<std::string>>();
+
+    if (_result.count("exclude"))
+        config.excludeGlobs = _result["exclude"].as<std::vector<std::string>>();
+
+    if (_result.count("min-size"))
+        config.minFileBytes = parseByteSize(_result["min-size"].as<std::string>(), "--min-size");
+
+    if (_result.count("max-size"))
+        config.maxFileBytes = parseByteSize(_result["max-size"].as<std::string>(), "--max-size");
+
+    if (_result.count("newer-than"))
+        config.modifiedAfter = parseTimeBound(_result["newer-than"].as<std::string>(), "--newer-than");
+
+    if (_result.count("older-than"))
+        config.modifiedBefore = parseTimeBound(_result["older-than"].as<std::string>(), "--older-than");
+
+    config.ignoreFiles = !_result["no-ignore-files"].as<bool>();
+    config.fileTimeoutSeconds = std::max(0.0, _result["file-timeout"].as<double>());
+    config.profilePatterns = _result["profile-patterns"].as<bool>();
+    config.reloadPatterns = _result["reload-patterns"].as<bool>();
+    config.validateMatches = !_result["no-validate"].as<bool>();
+    config.resolveOverlaps = !_result["keep-overlaps"].as<bool>();
+
+    if (_result.count("category-priority"))
+        config.categoryPriority = _result["category-priority"].as<std::vector<std::string>>();
+    config.topValues = _result["top-values"].as<size_t>();
+    config.consoleVerbosity = _result["verbosity"].as<std::string>();
     config.patternConfigFile = _result["pattern-config"].as<std::string>();
+
+    const auto patternCache = _result["pattern-cache"].as<std::string>();
+    if (patternCache.empty())
+        config.patternCacheDir = MatcherCache::defaultDirectory();
+    else if (patternCache != "none")
+        config.patternCacheDir = patternCache;
+
+    if (!config.redactDir.empty() && config.maxMatchesPerType != 0)
+        std::cerr << "Warning: redacted files are scanned for every match, --max-matches-per-type only applies to the others" << std::endl;
+
+    if (!config.redactDir.empty() && config.strategy != "regex")
+        std::cerr << "Warning: the " << config.strategy << " strategy finds keywords, --redact will mask those and not the values" << std::endl;
+
+    if (config.reloadPatterns && config.patternConfigFile.empty())
+    {
+        std::cerr << "Warning: --reload-patterns needs --pattern-config, ignoring it" << std::endl;
+        config.reloadPatterns = false;
+    }
+
     return config;
 }
\ No newline at end of file
@@ -9,43 +9,106 @@
 
 // TODO: UTF-8
 
-void checkFile(const std::filesystem::path& filePath, size_t maxSize)
+// One stat: the size, or the reason there is none
+uint64_t checkFile(const std::filesystem::path& filePath, size_t maxSize)
 {
-    if (!std::filesystem::exists(filePath))
+    std::error_code error;
+    const auto fileSize = std::filesystem::file_size(filePath, error);
+
+    if (error == std::errc::no_such_file_or_directory)
         throw std::invalid_argument("File does not exist: " + filePath.string());
+    if (error)
+        throw std::filesystem::filesystem_error("Cannot stat file", filePath, error);
 
-    const auto fileSize = std::filesystem::file_size(filePath);
     if (fileSize > maxSize)
         throw std::runtime_error(filePath.string() + " file exceeds maximum size (" +
                                  std::to_string(fileSize) + " > " + std::to_string(maxSize) + ")");
+
+    return fileSize;
+}
+
+void ReaderBase::bytesToText(std::string&, const CancellationToken&)
+{
+    throw std::logic_error("Reader does not parse file bytes");
 }
 
 std::string TxtReader::readText(const std::filesystem::path& filePath)
 {
-    checkFile(filePath, GeneralConfig::MAX_TXT_SIZE);
+    const auto fileSize = checkFile(filePath, GeneralConfig::MAX_TXT_SIZE);
 
     std::ifstream file(filePath, std::ios::binary);
     if (!file)
         throw std::runtime_error("Cannot open file: " + filePath.string());
 
     std::string fileData;
-    const auto fileSize = std::filesystem::file_size(filePath);
     fileData.reserve(static_cast<size_t>(fileSize));
     fileData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
     return fileData;
 }
 
+void TxtReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                           const CancellationToken& token)
+{
+    checkFile(filePath, GeneralConfig::MAX_TXT_SIZE);
+
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open file: " + filePath.string());
+
+    std::string chunk;
+    std::string carry;
+
+    while (!token.isCancelled())
+    {
+        chunk.swap(carry);
+        carry.clear();
+
+        const auto used = chunk.size();
+        chunk.resize(used + CHUNK_SIZE);
+        file.read(chunk.data() + used, static_cast<std::streamsize>(CHUNK_SIZE));
+        chunk.resize(used + static_cast<size_t>(file.gcount()));
+
+        if (chunk.empty())
+            break;
+
+        if (file)
+        {
+            auto cut = chunk.find_last_of('\n');
+            if (cut == std::string::npos)
+                cut = chunk.find_last_of(" \t");
+
+            if (cut != std::string::npos)
+            {
+                carry.assign(chunk, cut + 1);
+                chunk.resize(cut + 1);
+            }
+        }
+
+        onChunk(chunk);
+
+        if (!file)
+            break;
+    }
+}
+
 std::string PptxReader::readText(const std::filesystem::path& filePath)
+{
+    std::string resultData;
+
+    CancellationToken token;
+    readChunks(filePath, [&resultData](const std::string& slide) { resultData += slide; }, token);
+    return resultData;
+}
+
+void PptxReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                            const CancellationToken& token)
 {
     checkFile(filePath, GeneralConfig::MAX_PPTX_SIZE);
 
     try
     {
         libzippp::ZipArchive zip(filePath.string().c_str());
-        std::string resultData;
-        resultData.reserve(static_cast<size_t>(GeneralConfig::MAX_PPTX_SIZE));
-        extractPptxData(zip, resultData);
-        return resultData;
+        extractPptxData(zip, onChunk, token);
     }
     catch (const std::exception& e)
     {
@@ -53,7 +116,7 @@ std::string PptxReader::readText(const std::filesystem::path& filePath)
     }
 }
 
-void PptxReader::extractPptxData(libzippp::ZipArchive& zip, std::string& resultData)
+void PptxReader::extractPptxData(libzippp::ZipArchive& zip, const ChunkHandler& onSlide, const CancellationToken& token)
 {
     if (!zip.open(libzippp::ZipArchive::ReadOnly))
         throw std::runtime_error("Failed to open PPTX archive");
@@ -63,6 +126,9 @@ void PptxReader::extractPptxData(libzippp::ZipArchive& zip, std::string& resultD
         std::vector<libzippp::ZipEntry> zipEntries = zip.getEntries();
         for (const auto& zipEntry: zipEntries)
         {
+            if (token.isCancelled())
+                break;
+
             const auto zipEntryName = zipEntry.getName();
             if (zipEntryName.find("ppt/slides/slide") != std::string::npos &&
                 zipEntryName.find(".xml") != std::string::npos)
@@ -71,7 +137,11 @@ void PptxReader::extractPptxData(libzippp::ZipArchive& zip, std::string& resultD
                     continue;
 
                 const auto xmlData = zipEntry.readAsText();
-                extractSlideData(xmlData, resultData);
+                std::string slideData;
+                extractSlideData(xmlData, slideData);
+
+                if (!slideData.empty())
+                    onSlide(slideData);
             }
         }
     }
@@ -136,6 +206,16 @@ void PptxReader::processSlideNode(const pugi::xml_node& node, std::string& resul
 }
 
 std::string PdfReader::readText(const std::filesystem::path& filePath)
+{
+    std::string resultData;
+
+    CancellationToken token;
+    readChunks(filePath, [&resultData](const std::string& page) { resultData += page; }, token);
+    return resultData;
+}
+
+void PdfReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                           const CancellationToken& token)
 {
     checkFile(filePath, GeneralConfig::MAX_PDF_SIZE);
 
@@ -143,7 +223,7 @@ std::string PdfReader::readText(const std::filesystem::path& filePath)
     {
         const auto u8Path = filePath.u8string();
         std::string utf8Path(u8Path.begin(), u8Path.end());
-        auto pdf = poppler::document::load_from_file(utf8Path);
+        std::unique_ptr<poppler::document> pdf(poppler::document::load_from_file(utf8Path));
 
         if (!pdf)
             throw std::runtime_error("Failed to load PDF: " + filePath.string());
@@ -151,23 +231,18 @@ std::string PdfReader::readText(const std::filesystem::path& filePath)
         if (pdf->is_locked())
             throw std::runtime_error("Encrypted PDF not supported: " + filePath.string());
 
-        std::string resultData;
-        resultData.reserve(static_cast<size_t>(GeneralConfig::MAX_PDF_SIZE));
-
-        const auto numPages = pdf->pages();
+        const int numPages = pdf->pages();
 
-        for (size_t page = 0; page < numPages; ++page)
+        for (int page = 0; page < numPages && !token.isCancelled(); ++page)
         {
-            auto pageData = pdf->create_page(static_cast<int>(page));
+            std::unique_ptr<poppler::page> pageData(pdf->create_page(page));
             if (pageData)
             {
                 const auto byteArray = pageData->text().to_utf8();
                 if (!byteArray.empty())
-                    resultData.append(byteArray.begin(), byteArray.end());
+                    onChunk(std::string(byteArray.begin(), byteArray.end()));
             }
         }
-
-        return resultData;
     }
     catch (const std::exception& e)
     {
@@ -176,6 +251,20 @@ std::string PdfReader::readText(const std::filesystem::path& filePath)
 }
 
 std::string DocxReader::readText(const std::filesystem::path& filePath)
+{
+    CancellationToken token;
+    return extractText(filePath, token);
+}
+
+void DocxReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                            const CancellationToken& token)
+{
+    const auto resultData = extractText(filePath, token);
+    if (!resultData.empty())
+        onChunk(resultData);
+}
+
+std::string DocxReader::extractText(const std::filesystem::path& filePath, const CancellationToken& token)
 {
     checkFile(filePath, GeneralConfig::MAX_DOCX_SIZE);
 
@@ -183,10 +272,7 @@ std::string DocxReader::readText(const std::filesystem::path& filePath)
     {
         libzippp::ZipArchive zip(filePath.string().c_str());
         std::string resultData;
-
-        resultData.reserve(static_cast<size_t>(GeneralConfig::MAX_DOCX_SIZE)); // TODO:
-
-        extractDocxData(zip, resultData);
+        extractDocxData(zip, resultData, token);
         return resultData;
     }
     catch (const std::exception& e)
@@ -195,7 +281,7 @@ std::string DocxReader::readText(const std::filesystem::path& filePath)
     }
 }
 
-void DocxReader::extractDocxData(libzippp::ZipArchive& zip, std::string& resultData)
+void DocxReader::extractDocxData(libzippp::ZipArchive& zip, std::string& resultData, const CancellationToken& token)
 {
     if (!zip.open(libzippp::ZipArchive::ReadOnly))
         throw std::runtime_error("Failed to open DOCX archive");
@@ -212,7 +298,8 @@ void DocxReader::extractDocxData(libzippp::ZipArchive& zip, std::string& resultD
         if (static_cast<libzippp_uint64>(xmlData.size()) != fileSize)
             throw std::runtime_error("Failed to read full document.xml content");
 
-        extractXmlData(xmlData, resultData);
+        if (!token.isCancelled())
+            extractXmlData(xmlData, resultData, token);
     }
     catch (...)
     {
@@ -222,7 +309,7 @@ void DocxReader::extractDocxData(libzippp::ZipArchive& zip, std::string& resultD
     zip.close();
 }
 
-void DocxReader::extractXmlData(const std::string& xmlData, std::string& resultData)
+void DocxReader::extractXmlData(const std::string& xmlData, std::string& resultData, const CancellationToken& token)
 {
     pugi::xml_document xmlDoc;
     const auto parseResult = xmlDoc.load_string(xmlData.c_str(), pugi::parse_default | pugi::parse_escapes);
@@ -236,10 +323,15 @@ void DocxReader::extractXmlData(const std::string& xmlData, std::string& resultD
         throw std::runtime_error("Invalid DOCX structure: missing body element");
 
     for (const auto& child: xmlBody.children())
-        processXmlNode(child, resultData);
+    {
+        if (token.isCancelled())
+            break;
+
+        processXmlNode(child, resultData, token);
+    }
 }
 
-void DocxReader::processXmlNode(const pugi::xml_node& node, std::string& resultData)
+void DocxReader::processXmlNode(const pugi::xml_node& node, std::string& resultData, const CancellationToken& token)
 {
     const auto nodeName = node.name();
 
@@ -257,7 +349,12 @@ void DocxReader::processXmlNode(const pugi::xml_node& node, std::string& resultD
         resultData += '\n';
 
     for (const auto& child: node.children())
-        processXmlNode(child, resultData);
+    {
+        if (token.isCancelled())
+            return;
+
+        processXmlNode(child, resultData, token);
+    }
 
     if ((std::strcmp(nodeName, "w:r") == 0 || std::strcmp(nodeName, "wp:r") == 0 ||
         std::strcmp(nodeName, "w:p") == 0 || std::strcmp(nodeName, "wp:p") == 0) &&
@@ -269,14 +366,45 @@ void DocxReader::processXmlNode(const pugi::xml_node& node, std::string& resultD
 
 std::string XmlReader::readText(const std::filesystem::path& filePath)
 {
-    checkFile(filePath, GeneralConfig::MAX_XML_SIZE);
+    CancellationToken token;
+    return extractText(filePath, token);
+}
+
+void XmlReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                           const CancellationToken& token)
+{
+    const auto resultData = extractText(filePath, token);
+    if (!resultData.empty())
+        onChunk(resultData);
+}
+
+void XmlReader::bytesToText(std::string& data, const CancellationToken& token)
+{
+    try
+    {
+        std::string resultData;
+        resultData.reserve(data.size());
+        extractDataFromXml(data, resultData, token);
+        data.swap(resultData);
+    }
+    catch (const std::exception& e)
+    {
+        throw std::runtime_error("XML processing error: " + std::string(e.what()));
+    }
+}
+
+std::string XmlReader::extractText(const std::filesystem::path& filePath, const CancellationToken& token)
+{
+    const auto fileSize = checkFile(filePath, GeneralConfig::MAX_XML_SIZE);
     try
     {
         std::ifstream file(filePath, std::ios::binary);
-        std::string xmlData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string xmlData;
+        xmlData.reserve(static_cast<size_t>(fileSize));
+        xmlData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
         std::string resultData;
-        resultData.reserve(static_cast<size_t>(GeneralConfig::MAX_XML_SIZE));   // TODO:
-        extractDataFromXml(xmlData, resultData);
+        resultData.reserve(xmlData.size());     // text is never longer than its markup
+        extractDataFromXml(xmlData, resultData, token);
         return resultData;
     }
     catch (const std::exception& e)
@@ -285,46 +413,67 @@ std::string XmlReader::readText(const std::filesystem::path& filePath)
     }
 }
 
-void XmlReader::extractDataFromXml(const std::string& xmlData, std::string& resultData)
+void XmlReader::extractDataFromXml(const std::string& xmlData, std::string& resultData, const CancellationToken& token)
 {
     pugi::xml_document xmlDoc;
     if (!xmlDoc.load_string(xmlData.c_str()))
         throw std::runtime_error("Failed to parse XML file");
 
-    processXmlNode(xmlDoc, resultData);
+    processXmlNode(xmlDoc, resultData, token);
 }
 
-void XmlReader::processXmlNode(const pugi::xml_node& node, std::string& resultData)
+void XmlReader::processXmlNode(const pugi::xml_node& node, std::string& resultData, const CancellationToken& token)
 {
     for (const auto& child: node.children())
     {
+        if (token.isCancelled())
+            return;
+
         if (child.type() == pugi::node_pcdata || child.type() == pugi::node_cdata)
             resultData += child.value();
         else if (child.type() == pugi::node_element)
         {
             if (!resultData.empty() && resultData.back() != ' ' && resultData.back() != '\n' && resultData.back() != '\t')
                 resultData += ' ';
-            processXmlNode(child, resultData);
+            processXmlNode(child, resultData, token);
         }
     }
 }
 
 std::string XlsxReader::readText(const std::filesystem::path& filePath)
+{
+    std::string resultData;
+
+    CancellationToken token;
+    readChunks(filePath, [&resultData](const std::string& sheet)
+        {
+            if (!resultData.empty())
+                resultData += "\n\n";
+
+            resultData += sheet;
+        }, token);
+
+    return resultData;
+}
+
+void XlsxReader::readChunks(const std::filesystem::path& filePath, const ChunkHandler& onChunk,
+                            const CancellationToken& token)
 {
     checkFile(filePath, GeneralConfig::MAX_XLSX_SIZE);
     try
     {
         xlnt::workbook wb;
         wb.load(filePath.string());
-        std::string resultData;
-        resultData.reserve(static_cast<size_t>(GeneralConfig::MAX_XLSX_SIZE) * 2);  // TODO:
-        for (std::size_t i = 0; i < wb.sheet_count(); ++i)
+        for (std::size_t i = 0; i < wb.sheet_count() && !token.isCancelled(); ++i)
         {
             auto ws = wb.sheet_by_index(i);
             std::string sheetString;
 
             for (auto row: ws.rows(false))
             {
+                if (token.isCancelled())
+                    break;
+
                 std::string rowString;
                 for (auto cell: row)
                 {
@@ -349,15 +498,8 @@ std::string XlsxReader::readText(const std::filesystem::path& filePath)
             }
 
             if (!sheetString.empty())
-            {
-                if (!resultData.empty())
-                    resultData += "\n\n";
-
-                resultData += sheetString;
-            }
+                onChunk(sheetString);
         }
-
-        return resultData;
     }
     catch (const std::exception& e)
     {
@@ -0,0 +1,191 @@
+#include "FileScheduler.h"
+#include "FileReaders.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+SchedulePolicy parseSchedulePolicy(const std::string& name)
+{
+    if (name == "walk")
+        return SchedulePolicy::Walk;
+    if (name == "size")
+        return SchedulePolicy::Size;
+    if (name.empty() || name == "cost")
+        return SchedulePolicy::Cost;
+
+    throw std::invalid_argument("Unsupported schedule: " + name);
+}
+
+const char* schedulePolicyName(SchedulePolicy policy)
+{
+    static constexpr const char* names[] = { "walk", "size", "cost" };
+    return names[static_cast<size_t>(policy)];
+}
+
+namespace
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+    constexpr int COST_FILE_VERSION = 1;
+
+    struct BuiltInRate
+    {
+        const char* fileType;
+        double fixedSeconds;
+        double secondsPerMiB;
+    };
+
+    // Order of magnitude only: decompression, DOM and layout work make the office formats and PDF slow
+    constexpr BuiltInRate BUILT_IN_RATES[] =
+    {
+        { ".txt",  0.0002, 0.004 },
+        { ".xml",  0.0005, 0.015 },
+        { ".docx", 0.002,  0.05 },
+        { ".pptx", 0.002,  0.05 },
+        { ".pdf",  0.005,  0.25 },
+        { ".xlsx", 0.005,  0.5 },
+    };
+
+    constexpr BuiltInRate OTHER_RATE = { "", 0.001, 0.05 };
+}
+
+void ScanCostModel::Fit::add(const Fit& other, double weight)
+{
+    files += other.files * weight;
+    bytes += other.bytes * weight;
+    seconds += other.seconds * weight;
+    bytesSeconds += other.bytesSeconds * weight;
+    bytesSquared += other.bytesSquared * weight;
+}
+
+ScanCostModel::ScanCostModel(const std::filesystem::path& filePath)
+{
+    std::ifstream in(filePath);
+
+    if (!in)
+        return;
+
+    try
+    {
+        const auto json = nlohmann::json::parse(in);
+
+        if (json.value("version", 0) != COST_FILE_VERSION)
+            return;
+
+        for (const auto& [fileType, fit] : json.at("types").items())
+        {
+            _history[fileType] = { fit.at("files").get<double>(), fit.at("bytes").get<double>(),
+                                   fit.at("seconds").get<double>(), fit.at("bytes_seconds").get<double>(),
+                                   fit.at("bytes_squared").get<double>() };
+        }
+    }
+    catch (const std::exception&)
+    {
+        // Damaged history: start over from the built-in rates
+        _history.clear();
+    }
+}
+
+void ScanCostModel::save(const std::filesystem::path& filePath) const
+{
+    std::map<std::string, Fit> merged;
+
+    {
+        std::lock_guard lock(_mutex);
+
+        for (const auto& [fileType, fit] : _history)
+            merged[fileType].add(fit, 0.5);
+
+        for (const auto& [fileType, fit] : _run)
+            merged[fileType].add(fit, 1.0);
+    }
+
+    nlohmann::json json;
+    json["version"] = COST_FILE_VERSION;
+    json["types"] = nlohmann::json::object();
+
+    for (const auto& [fileType, fit] : merged)
+        json["types"][fileType] = { {"files", fit.files}, {"bytes", fit.bytes}, {"seconds", fit.seconds},
+                                    {"bytes_seconds", fit.bytesSeconds}, {"bytes_squared", fit.bytesSquared} };
+
+    auto temporary = filePath;
+    temporary += "." + std::to_string(::getpid()) + ".tmp";
+
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+
+        if (!out || !(out << json.dump(2) << std::endl))
+        {
+            std::filesystem::remove(temporary);
+            throw std::runtime_error("Failed to write output file: " + temporary.string());
+        }
+    }
+
+    std::filesystem::rename(temporary, filePath);
+}
+
+double ScanCostModel::estimate(const std::string& fileType, uint64_t bytes) const
+{
+    const auto size = static_cast<double>(bytes);
+
+    if (const auto it = _history.find(fileType); it != _history.end() && it->second.files >= MIN_FILES)
+    {
+        const auto& fit = it->second;
+        const double spread = fit.files * fit.bytesSquared - fit.bytes * fit.bytes;
+        double perByte = spread > 0.0 ? (fit.files * fit.bytesSeconds - fit.bytes * fit.seconds) / spread : -1.0;
+
+        // Files of one size, or a negative slope from noise: the average rate carries everything
+        if (perByte < 0.0)
+            perByte = fit.bytes > 0.0 ? fit.seconds / fit.bytes : 0.0;
+
+        const double fixed = std::max(0.0, (fit.seconds - perByte * fit.bytes) / fit.files);
+        return fixed + perByte * size;
+    }
+
+    const auto rate = std::find_if(std::begin(BUILT_IN_RATES), std::end(BUILT_IN_RATES),
+        [&fileType](const BuiltInRate& builtIn) { return fileType == builtIn.fileType; });
+    const auto& builtIn = rate != std::end(BUILT_IN_RATES) ? *rate : OTHER_RATE;
+
+    return builtIn.fixedSeconds + builtIn.secondsPerMiB * size / MIB;
+}
+
+void ScanCostModel::record(const std::string& fileType, uint64_t bytes, double seconds)
+{
+    const auto size = static_cast<double>(bytes);
+
+    std::lock_guard lock(_mutex);
+    _run[fileType].add({ 1.0, size, seconds, size * seconds, size * size }, 1.0);
+}
+
+void scheduleFiles(std::vector<WalkedFile>& files, SchedulePolicy policy, const ScanCostModel& costs)
+{
+    if (policy == SchedulePolicy::Size)
+    {
+        std::stable_sort(files.begin(), files.end(),
+            [](const WalkedFile& lhs, const WalkedFile& rhs) { return lhs.bytes > rhs.bytes; });
+    }
+
+    else if (policy == SchedulePolicy::Cost)
+    {
+        std::vector<std::pair<double, size_t>> order(files.size());
+
+        for (size_t index = 0; index < files.size(); ++index)
+        {
+            const auto fileType = FileReaderFactory::normalizeExtension(files[index].path.extension().string());
+            order[index] = { costs.estimate(fileType, files[index].bytes), index };
+        }
+
+        std::stable_sort(order.begin(), order.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+        std::vector<WalkedFile> sorted;
+        sorted.reserve(files.size());
+
+        for (const auto& [cost, index] : order)
+            sorted.push_back(std::move(files[index]));
+
+        files = std::move(sorted);
+    }
+}
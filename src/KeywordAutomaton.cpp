@@ -0,0 +1,175 @@
+#include "KeywordAutomaton.h"
+
+#include <map>
+#include <stdexcept>
+
+KeywordAutomaton KeywordAutomaton::build(const std::vector<std::string>& keywords)
+{
+    if (keywords.size() >= NONE)
+        throw std::length_error("Too many keywords for one automaton");
+
+    // Trie first, with children kept sorted so the edge table comes out sorted
+    std::vector<std::map<unsigned char, uint32_t>> children(1);
+    std::vector<std::vector<uint32_t>> ends(1);
+
+    for (uint32_t id = 0; id < keywords.size(); ++id)
+    {
+        const auto& keyword = keywords[id];
+        if (keyword.empty())
+            continue;
+
+        uint32_t state = 0;
+
+        for (const unsigned char byte : keyword)
+        {
+            auto [it, inserted] = children[state].try_emplace(byte, static_cast<uint32_t>(children.size()));
+            if (inserted)
+            {
+                children.emplace_back();
+                ends.emplace_back();
+            }
+
+            state = it->second;
+        }
+
+        ends[state].push_back(id);
+    }
+
+    KeywordAutomaton automaton;
+    automaton._states.resize(children.size());
+    automaton._lengths.reserve(keywords.size());
+
+    for (const auto& keyword : keywords)
+        automaton._lengths.push_back(static_cast<uint32_t>(keyword.size()));
+
+    for (uint32_t state = 0; state < children.size(); ++state)
+    {
+        auto& flat = automaton._states[state];
+        flat.firstEdge = static_cast<uint32_t>(automaton._edges.size());
+        flat.edgeCount = static_cast<uint32_t>(children[state].size());
+        flat.fail = 0;
+        flat.dictionary = NONE;
+        flat.firstOutput = static_cast<uint32_t>(automaton._outputs.size());
+        flat.outputCount = static_cast<uint32_t>(ends[state].size());
+
+        for (const auto& [byte, target] : children[state])
+            automaton._edges.push_back({ byte, target });
+
+        automaton._outputs.insert(automaton._outputs.end(), ends[state].begin(), ends[state].end());
+    }
+
+    automaton._tables = { automaton._states, automaton._edges, automaton._outputs, automaton._lengths };
+    automaton.buildRootTable();
+
+    // Fail and dictionary links in breadth-first order: a state's links only
+    // depend on states closer to the root
+    std::vector<uint32_t> queue;
+    queue.reserve(children.size());
+
+    for (const auto& [byte, child] : children[0])
+        queue.push_back(child);
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const uint32_t state = queue[head];
+
+        for (const auto& [byte, child] : children[state])
+        {
+            // next() only follows links of states already in the queue
+            auto& target = automaton._states[child];
+            target.fail = automaton.next(automaton._states[state].fail, byte);
+
+            const auto& fail = automaton._states[target.fail];
+            target.dictionary = fail.outputCount != 0 ? target.fail : fail.dictionary;
+
+            queue.push_back(child);
+        }
+    }
+
+    return automaton;
+}
+
+KeywordAutomaton KeywordAutomaton::view(const Tables& tables)
+{
+    const size_t stateCount = tables.states.size();
+
+    if (stateCount == 0)
+    {
+        if (!tables.edges.empty() || !tables.outputs.empty() || !tables.lengths.empty())
+            throw std::runtime_error("Corrupted keyword automaton: no root state");
+
+        return {};
+    }
+
+    for (const auto& state : tables.states)
+    {
+        if (state.firstEdge > tables.edges.size() || state.edgeCount > tables.edges.size() - state.firstEdge ||
+            state.firstOutput > tables.outputs.size() || state.outputCount > tables.outputs.size() - state.firstOutput ||
+            state.fail >= stateCount || (state.dictionary != NONE && state.dictionary >= stateCount))
+            throw std::runtime_error("Corrupted keyword automaton: state out of range");
+    }
+
+    // The edges must form a tree under the root, and every link must point
+    // closer to the root, or next() could loop on a corrupted file
+    std::vector<uint32_t> depth(stateCount, NONE);
+    std::vector<uint32_t> queue { 0 };
+    depth[0] = 0;
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const auto& state = tables.states[queue[head]];
+
+        for (uint32_t i = 0; i < state.edgeCount; ++i)
+        {
+            const auto& edge = tables.edges[state.firstEdge + i];
+
+            if (edge.byte > 0xFF || edge.target >= stateCount || depth[edge.target] != NONE ||
+                (i > 0 && tables.edges[state.firstEdge + i - 1].byte >= edge.byte))
+                throw std::runtime_error("Corrupted keyword automaton: bad edge");
+
+            depth[edge.target] = depth[queue[head]] + 1;
+            queue.push_back(edge.target);
+        }
+    }
+
+    if (queue.size() != stateCount)
+        throw std::runtime_error("Corrupted keyword automaton: unreachable state");
+
+    for (uint32_t id = 1; id < stateCount; ++id)
+    {
+        const auto& state = tables.states[id];
+
+        if (depth[state.fail] >= depth[id] || (state.dictionary != NONE && depth[state.dictionary] >= depth[id]))
+            throw std::runtime_error("Corrupted keyword automaton: bad link");
+
+        // Outputs are reported at their end, the length must be the state's depth
+        for (uint32_t i = 0; i < state.outputCount; ++i)
+        {
+            const auto keyword = tables.outputs[state.firstOutput + i];
+
+            if (keyword >= tables.lengths.size() || tables.lengths[keyword] != depth[id])
+                throw std::runtime_error("Corrupted keyword automaton: bad output");
+        }
+    }
+
+    if (tables.states[0].outputCount != 0 || tables.states[0].dictionary != NONE)
+        throw std::runtime_error("Corrupted keyword automaton: bad root");
+
+    KeywordAutomaton automaton;
+    automaton._tables = tables;
+    automaton.buildRootTable();
+    return automaton;
+}
+
+void KeywordAutomaton::buildRootTable()
+{
+    _rootNext.fill(0);
+
+    const auto& root = _tables.states[0];
+
+    for (uint32_t i = 0; i < root.edgeCount; ++i)
+    {
+        const auto& edge = _tables.edges[root.firstEdge + i];
+        _rootNext[edge.byte] = edge.target;
+    }
+}
@@ -0,0 +1,55 @@
+#include "MatchResolver.h"
+#include "DefaultPatterns.h"
+#include <algorithm>
+
+MatchResolver MatchResolver::defaults()
+{
+    return MatchResolver(std::vector<std::string>(std::begin(DefaultPatterns::PRIORITY), std::end(DefaultPatterns::PRIORITY)));
+}
+
+std::vector<uint32_t> MatchResolver::ranks(const std::vector<std::string>& categories) const
+{
+    std::vector<uint32_t> ranks(categories.size());
+
+    for (size_t category = 0; category < categories.size(); ++category)
+    {
+        const auto it = std::find(_priority.begin(), _priority.end(), categories[category]);
+        ranks[category] = static_cast<uint32_t>(it != _priority.end() ? it - _priority.begin()
+                                                                      : _priority.size() + category);
+    }
+
+    return ranks;
+}
+
+void MatchResolver::resolve(std::vector<MatchSpan>& spans, std::span<const uint32_t> ranks) const
+{
+    if (!_enabled)
+        return;
+
+    // By position, then the winner of a tie first: higher priority, then longer
+    std::sort(spans.begin(), spans.end(), [&ranks](const MatchSpan& lhs, const MatchSpan& rhs)
+    {
+        if (lhs.begin != rhs.begin)
+            return lhs.begin < rhs.begin;
+        if (ranks[lhs.category] != ranks[rhs.category])
+            return ranks[lhs.category] < ranks[rhs.category];
+        return lhs.end > rhs.end;
+    });
+
+    size_t kept = 0;
+
+    for (const auto& span : spans)
+    {
+        if (kept > 0 && spans[kept - 1].end > span.begin)
+        {
+            // Starts inside the last kept span: only a higher-priority category takes its place
+            if (ranks[span.category] < ranks[spans[kept - 1].category])
+                spans[kept - 1] = span;
+            continue;
+        }
+
+        spans[kept++] = span;
+    }
+
+    spans.resize(kept);
+}
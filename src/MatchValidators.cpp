@@ -0,0 +1,185 @@
+#include "MatchValidators.h"
+#include <array>
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static bool isLetter(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+void LuhnValidator::validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const
+{
+    // Digits right-aligned in an even number of columns, so every even column
+    // is doubled whatever the length; the zero padding adds nothing
+    constexpr size_t WIDTH = 20;
+    std::array<std::array<uint8_t, WIDTH>, BATCH_SIZE> digits {};
+    std::array<uint8_t, BATCH_SIZE> usable {};
+
+    for (size_t row = 0; row < matches.size(); ++row)
+    {
+        const auto match = matches[row];
+        size_t count = 0;
+        bool clean = true;
+
+        for (const char c : match)
+        {
+            if (isDigit(c))
+                ++count;
+            else if (c != ' ' && c != '-')
+                clean = false;
+        }
+
+        if (!clean || count < 12 || count > 19)
+            continue;
+
+        size_t column = WIDTH;
+        for (auto it = match.rbegin(); it != match.rend(); ++it)
+            if (isDigit(*it))
+                digits[row][--column] = static_cast<uint8_t>(*it - '0');
+
+        usable[row] = 1;
+    }
+
+    // Fixed trip count and no branches: the compiler runs this over the batch in vector registers
+    for (size_t row = 0; row < matches.size(); ++row)
+    {
+        unsigned sum = 0;
+
+        for (size_t column = 0; column < WIDTH; column += 2)
+        {
+            const unsigned doubled = digits[row][column] * 2u;
+            sum += doubled - (doubled > 9 ? 9 : 0) + digits[row][column + 1];
+        }
+
+        // A zero sum means all zeros, which passes Luhn but is no card
+        valid[row] = usable[row] & (sum % 10 == 0) & (sum != 0);
+    }
+}
+
+static bool isIpAddress(std::string_view text)
+{
+    size_t pos = 0;
+
+    for (int octet = 0; octet < 4; ++octet)
+    {
+        if (octet > 0)
+        {
+            if (pos == text.size() || text[pos] != '.')
+                return false;
+            ++pos;
+        }
+
+        const size_t start = pos;
+        unsigned value = 0;
+
+        while (pos < text.size() && isDigit(text[pos]) && pos - start < 4)
+            value = value * 10 + static_cast<unsigned>(text[pos++] - '0');
+
+        const size_t length = pos - start;
+
+        if (length == 0 || length > 3 || value > 255 || (length > 1 && text[start] == '0'))
+            return false;
+
+        if (octet == 0 && value == 0)
+            return false;
+    }
+
+    return pos == text.size();
+}
+
+void IpOctetValidator::validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const
+{
+    for (size_t row = 0; row < matches.size(); ++row)
+        valid[row] = isIpAddress(matches[row]);
+}
+
+static bool isPassportNumber(std::string_view text)
+{
+    std::array<char, 16> compact {};
+    size_t length = 0;
+
+    for (const char c : text)
+    {
+        if (c == ' ' || c == '-' || c == '\t' || c == '\n' || c == '\r' || c == '\f')
+            continue;
+        if (length == compact.size())
+            return true;    // not a shape known here
+        compact[length++] = c;
+    }
+
+    const std::string_view number(compact.data(), length);
+    const auto allDigits = [](std::string_view part)
+    {
+        for (const char c : part)
+            if (!isDigit(c))
+                return false;
+        return true;
+    };
+
+    // Russian internal passport: 2-digit region, 2-digit year, 6-digit number
+    if (length == 10 && allDigits(number))
+    {
+        if (number.substr(0, 2) == "00" || number.substr(4) == "000000")
+            return false;
+
+        return number.find_first_not_of(number[0]) != std::string_view::npos;
+    }
+
+    // Two letters and seven digits
+    if (length == 9 && isLetter(number[0]) && isLetter(number[1]) && allDigits(number.substr(2)))
+        return number.substr(2) != "0000000";
+
+    return true;
+}
+
+void PassportValidator::validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const
+{
+    for (size_t row = 0; row < matches.size(); ++row)
+        valid[row] = isPassportNumber(matches[row]);
+}
+
+static bool isPhoneNumber(std::string_view text)
+{
+    std::array<char, 16> digits {};
+    size_t count = 0;
+
+    for (const char c : text)
+    {
+        if (!isDigit(c))
+            continue;
+        if (count == digits.size())
+            return false;
+        digits[count++] = c;
+    }
+
+    if (count < 8 || count > 15)
+        return false;
+
+    if (count == 11 && digits[0] == '7')
+        return digits[1] != '0' && digits[1] != '1' && digits[1] != '2' && digits[1] != '5';
+
+    if (count == 11 && digits[0] == '1')
+        return digits[1] >= '2' && digits[4] >= '2';
+
+    return true;
+}
+
+void PhoneValidator::validate(std::span<const std::string_view> matches, std::span<uint8_t> valid) const
+{
+    for (size_t row = 0; row < matches.size(); ++row)
+        valid[row] = isPhoneNumber(matches[row]);
+}
+
+MatchValidators MatchValidators::defaults()
+{
+    MatchValidators validators;
+    validators.add("cardNumber", std::make_shared<LuhnValidator>());
+    validators.add("ip", std::make_shared<IpOctetValidator>());
+    validators.add("passport", std::make_shared<PassportValidator>());
+    validators.add("phone", std::make_shared<PhoneValidator>());
+    return validators;
+}
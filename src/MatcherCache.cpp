@@ -0,0 +1,442 @@
+#include "MatcherCache.h"
+#include "DefaultPatterns.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <re2/filtered_re2.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(PIIMatcherCache::Header) % 8 == 0, "Header must keep sections 8-byte aligned");
+
+namespace
+{
+    // Same folding as KeywordStrategy, which matches on lowercased text
+    std::string toLower(const std::string& value)
+    {
+        std::string lower = value;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower;
+    }
+
+    // Literals every match of the pattern contains, lowercased; empty when the
+    // pattern can match without one and so always has to run
+    std::vector<std::string> prefilterAtoms(const std::string& pattern)
+    {
+        RE2::Options options;
+        options.set_log_errors(false);
+
+        re2::FilteredRE2 filter(PIIMatcherCache::MIN_ATOM_LENGTH);
+        int id = 0;
+
+        // Invalid patterns are reported by RegexStrategy
+        if (filter.Add(pattern, options, &id) != RE2::NoError)
+            return {};
+
+        std::vector<std::string> atoms;
+        filter.Compile(&atoms);
+
+        std::vector<int> unfiltered;
+        filter.AllPotentials({}, &unfiltered);
+
+        if (!unfiltered.empty() || atoms.empty())
+            return {};
+
+        // Atoms are Unicode-lowercased but the text is only ASCII-lowercased
+        for (const auto& atom : atoms)
+            for (const unsigned char c : atom)
+                if (c >= 0x80)
+                    return {};
+
+        return atoms;
+    }
+
+    class Fnv1a
+    {
+    public:
+        void add(const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+                _hash = (_hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+
+        void add(uint64_t value) { add(&value, sizeof(value)); }
+
+        void add(const std::string& value)
+        {
+            add(static_cast<uint64_t>(value.size()));
+            add(value.data(), value.size());
+        }
+
+        uint64_t value() const noexcept { return _hash; }
+
+    private:
+        uint64_t _hash = 0xcbf29ce484222325ULL;
+    };
+
+    class SectionWriter
+    {
+    public:
+        explicit SectionWriter(std::ofstream& out): _out(out) {}
+
+        uint64_t position() const noexcept { return _position; }
+
+        void write(const void* data, size_t size)
+        {
+            _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            _position += size;
+        }
+
+        template<typename T>
+        void write(std::span<const T> column)
+        {
+            write(column.data(), column.size_bytes());
+        }
+
+        void pad()
+        {
+            static constexpr char zeros[8] = {};
+            if (const auto rest = _position % 8; rest != 0)
+                write(zeros, 8 - rest);
+        }
+
+    private:
+        std::ofstream& _out;
+        uint64_t _position = 0;
+    };
+}
+
+CompiledMatchers::~CompiledMatchers()
+{
+    if (_mapping)
+        ::munmap(const_cast<char*>(_mapping), _mappingSize);
+}
+
+uint64_t CompiledMatchers::fingerprint(const PatternMap& patterns, const PatternMap& keywords)
+{
+    Fnv1a hash;
+    hash.add(static_cast<uint64_t>(PIIMatcherCache::VERSION));
+    hash.add(static_cast<uint64_t>(PIIMatcherCache::MIN_ATOM_LENGTH));
+
+    for (const auto* map : { &patterns, &keywords })
+    {
+        hash.add(static_cast<uint64_t>(map->size()));
+
+        for (const auto& [name, values] : *map)
+        {
+            hash.add(name);
+            hash.add(static_cast<uint64_t>(values.size()));
+
+            for (const auto& value : values)
+                hash.add(value);
+        }
+    }
+
+    return hash.value();
+}
+
+std::shared_ptr<const CompiledMatchers> CompiledMatchers::build(const PatternMap& patterns, const PatternMap& keywords)
+{
+    std::shared_ptr<CompiledMatchers> matchers(new CompiledMatchers());
+    matchers->_fingerprint = fingerprint(patterns, keywords);
+
+    std::vector<std::string> lowerKeywords;
+    uint32_t category = 0;
+
+    for (const auto& [name, words] : keywords)
+    {
+        for (const auto& word : words)
+        {
+            lowerKeywords.push_back(toLower(word));
+            matchers->_ownKeywordCategories.push_back(category);
+        }
+
+        ++category;
+    }
+
+    matchers->_keywords = KeywordAutomaton::build(lowerKeywords);
+
+    std::vector<std::string> atoms;
+    std::map<std::string, uint32_t> atomIds;
+    std::vector<std::vector<uint32_t>> patternsOfAtom;
+    uint32_t number = 0;
+
+    for (const auto& [type, list] : patterns)
+    {
+        for (const auto& pattern : list)
+        {
+            const auto patternAtoms = prefilterAtoms(pattern);
+            matchers->_ownPatternFiltered.push_back(patternAtoms.empty() ? 0 : 1);
+
+            for (const auto& atom : patternAtoms)
+            {
+                auto [it, inserted] = atomIds.try_emplace(atom, static_cast<uint32_t>(atoms.size()));
+                if (inserted)
+                {
+                    atoms.push_back(atom);
+                    patternsOfAtom.emplace_back();
+                }
+
+                patternsOfAtom[it->second].push_back(number);
+            }
+
+            ++number;
+        }
+    }
+
+    matchers->_ownAtomPatternBegin.push_back(0);
+
+    for (const auto& list : patternsOfAtom)
+    {
+        matchers->_ownAtomPatterns.insert(matchers->_ownAtomPatterns.end(), list.begin(), list.end());
+        matchers->_ownAtomPatternBegin.push_back(static_cast<uint32_t>(matchers->_ownAtomPatterns.size()));
+    }
+
+    if (!atoms.empty())
+        matchers->_atoms = KeywordAutomaton::build(atoms);
+
+    matchers->_keywordCategories = matchers->_ownKeywordCategories;
+    matchers->_atomPatternBegin = matchers->_ownAtomPatternBegin;
+    matchers->_atomPatterns = matchers->_ownAtomPatterns;
+    matchers->_patternFiltered = matchers->_ownPatternFiltered;
+    return matchers;
+}
+
+std::shared_ptr<const CompiledMatchers> CompiledMatchers::defaults()
+{
+    static const std::shared_ptr<const CompiledMatchers> builtIn = []
+    {
+        std::shared_ptr<CompiledMatchers> matchers(new CompiledMatchers());
+        matchers->_fingerprint = defaultFingerprint();
+        matchers->_builtIn = true;
+        matchers->_keywords = KeywordAutomaton::view(DefaultPatterns::KEYWORD_TABLES.tables());
+        matchers->_keywordCategories = DefaultPatterns::KEYWORD_CATEGORIES;
+        matchers->_atoms = KeywordAutomaton::view(DefaultPatterns::LITERAL_TABLES.tables());
+        matchers->_atomPatternBegin = DefaultPatterns::LITERAL_PATTERN_BEGIN;
+        matchers->_atomPatterns = DefaultPatterns::LITERAL_PATTERNS;
+        matchers->_patternFiltered = DefaultPatterns::PATTERN_FILTERED;
+        return matchers;
+    }();
+
+    return builtIn;
+}
+
+uint64_t CompiledMatchers::defaultFingerprint()
+{
+    static const uint64_t builtIn = fingerprint(DefaultPatterns::patternMap(), DefaultPatterns::keywordMap());
+    return builtIn;
+}
+
+void CompiledMatchers::save(const std::filesystem::path& filePath) const
+{
+    auto temporary = filePath;
+    temporary += "." + std::to_string(::getpid()) + ".tmp";
+
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+        if (!out)
+            throw std::runtime_error("Could not open output file: " + temporary.string());
+
+        PIIMatcherCache::Header header {};
+        std::memcpy(header.magic, PIIMatcherCache::MAGIC, sizeof(header.magic));
+        header.version = PIIMatcherCache::VERSION;
+        header.fingerprint = _fingerprint;
+
+        SectionWriter writer(out);
+        writer.write(&header, sizeof(header));
+
+        auto section = [&](PIIMatcherCache::Section id, auto column)
+        {
+            header.sections[id].offset = writer.position();
+            writer.write(column);
+            header.sections[id].size = writer.position() - header.sections[id].offset;
+            writer.pad();
+        };
+
+        section(PIIMatcherCache::KeywordStates, _keywords.tables().states);
+        section(PIIMatcherCache::KeywordEdges, _keywords.tables().edges);
+        section(PIIMatcherCache::KeywordOutputs, _keywords.tables().outputs);
+        section(PIIMatcherCache::KeywordLengths, _keywords.tables().lengths);
+        section(PIIMatcherCache::KeywordCategories, _keywordCategories);
+        section(PIIMatcherCache::AtomStates, _atoms.tables().states);
+        section(PIIMatcherCache::AtomEdges, _atoms.tables().edges);
+        section(PIIMatcherCache::AtomOutputs, _atoms.tables().outputs);
+        section(PIIMatcherCache::AtomLengths, _atoms.tables().lengths);
+        section(PIIMatcherCache::AtomPatternBegin, _atomPatternBegin);
+        section(PIIMatcherCache::AtomPatterns, _atomPatterns);
+        section(PIIMatcherCache::PatternFiltered, _patternFiltered);
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (!out.flush())
+        {
+            std::filesystem::remove(temporary);
+            throw std::runtime_error("Failed to write output file: " + temporary.string());
+        }
+    }
+
+    std::filesystem::rename(temporary, filePath);
+}
+
+std::shared_ptr<const CompiledMatchers> CompiledMatchers::load(const std::filesystem::path& filePath, uint64_t fingerprint)
+{
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open file: " + filePath.string());
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(PIIMatcherCache::Header))
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a matcher cache file: " + filePath.string());
+    }
+
+    const auto size = static_cast<size_t>(fileStat.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("Cannot map file: " + filePath.string());
+
+    // Owns the mapping from here on, also when validation throws
+    std::shared_ptr<CompiledMatchers> matchers(new CompiledMatchers());
+    matchers->_mapping = static_cast<const char*>(mapping);
+    matchers->_mappingSize = size;
+
+    const auto* header = reinterpret_cast<const PIIMatcherCache::Header*>(matchers->_mapping);
+
+    if (std::memcmp(header->magic, PIIMatcherCache::MAGIC, sizeof(PIIMatcherCache::MAGIC)) != 0)
+        throw std::runtime_error("Not a matcher cache file: " + filePath.string());
+
+    if (header->version != PIIMatcherCache::VERSION)
+        throw std::runtime_error("Unsupported matcher cache version " + std::to_string(header->version));
+
+    if (header->fingerprint != fingerprint)
+        throw std::runtime_error("Matcher cache is for another pattern set: " + filePath.string());
+
+    matchers->_fingerprint = header->fingerprint;
+
+    matchers->_keywords = KeywordAutomaton::view({
+        matchers->column<KeywordAutomaton::State>(PIIMatcherCache::KeywordStates),
+        matchers->column<KeywordAutomaton::Edge>(PIIMatcherCache::KeywordEdges),
+        matchers->column<uint32_t>(PIIMatcherCache::KeywordOutputs),
+        matchers->column<uint32_t>(PIIMatcherCache::KeywordLengths) });
+
+    matchers->_atoms = KeywordAutomaton::view({
+        matchers->column<KeywordAutomaton::State>(PIIMatcherCache::AtomStates),
+        matchers->column<KeywordAutomaton::Edge>(PIIMatcherCache::AtomEdges),
+        matchers->column<uint32_t>(PIIMatcherCache::AtomOutputs),
+        matchers->column<uint32_t>(PIIMatcherCache::AtomLengths) });
+
+    matchers->_keywordCategories = matchers->column<uint32_t>(PIIMatcherCache::KeywordCategories);
+    matchers->_atomPatternBegin = matchers->column<uint32_t>(PIIMatcherCache::AtomPatternBegin);
+    matchers->_atomPatterns = matchers->column<uint32_t>(PIIMatcherCache::AtomPatterns);
+    matchers->_patternFiltered = matchers->column<uint8_t>(PIIMatcherCache::PatternFiltered);
+
+    const auto& begin = matchers->_atomPatternBegin;
+
+    if (matchers->_keywordCategories.size() != matchers->_keywords.keywordCount() ||
+        begin.size() != matchers->_atoms.keywordCount() + 1 || begin.front() != 0 ||
+        begin.back() != matchers->_atomPatterns.size() || !std::is_sorted(begin.begin(), begin.end()))
+        throw std::runtime_error("Corrupted matcher cache: inconsistent sections in " + filePath.string());
+
+    for (const auto pattern : matchers->_atomPatterns)
+        if (pattern >= matchers->_patternFiltered.size())
+            throw std::runtime_error("Corrupted matcher cache: pattern out of range in " + filePath.string());
+
+    return matchers;
+}
+
+std::string_view CompiledMatchers::bytes(PIIMatcherCache::Section section) const
+{
+    const auto& ref = reinterpret_cast<const PIIMatcherCache::Header*>(_mapping)->sections[section];
+
+    if (ref.offset < sizeof(PIIMatcherCache::Header) || ref.offset > _mappingSize ||
+        ref.size > _mappingSize - ref.offset || ref.offset % 8 != 0)
+        throw std::runtime_error("Corrupted matcher cache: section " + std::to_string(section) + " out of range");
+
+    return { _mapping + ref.offset, static_cast<size_t>(ref.size) };
+}
+
+template<typename T>
+std::span<const T> CompiledMatchers::column(PIIMatcherCache::Section section) const
+{
+    const auto data = bytes(section);
+
+    if (data.size() % sizeof(T) != 0)
+        throw std::runtime_error("Corrupted matcher cache: section " + std::to_string(section) + " has wrong size");
+
+    return { reinterpret_cast<const T*>(data.data()), data.size() / sizeof(T) };
+}
+
+std::filesystem::path MatcherCache::defaultDirectory()
+{
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome)
+        return std::filesystem::path(cacheHome) / "piiscanner";
+
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::filesystem::path(home) / ".cache" / "piiscanner";
+
+    return {};
+}
+
+std::filesystem::path MatcherCache::fileFor(uint64_t fingerprint) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "matchers-%016llx.piim", static_cast<unsigned long long>(fingerprint));
+    return _directory / name;
+}
+
+std::shared_ptr<const CompiledMatchers> MatcherCache::get(const CompiledMatchers::PatternMap& patterns,
+                                                          const CompiledMatchers::PatternMap& keywords) const
+{
+    const auto fingerprint = CompiledMatchers::fingerprint(patterns, keywords);
+
+    if (fingerprint == CompiledMatchers::defaultFingerprint())
+        return CompiledMatchers::defaults();
+
+    if (isEnabled())
+    {
+        const auto filePath = fileFor(fingerprint);
+        std::error_code error;
+
+        if (std::filesystem::is_regular_file(filePath, error))
+        {
+            try
+            {
+                return CompiledMatchers::load(filePath, fingerprint);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Warning: rebuilding matcher cache: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    auto matchers = CompiledMatchers::build(patterns, keywords);
+
+    if (isEnabled())
+    {
+        try
+        {
+            std::filesystem::create_directories(_directory);
+            matchers->save(fileFor(fingerprint));
+        }
+        catch (const std::exception&)
+        {
+            // Read-only or full cache directory: the next start rebuilds as well
+        }
+    }
+
+    return matchers;
+}
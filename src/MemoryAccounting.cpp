@@ -0,0 +1,123 @@
+#include "MemoryAccounting.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace
+{
+    constinit thread_local MemoryAccounting::ThreadCounters counters;
+
+    // Usable size on both sides keeps liveBytes balanced without sized delete
+    inline void recordAllocation(void* pointer) noexcept
+    {
+        const auto size = static_cast<int64_t>(malloc_usable_size(pointer));
+
+        counters.allocatedBytes += static_cast<uint64_t>(size);
+        ++counters.allocations;
+        counters.liveBytes += size;
+
+        if (counters.liveBytes > counters.peakLiveBytes)
+            counters.peakLiveBytes = counters.liveBytes;
+    }
+
+    inline bool exceedsBudget(size_t size) noexcept
+    {
+        return counters.limitLiveBytes != 0 &&
+               counters.liveBytes + static_cast<int64_t>(size) > counters.limitLiveBytes;
+    }
+
+    void* allocate(size_t size)
+    {
+        if (exceedsBudget(size))
+            throw MemoryBudgetExceeded();
+
+        void* pointer = std::malloc(size == 0 ? 1 : size);
+        if (!pointer)
+            throw std::bad_alloc();
+
+        recordAllocation(pointer);
+        return pointer;
+    }
+
+    void* allocate(size_t size, std::align_val_t alignment)
+    {
+        if (exceedsBudget(size))
+            throw MemoryBudgetExceeded();
+
+        const auto align = static_cast<size_t>(alignment);
+        void* pointer = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+        if (!pointer)
+            throw std::bad_alloc();
+
+        recordAllocation(pointer);
+        return pointer;
+    }
+
+    void* allocateNoThrow(size_t size) noexcept
+    {
+        try { return allocate(size); } catch (...) { return nullptr; }
+    }
+
+    void* allocateNoThrow(size_t size, std::align_val_t alignment) noexcept
+    {
+        try { return allocate(size, alignment); } catch (...) { return nullptr; }
+    }
+
+    void release(void* pointer) noexcept
+    {
+        if (!pointer)
+            return;
+
+        counters.liveBytes -= static_cast<int64_t>(malloc_usable_size(pointer));
+        std::free(pointer);
+    }
+}
+
+MemoryAccounting::ThreadCounters& MemoryAccounting::threadCounters() noexcept
+{
+    return counters;
+}
+
+uint64_t MemoryAccounting::currentRssBytes()
+{
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    const bool parsed = std::fscanf(statm, "%llu %llu", &size, &resident) == 2;
+    std::fclose(statm);
+
+    return parsed ? resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE)) : 0;
+}
+
+uint64_t MemoryAccounting::peakRssBytes()
+{
+    struct rusage usage {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignment); }
+
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
@@ -0,0 +1,427 @@
+#include "OutputWriters.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef PIIS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef PIIS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+OutputCompression parseCompression(const std::string& name)
+{
+    if (name.empty() || name == "none")
+        return OutputCompression::None;
+    if (name == "gzip" || name == "gz")
+        return OutputCompression::Gzip;
+    if (name == "zstd" || name == "zst")
+        return OutputCompression::Zstd;
+
+    throw std::invalid_argument("Unsupported compression: " + name);
+}
+
+FileSink::FileSink(const std::filesystem::path& filePath): _filePath(filePath)
+{
+    _file = std::fopen(filePath.string().c_str(), "wb");
+
+    if (!_file)
+        throw std::runtime_error("Could not open output file: " + filePath.string());
+}
+
+FileSink::~FileSink()
+{
+    if (_file)
+        std::fclose(_file);
+}
+
+void FileSink::write(const char* data, size_t size)
+{
+    if (std::fwrite(data, 1, size, _file) != size)
+        throw std::runtime_error("Failed to write output file: " + _filePath.string());
+}
+
+void FileSink::flush()
+{
+    std::fflush(_file);
+}
+
+void FileSink::close()
+{
+    if (!_file)
+        return;
+
+    const auto rc = std::fclose(_file);
+    _file = nullptr;
+
+    if (rc != 0)
+        throw std::runtime_error("Failed to close output file: " + _filePath.string());
+}
+
+void StreamSink::write(const char* data, size_t size)
+{
+    if (std::fwrite(data, 1, size, _stream) != size)
+        throw std::runtime_error("Failed to write output stream");
+}
+
+#ifdef PIIS_HAVE_ZLIB
+class GzipSink: public IOutputSink
+{
+public:
+    explicit GzipSink(const std::filesystem::path& filePath): _filePath(filePath)
+    {
+        _file = gzopen(filePath.string().c_str(), "wb6");
+
+        if (!_file)
+            throw std::runtime_error("Could not open output file: " + filePath.string());
+    }
+
+    ~GzipSink() override
+    {
+        if (_file)
+            gzclose(_file);
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        while (size > 0)
+        {
+            const auto chunk = static_cast<unsigned>(std::min<size_t>(size, 1U << 30));
+
+            if (gzwrite(_file, data, chunk) != static_cast<int>(chunk))
+                throw std::runtime_error("Failed to write gzip output: " + _filePath.string());
+
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    // A full gzflush degrades the ratio, the batch is already handed to zlib
+    void flush() override {}
+
+    void close() override
+    {
+        if (!_file)
+            return;
+
+        const auto rc = gzclose(_file);
+        _file = nullptr;
+
+        if (rc != Z_OK)
+            throw std::runtime_error("Failed to finish gzip output: " + _filePath.string());
+    }
+
+private:
+    std::filesystem::path _filePath;
+    gzFile _file = nullptr;
+};
+#endif
+
+#ifdef PIIS_HAVE_ZSTD
+class ZstdSink: public IOutputSink
+{
+public:
+    explicit ZstdSink(const std::filesystem::path& filePath)
+        : _file(std::make_unique<FileSink>(filePath)), _stream(ZSTD_createCCtx())
+    {
+        if (!_stream)
+            throw std::runtime_error("Failed to create zstd context");
+
+        ZSTD_CCtx_setParameter(_stream, ZSTD_c_compressionLevel, 3);
+        _out.resize(ZSTD_CStreamOutSize());
+    }
+
+    ~ZstdSink() override
+    {
+        ZSTD_freeCCtx(_stream);
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        ZSTD_inBuffer input = { data, size, 0 };
+
+        while (input.pos < input.size)
+            compress(input, ZSTD_e_continue);
+    }
+
+    void flush() override
+    {
+        _file->flush();
+    }
+
+    void close() override
+    {
+        if (!_file)
+            return;
+
+        ZSTD_inBuffer input = { nullptr, 0, 0 };
+        while (compress(input, ZSTD_e_end) != 0) {}
+
+        _file->close();
+        _file.reset();
+    }
+
+private:
+    size_t compress(ZSTD_inBuffer& input, ZSTD_EndDirective mode)
+    {
+        ZSTD_outBuffer output = { _out.data(), _out.size(), 0 };
+        const auto remaining = ZSTD_compressStream2(_stream, &output, &input, mode);
+
+        if (ZSTD_isError(remaining))
+            throw std::runtime_error("zstd compression error: " + std::string(ZSTD_getErrorName(remaining)));
+
+        if (output.pos > 0)
+            _file->write(_out.data(), output.pos);
+
+        return remaining;
+    }
+
+    std::unique_ptr<FileSink> _file;
+    ZSTD_CCtx* _stream;
+    std::vector<char> _out;
+};
+#endif
+
+std::unique_ptr<IOutputSink> createOutputSink(const std::filesystem::path& filePath, OutputCompression compression)
+{
+    switch (compression)
+    {
+        case OutputCompression::None:
+            return std::make_unique<FileSink>(filePath);
+
+        case OutputCompression::Gzip:
+#ifdef PIIS_HAVE_ZLIB
+            return std::make_unique<GzipSink>(filePath);
+#else
+            throw std::runtime_error("gzip output requested but PIIScanner was built without zlib");
+#endif
+
+        case OutputCompression::Zstd:
+#ifdef PIIS_HAVE_ZSTD
+            return std::make_unique<ZstdSink>(filePath);
+#else
+            throw std::runtime_error("zstd output requested but PIIScanner was built without libzstd");
+#endif
+    }
+
+    throw std::invalid_argument("Unknown compression type");
+}
+
+AsyncWriter::AsyncWriter(std::unique_ptr<IOutputSink> sink, size_t capacity)
+    : _writer(std::move(sink), capacity), _thread(&AsyncWriter::run, this) {}
+
+AsyncWriter::~AsyncWriter()
+{
+    try { close(); } catch (...) {}
+}
+
+void AsyncWriter::submit(std::string&& text)
+{
+    if (text.empty())
+        return;
+
+    std::unique_lock lock(_mutex);
+    _hasSpace.wait(lock, [this] { return _pendingBytes < MAX_PENDING_BYTES || _stopping; });
+
+    if (_stopping)
+        return;
+
+    _pendingBytes += text.size();
+    _pending.push_back(std::move(text));
+    lock.unlock();
+
+    _hasWork.notify_one();
+}
+
+void AsyncWriter::close()
+{
+    {
+        std::lock_guard lock(_mutex);
+        if (_stopping)
+            return;
+        _stopping = true;
+    }
+
+    _hasWork.notify_one();
+    _hasSpace.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _writer.close();
+}
+
+void AsyncWriter::run()
+{
+    std::vector<std::string> batch;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(_mutex);
+            _hasWork.wait(lock, [this] { return !_pending.empty() || _stopping; });
+
+            if (_pending.empty())
+                return;
+
+            batch.swap(_pending);
+            _pendingBytes = 0;
+        }
+
+        _hasSpace.notify_all();
+
+        try
+        {
+            for (auto& text: batch)
+                _writer.append(text);
+
+            bool idle = false;
+            {
+                std::lock_guard lock(_mutex);
+                idle = _pending.empty();
+            }
+
+            if (idle)
+                _writer.flush();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Output writer error: " << e.what() << std::endl;
+        }
+
+        batch.clear();
+    }
+}
+
+namespace
+{
+    // Length of the valid UTF-8 sequence starting at data[0], or 0 if invalid
+    size_t utf8SequenceLength(const unsigned char* data, size_t available)
+    {
+        const unsigned char lead = data[0];
+        size_t length = 0;
+
+        if (lead >= 0xC2 && lead <= 0xDF)
+            length = 2;
+        else if (lead >= 0xE0 && lead <= 0xEF)
+            length = 3;
+        else if (lead >= 0xF0 && lead <= 0xF4)
+            length = 4;
+        else
+            return 0;
+
+        if (length > available)
+            return 0;
+
+        for (size_t i = 1; i < length; ++i)
+            if ((data[i] & 0xC0) != 0x80)
+                return 0;
+
+        // Overlong forms, UTF-16 surrogates and code points past U+10FFFF narrow the second byte
+        const unsigned char second = data[1];
+        if ((lead == 0xE0 && second < 0xA0) || (lead == 0xED && second > 0x9F) ||
+            (lead == 0xF0 && second < 0x90) || (lead == 0xF4 && second > 0x8F))
+            return 0;
+
+        return length;
+    }
+}
+
+void JsonText::appendString(std::string& out, std::string_view value)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    out += '"';
+
+    const auto* data = reinterpret_cast<const unsigned char*>(value.data());
+    const size_t size = value.size();
+    size_t runStart = 0;
+    size_t pos = 0;
+
+    auto flushRun = [&]()
+    {
+        if (pos > runStart)
+            out.append(value.data() + runStart, pos - runStart);
+    };
+
+    while (pos < size)
+    {
+        const unsigned char c = data[pos];
+
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+        {
+            ++pos;
+            continue;
+        }
+
+        if (c >= 0x80)
+        {
+            if (const auto length = utf8SequenceLength(data + pos, size - pos); length > 0)
+            {
+                pos += length;
+                continue;
+            }
+
+            flushRun();
+            out += "\\ufffd";
+            runStart = ++pos;
+            continue;
+        }
+
+        flushRun();
+
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hexDigits[c >> 4];
+                out += hexDigits[c & 0x0F];
+        }
+
+        runStart = ++pos;
+    }
+
+    flushRun();
+    out += '"';
+}
+
+void JsonText::appendNumber(std::string& out, double value)
+{
+    if (!std::isfinite(value))
+    {
+        out += "null";
+        return;
+    }
+
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+    if (ec != std::errc())
+        throw std::runtime_error("Failed to format number");
+
+    out.append(buffer, end);
+}
+
+void JsonText::appendNumber(std::string& out, long long value)
+{
+    char buffer[24];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+    if (ec != std::errc())
+        throw std::runtime_error("Failed to format number");
+
+    out.append(buffer, end);
+}
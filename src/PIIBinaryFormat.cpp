@@ -0,0 +1,293 @@
+#include "PIIBinaryFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(PIIBinary::Header) % 8 == 0, "Header must keep sections 8-byte aligned");
+
+PIIBinary::StringTable::StringTable(const char* base, uint64_t size)
+{
+    if (size < sizeof(uint64_t))
+        throw std::runtime_error("Corrupted string table");
+
+    uint64_t count = 0;
+    std::memcpy(&count, base, sizeof(count));
+
+    // count + 1 offsets must follow the count; written so that neither side can wrap
+    if (count >= (size - sizeof(uint64_t)) / sizeof(uint64_t))
+        throw std::runtime_error("Corrupted string table: bad entry count");
+
+    _count = static_cast<size_t>(count);
+    _offsets = reinterpret_cast<const uint64_t*>(base + sizeof(uint64_t));
+    _data = base + sizeof(uint64_t) * (count + 2);
+
+    const uint64_t dataSize = size - sizeof(uint64_t) * (count + 2);
+
+    if (_offsets[0] != 0 || _offsets[count] > dataSize)
+        throw std::runtime_error("Corrupted string table: bad offsets");
+
+    for (size_t i = 0; i < _count; ++i)
+        if (_offsets[i] > _offsets[i + 1])
+            throw std::runtime_error("Corrupted string table: bad offsets");
+}
+
+uint32_t PIIBinaryWriter::Dictionary::intern(std::string_view value)
+{
+    if (auto it = _index.find(value); it != _index.end())
+        return it->second;
+
+    if (_strings.size() >= std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Too many distinct strings for binary result format");
+
+    const auto id = static_cast<uint32_t>(_strings.size());
+    _index.emplace(_strings.emplace_back(value), id);
+    return id;
+}
+
+void PIIBinaryWriter::addFile(const std::filesystem::path& filePath, double duration, int64_t timestamp)
+{
+    if (_fileMatchBegin.empty())
+        _fileMatchBegin.push_back(0);
+
+    const auto u8Path = filePath.u8string();
+    const auto u8Dir = filePath.parent_path().u8string();
+
+    _filePath.push_back(_paths.intern({ reinterpret_cast<const char*>(u8Path.data()), u8Path.size() }));
+    _fileDirectory.push_back(_directories.intern({ reinterpret_cast<const char*>(u8Dir.data()), u8Dir.size() }));
+    _fileDuration.push_back(duration);
+    _fileTimestamp.push_back(timestamp);
+    _fileMatchBegin.push_back(_matchValue.size());
+}
+
+void PIIBinaryWriter::addMatch(std::string_view category, uint32_t valueId)
+{
+    if (_filePath.empty())
+        throw std::logic_error("addMatch called before addFile");
+
+    _matchCategory.push_back(_categories.intern(category));
+    _matchValue.push_back(valueId);
+    _fileMatchBegin.back() = _matchValue.size();
+}
+
+namespace
+{
+    class SectionWriter
+    {
+    public:
+        explicit SectionWriter(std::ofstream& out): _out(out) {}
+
+        uint64_t position() const noexcept { return _position; }
+
+        void write(const void* data, size_t size)
+        {
+            _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            _position += size;
+        }
+
+        void pad()
+        {
+            static constexpr char zeros[8] = {};
+            if (const auto rest = _position % 8; rest != 0)
+                write(zeros, 8 - rest);
+        }
+
+    private:
+        std::ofstream& _out;
+        uint64_t _position = 0;
+    };
+
+    template<typename Lookup>
+    void writeStringTable(SectionWriter& writer, size_t count, const Lookup& lookup)
+    {
+        const uint64_t tableSize = count;
+        writer.write(&tableSize, sizeof(tableSize));
+
+        uint64_t offset = 0;
+        writer.write(&offset, sizeof(offset));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            offset += lookup(i).size();
+            writer.write(&offset, sizeof(offset));
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const std::string_view value = lookup(i);
+            writer.write(value.data(), value.size());
+        }
+    }
+
+    void writeStringTable(SectionWriter& writer, const std::deque<std::string>& strings)
+    {
+        writeStringTable(writer, strings.size(), [&strings](size_t i) -> const std::string& { return strings[i]; });
+    }
+
+    template<typename T>
+    void writeColumn(SectionWriter& writer, const std::vector<T>& column)
+    {
+        writer.write(column.data(), column.size() * sizeof(T));
+    }
+}
+
+void PIIBinaryWriter::write(const std::filesystem::path& outputFile, size_t valueCount, const ValueLookup& value,
+    std::string_view statisticsJson) const
+{
+    std::ofstream out(outputFile, std::ios::binary | std::ios::trunc);
+
+    if (!out)
+        throw std::runtime_error("Could not open output file: " + outputFile.string());
+
+    PIIBinary::Header header {};
+    std::memcpy(header.magic, PIIBinary::MAGIC, sizeof(header.magic));
+    header.version = PIIBinary::VERSION;
+    header.fileCount = _filePath.size();
+    header.matchCount = _matchValue.size();
+
+    const std::vector<uint64_t> emptyBegin = { 0 };
+    const auto& matchBegin = _fileMatchBegin.empty() ? emptyBegin : _fileMatchBegin;
+
+    SectionWriter writer(out);
+    writer.write(&header, sizeof(header));
+
+    auto section = [&](PIIBinary::Section id, auto&& emit)
+    {
+        header.sections[id].offset = writer.position();
+        emit();
+        header.sections[id].size = writer.position() - header.sections[id].offset;
+        writer.pad();
+    };
+
+    section(PIIBinary::PathStrings, [&] { writeStringTable(writer, _paths.strings()); });
+    section(PIIBinary::DirectoryStrings, [&] { writeStringTable(writer, _directories.strings()); });
+    section(PIIBinary::CategoryStrings, [&] { writeStringTable(writer, _categories.strings()); });
+    section(PIIBinary::ValueStrings, [&] { writeStringTable(writer, valueCount,
+        [&value](size_t i) { return value(static_cast<uint32_t>(i)); }); });
+    section(PIIBinary::FilePath, [&] { writeColumn(writer, _filePath); });
+    section(PIIBinary::FileDirectory, [&] { writeColumn(writer, _fileDirectory); });
+    section(PIIBinary::FileDuration, [&] { writeColumn(writer, _fileDuration); });
+    section(PIIBinary::FileTimestamp, [&] { writeColumn(writer, _fileTimestamp); });
+    section(PIIBinary::FileMatchBegin, [&] { writeColumn(writer, matchBegin); });
+    section(PIIBinary::MatchCategory, [&] { writeColumn(writer, _matchCategory); });
+    section(PIIBinary::MatchValue, [&] { writeColumn(writer, _matchValue); });
+    section(PIIBinary::StatisticsJson, [&] { writer.write(statisticsJson.data(), statisticsJson.size()); });
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!out)
+        throw std::runtime_error("Failed to write output file: " + outputFile.string());
+}
+
+PIIBinaryResult::PIIBinaryResult(const std::filesystem::path& filePath)
+{
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open file: " + filePath.string());
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(PIIBinary::Header))
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a PIIB results file: " + filePath.string());
+    }
+
+    _size = static_cast<size_t>(fileStat.st_size);
+    void* mapping = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("Cannot map file: " + filePath.string());
+
+    _data = static_cast<const char*>(mapping);
+    _header = reinterpret_cast<const PIIBinary::Header*>(_data);
+
+    try
+    {
+        if (std::memcmp(_header->magic, PIIBinary::MAGIC, sizeof(PIIBinary::MAGIC)) != 0)
+            throw std::runtime_error("Not a PIIB results file: " + filePath.string());
+
+        if (_header->version != PIIBinary::VERSION)
+            throw std::runtime_error("Unsupported PIIB version " + std::to_string(_header->version));
+
+        auto table = [this](PIIBinary::Section section)
+        {
+            const auto data = bytes(section);
+            return PIIBinary::StringTable(data.data(), data.size());
+        };
+
+        _paths = table(PIIBinary::PathStrings);
+        _directories = table(PIIBinary::DirectoryStrings);
+        _categories = table(PIIBinary::CategoryStrings);
+        _values = table(PIIBinary::ValueStrings);
+
+        _filePath = column<uint32_t>(PIIBinary::FilePath, fileCount());
+        _fileDirectory = column<uint32_t>(PIIBinary::FileDirectory, fileCount());
+        _fileDuration = column<double>(PIIBinary::FileDuration, fileCount());
+        _fileTimestamp = column<int64_t>(PIIBinary::FileTimestamp, fileCount());
+        _fileMatchBegin = column<uint64_t>(PIIBinary::FileMatchBegin, fileCount() + 1);
+        _matchCategory = column<uint32_t>(PIIBinary::MatchCategory, matchCount());
+        _matchValue = column<uint32_t>(PIIBinary::MatchValue, matchCount());
+        _statistics = bytes(PIIBinary::StatisticsJson);
+
+        validateIds(_filePath, _paths, PIIBinary::FilePath);
+        validateIds(_fileDirectory, _directories, PIIBinary::FileDirectory);
+        validateIds(_matchCategory, _categories, PIIBinary::MatchCategory);
+        validateIds(_matchValue, _values, PIIBinary::MatchValue);
+
+        // Readers index the match columns with these without further checks
+        if (_fileMatchBegin.front() != 0 || _fileMatchBegin.back() != matchCount()
+            || !std::is_sorted(_fileMatchBegin.begin(), _fileMatchBegin.end()))
+            throw std::runtime_error("Corrupted PIIB file: section " + std::to_string(PIIBinary::FileMatchBegin)
+                                     + " has bad match ranges");
+    }
+    catch (...)
+    {
+        ::munmap(const_cast<char*>(_data), _size);
+        throw;
+    }
+}
+
+PIIBinaryResult::~PIIBinaryResult()
+{
+    if (_data)
+        ::munmap(const_cast<char*>(_data), _size);
+}
+
+std::string_view PIIBinaryResult::bytes(PIIBinary::Section section) const
+{
+    const auto& ref = _header->sections[section];
+
+    if (ref.offset > _size || ref.size > _size - ref.offset || ref.offset % 8 != 0)
+        throw std::runtime_error("Corrupted PIIB file: section " + std::to_string(section) + " out of range");
+
+    return { _data + ref.offset, static_cast<size_t>(ref.size) };
+}
+
+template<typename T>
+std::span<const T> PIIBinaryResult::column(PIIBinary::Section section, size_t expectedCount) const
+{
+    const auto data = bytes(section);
+
+    if (expectedCount > _size / sizeof(T) || data.size() != expectedCount * sizeof(T))
+        throw std::runtime_error("Corrupted PIIB file: section " + std::to_string(section) + " has wrong size");
+
+    return { reinterpret_cast<const T*>(data.data()), expectedCount };
+}
+
+void PIIBinaryResult::validateIds(std::span<const uint32_t> ids, const PIIBinary::StringTable& table,
+                                  PIIBinary::Section section)
+{
+    for (const auto id : ids)
+        if (id >= table.size())
+            throw std::runtime_error("Corrupted PIIB file: section " + std::to_string(section) + " has id "
+                                     + std::to_string(id) + " past its string table");
+}
@@ -1,33 +1,289 @@
 #include <PIIRecognizer.h>
+#include <array>
+#include <chrono>
 
-std::map<std::string, std::vector<std::string>> RegexStrategy::scan(const std::string& text)
+static uint64_t nanosSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Strings of the matched ranges by category name, in span order
+static std::map<std::string, std::vector<std::string>> spanValues(const std::string& text, const std::vector<MatchSpan>& spans,
+                                                                  const std::vector<std::string>& categories)
 {
     std::map<std::string, std::vector<std::string>> result;
 
+    for (const auto& span : spans)
+        result[categories[span.category]].emplace_back(text, span.begin, span.end - span.begin);
+
+    return result;
+}
+
+std::vector<std::string> RegexStrategy::categories() const
+{
+    return _categoryNames;
+}
+
+void RegexStrategy::enableProfiling(PatternProfiler& profiler)
+{
+    _profiler = &profiler;
+    _profileIds.clear();
+
+    if (_matchers->hasFilteredPatterns())
+        _prefilterProfileId = profiler.registerPattern(name(), "*",
+            "prefilter (" + std::to_string(_matchers->atoms().keywordCount()) + " literals)");
+
+    for (const auto& [type, regexList]: _cmpPatterns)
+        for (const auto& compiled: regexList)
+            _profileIds[type].push_back(compiled.re
+                ? profiler.registerPattern(name(), type, compiled.pattern, compiled.re->ProgramSize(), compiled.re->options().max_mem())
+                : profiler.registerPattern(name(), type, compiled.pattern));
+}
+
+std::vector<uint8_t> RegexStrategy::candidatePatterns(const std::string& text) const
+{
+    const auto filtered = _matchers->patternFiltered();
+    std::vector<uint8_t> candidates(filtered.size());
+    size_t pending = 0;
+
+    for (size_t pattern = 0; pattern < filtered.size(); ++pattern)
+    {
+        candidates[pattern] = !filtered[pattern];
+        pending += filtered[pattern];
+    }
+
+    if (pending == 0)
+        return candidates;
+
+    std::string lowerText;
+    lowerText.reserve(text.size());
+    std::transform(text.begin(), text.end(), std::back_inserter(lowerText),
+                   [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
+
+    const auto begin = _matchers->atomPatternBegin();
+    const auto patterns = _matchers->atomPatterns();
+
+    _matchers->atoms().scan(lowerText, [&](uint32_t atom, size_t)
+    {
+        for (uint32_t i = begin[atom]; i < begin[atom + 1]; ++i)
+        {
+            if (!candidates[patterns[i]])
+            {
+                candidates[patterns[i]] = 1;
+                --pending;
+            }
+        }
+
+        return pending != 0;
+    });
+
+    return candidates;
+}
+
+std::map<std::string, std::vector<std::string>> RegexStrategy::scan(const std::string& text, MatchQuota& quota)
+{
+    return spanValues(text, findSpans(text, quota), _categoryNames);
+}
+
+std::vector<MatchSpan> RegexStrategy::findSpans(const std::string& text, MatchQuota& quota)
+{
+    std::vector<MatchSpan> spans;
+
     if (text.empty())
-        return result;
+        return spans;
+
+    const auto prefilterStart = _profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+    const auto candidates = candidatePatterns(text);
+
+    if (_profiler && _matchers->hasFilteredPatterns())
+        _profiler->record(_prefilterProfileId, nanosSince(prefilterStart), text.size(), 0);
+
+    std::vector<std::string_view> batch;
+    std::vector<uint8_t> valid(IMatchValidator::BATCH_SIZE);
+
+    // Runs the patterns of one category until it has found limit matches; true when it stopped there
+    const auto scanCategory = [&](const std::string& type, const std::vector<CompiledPattern>& regexList,
+                                  uint32_t category, size_t firstPattern, size_t limit)
+    {
+        size_t found = 0;
+
+        for (size_t index = 0; index < regexList.size(); ++index)
+        {
+            if (found >= limit || quota.isCancelled())
+                break;
+
+            // None of the literals this pattern needs is in the text
+            if (!candidates[firstPattern + index])
+                continue;
+
+            const IMatchValidator* validator = _validators.find(type);
+            const auto& compiled = regexList[index];
+            const auto start = _profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+            size_t matches = 0;
+            bool stoppedEarly = false;
+
+            std::string_view input(text);
+            std::string_view matchData;
+
+            const auto findNext = [&]
+            {
+                if (compiled.matcher)
+                    return compiled.matcher(input, matchData);
+
+                // Same as RE2::FindAndConsume, which cannot return the match of a pattern without groups
+                const re2::StringPiece remaining(input.data(), input.size());
+                std::array<re2::StringPiece, 2> groups;
+                const int group = compiled.re->NumberOfCapturingGroups() > 0 ? 1 : 0;
+
+                if (!compiled.re->Match(remaining, 0, remaining.size(), RE2::UNANCHORED, groups.data(), group + 1))
+                    return false;
+
+                input.remove_prefix(static_cast<size_t>(groups[0].data() + groups[0].size() - remaining.data()));
+
+                // A group that took no part in the match reports an empty string where the match ended
+                matchData = groups[group].data() ? std::string_view(groups[group].data(), groups[group].size())
+                                                 : std::string_view(input.data(), 0);
+                return true;
+            };
+
+            const auto accept = [&](std::string_view match)
+            {
+                const auto begin = static_cast<size_t>(match.data() - text.data());
+                spans.push_back({ begin, begin + match.size(), category });
+                ++found;
+                ++matches;
+                stoppedEarly = found >= limit || quota.isCancelled();
+            };
+
+            // Validated matches wait in a batch; it never holds more than the limit can take
+            const auto validateBatch = [&]
+            {
+                validator->validate(batch, valid);
+
+                for (size_t i = 0; i < batch.size() && !stoppedEarly; ++i)
+                    if (valid[i])
+                        accept(batch[i]);
+
+                batch.clear();
+            };
+
+            while (!stoppedEarly && findNext())
+            {
+                if (!validator)
+                {
+                    accept(matchData);
+                    continue;
+                }
+
+                batch.push_back(matchData);
+
+                if (batch.size() >= std::min(IMatchValidator::BATCH_SIZE, limit - found))
+                    validateBatch();
+            }
+
+            if (!batch.empty())
+                validateBatch();
+
+            if (_profiler)
+            {
+                const size_t scanned = stoppedEarly ? static_cast<size_t>(input.data() - text.data()) : text.size();
+                _profiler->record(_profileIds.at(type)[index], nanosSince(start), scanned, matches);
+            }
+        }
+
+        return found >= limit;
+    };
+
+    // What each category may still report, and which stopped there
+    std::vector<size_t> limits;
+    std::vector<uint8_t> capped;
+    std::vector<size_t> firstPatterns;
+    size_t firstPattern = 0;
+    uint32_t category = 0;
 
     for (const auto& [type, regexList]: _cmpPatterns)
     {
-        for (const auto& re: regexList)
+        limits.push_back(quota.remaining(type));
+        firstPatterns.push_back(firstPattern);
+        capped.push_back(limits.back() > 0 && scanCategory(type, regexList, category, firstPattern, limits.back()));
+
+        firstPattern += regexList.size();
+        ++category;
+    }
+
+    if (_resolver.isEnabled())
+    {
+        _resolver.resolve(spans, _categoryRanks);
+
+        // Matches the resolver dropped must not fill a cap: a category that stopped at
+        // its limit and lost some of those matches is scanned again without one
+        std::vector<size_t> kept(limits.size());
+        for (const auto& span : spans)
+            ++kept[span.category];
+
+        bool rescanned = false;
+        category = 0;
+
+        for (const auto& [type, regexList]: _cmpPatterns)
         {
-            re2::StringPiece input(text);
-            std::string matchData;
+            if (capped[category] && kept[category] < limits[category] && !quota.isCancelled())
+            {
+                std::erase_if(spans, [category](const MatchSpan& span) { return span.category == category; });
+                scanCategory(type, regexList, category, firstPatterns[category], std::numeric_limits<size_t>::max());
+                rescanned = true;
+            }
 
-            while (RE2::FindAndConsume(&input, *re, &matchData))
-                result[type].push_back(matchData);
+            ++category;
         }
+
+        if (rescanned)
+            _resolver.resolve(spans, _categoryRanks);
+
+        // Past the limit only after a rescan; the first matches in the text are kept
+        std::fill(kept.begin(), kept.end(), 0);
+        std::erase_if(spans, [&](const MatchSpan& span) { return ++kept[span.category] > limits[span.category]; });
     }
 
-    return result;
+    // Only what is reported counts against the quota
+    std::vector<size_t> reported(limits.size());
+    for (const auto& span : spans)
+        ++reported[span.category];
+
+    for (size_t index = 0; index < reported.size(); ++index)
+        if (reported[index] != 0)
+            quota.consume(_categoryNames[index], reported[index]);
+
+    return spans;
 }
 
-std::map<std::string, std::vector<std::string>> KeywordStrategy::scan(const std::string& text) // TODO: opt
+std::vector<std::string> KeywordStrategy::categories() const
 {
-    std::map<std::string, std::vector<std::string>> result;
+    return _categoryNames;
+}
+
+void KeywordStrategy::enableProfiling(PatternProfiler& profiler)
+{
+    // One pass of the automaton finds every keyword, so it is timed as a whole
+    _profiler = &profiler;
+    _profileId = profiler.registerPattern(name(), "*",
+        "automaton (" + std::to_string(_matchers->keywords().keywordCount()) + " keywords)");
+}
+
+std::map<std::string, std::vector<std::string>> KeywordStrategy::scan(const std::string& text, MatchQuota& quota)
+{
+    return spanValues(text, findSpans(text, quota), _categoryNames);
+}
+
+std::vector<MatchSpan> KeywordStrategy::findSpans(const std::string& text, MatchQuota& quota)
+{
+    std::vector<MatchSpan> spans;
 
     if (text.empty())
-        return result;
+        return spans;
+
+    const auto start = _profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+    size_t matches = 0;
 
     std::string lowerText;
     lowerText.reserve(text.size());
@@ -53,35 +309,30 @@ std::map<std::string, std::vector<std::string>> KeywordStrategy::scan(const std:
             return true;
     };
 
-    for (const auto& [category, keywords]: _lowerKeywords)
-    {
-        for (const auto& keyword: keywords)
-        {
-            if (keyword.empty())
-                continue;
+    const auto& automaton = _matchers->keywords();
+    const auto categoryOf = _matchers->keywordCategories();
 
-            const size_t keywordSize = keyword.size();
-            size_t pos = 0;
+    automaton.scan(lowerText, [&](uint32_t keyword, size_t pos)
+    {
+        const auto& category = _categoryNames[categoryOf[keyword]];
 
-            while (pos + keywordSize <= lowerText.size())
-            {
-                bool match = true;
-                for (size_t i = 0; i < keywordSize; ++i)
-                {
-                    if (lowerText[pos + i] != keyword[i])
-                    {
-                        match = false;
-                        break;
-                    }
-                }
+        if (quota.isExhausted(category))
+            return !quota.isCancelled() && !quota.isSatisfied(_categoryNames);
 
-                if (match && isBoundary(pos, keywordSize))
-                    result[category].emplace_back(text.begin() + pos, text.begin() + pos + keywordSize);
+        const size_t keywordSize = automaton.keywordLength(keyword);
 
-                ++pos;
-            }
+        if (isBoundary(pos, keywordSize))
+        {
+            spans.push_back({ pos, pos + keywordSize, categoryOf[keyword] });
+            quota.consume(category);
+            ++matches;
         }
-    }
 
-    return result;
+        return true;
+    });
+
+    if (_profiler)
+        _profiler->record(_profileId, nanosSince(start), text.size(), matches);
+
+    return spans;
 }
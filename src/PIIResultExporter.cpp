@@ -4,60 +4,289 @@
 #include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <string>
+#include <utility>
+
+ConsoleExporter::Verbosity ConsoleExporter::parseVerbosity(const std::string& name)
+{
+    if (name == "full")
+        return Verbosity::Full;
+    if (name == "line")
+        return Verbosity::Line;
+    if (name == "summary")
+        return Verbosity::Summary;
+
+    throw std::invalid_argument("Unsupported console verbosity: " + name);
+}
+
+ConsoleExporter::ConsoleExporter(const MatchInterner& values, Verbosity verbosity)
+    : _values(values), _verbosity(verbosity), _writer(std::make_unique<StreamSink>(stdout)) {}
 
 void ConsoleExporter::processFileResults(const std::filesystem::path& filePath,
-    const std::map<std::string, std::vector<std::string>>& results, double duration)
+    const PIIMatches& results, double duration)
 {
-    std::cout << "\n================= Scan Report =================" << std::endl;
-    std::cout << " File     : " << filePath << std::endl;
-    std::cout << " Duration : " << std::fixed << std::setprecision(2) << duration << std::endl;
+    if (_verbosity == Verbosity::Summary)
+        return;
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+
+    if (_verbosity == Verbosity::Line)
+    {
+        out << filePath.string() << '\t' << duration << "s\t";
+
+        if (results.empty())
+            out << "no PII";
+
+        for (auto it = results.begin(); it != results.end(); ++it)
+            out << (it == results.begin() ? "" : ", ") << it->first << ": " << it->second.size();
+
+        out << '\n';
+        _writer.submit(std::move(out).str());
+        return;
+    }
+
+    out << "\n================= Scan Report =================\n";
+    out << " File     : " << filePath << '\n';
+    out << " Duration : " << duration << '\n';
 
     if (results.empty())
-        std::cout << " Status   : No PII found." << std::endl;
+        out << " Status   : No PII found.\n";
 
     else
     {
-        std::cout << " Status   : PII found!" << std::endl;
-        std::cout << " Matches  :" << std::endl;
+        out << " Status   : PII found!\n";
+        out << " Matches  :\n";
 
         for (const auto& [type, matches] : results)
         {
-            std::cout << "  - " << type << " (" << matches.size() << "):" << std::endl;
+            out << "  - " << type << " (" << matches.size() << "):\n";
 
-            for (const auto& match : matches)
-                std::cout << "       " << match << std::endl;
+            for (const auto match : matches)
+                out << "       " << _values.value(match) << '\n';
 
         }
     }
-    std::cout << "==============================================" << std::endl;
+    out << "==============================================\n";
+
+    _writer.submit(std::move(out).str());
 }
 
 
 void ConsoleExporter::finalize(const PIIGeneralStats::Stats& stats)
 {
-    std::cout << "\n============== FINAL SCAN SUMMARY ==============" << std::endl;
-    std::cout << " Total files scanned : " << stats.totalFiles << std::endl;
-    std::cout << " Total PII found     : " << stats.totalPII << std::endl;
-    std::cout << " Total duration      : " << std::fixed << std::setprecision(2) << stats.totalDuration << "s" << std::endl;
-    std::cout << " Avg duration/file   : " << std::fixed << std::setprecision(2) << stats.avgDuration << "s" << std::endl;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+
+    out << "\n============== FINAL SCAN SUMMARY ==============\n";
+    out << " Total files scanned : " << stats.totalFiles << '\n';
+
+    if (stats.shardCount > 1)
+        out << " Shard               : " << stats.shardIndex + 1 << '/' << stats.shardCount << '\n';
+
+    out << " Total PII found     : " << stats.totalPII << '\n';
+    out << " Total duration      : " << stats.totalDuration << "s\n";
+    out << " Avg duration/file   : " << stats.avgDuration << "s\n";
 
     if (!stats.piiCounts.empty())
     {
-        std::cout << "\n PII found by type:" << std::endl;
+        out << "\n PII found by type:\n";
 
         for (const auto& [type, count] : stats.piiCounts)
-            std::cout << "  - " << type << ": " << count << std::endl;
+            out << "  - " << type << ": " << count << '\n';
 
     }
-    else 
-        std::cout << " No PII types detected." << std::endl;
+    else
+        out << " No PII types detected.\n";
+
+    if (!stats.timedOutFiles.empty())
+    {
+        out << "\n Timed out, partial results (" << stats.timedOutFiles.size() << "):\n";
+
+        for (const auto& file : stats.timedOutFiles)
+            out << "  - " << file << '\n';
+    }
+
+    if (stats.totalFiles > 0)
+    {
+        out << "\n Time by stage:\n";
+
+        for (const auto& [stage, seconds] : stats.stageSeconds)
+            out << "  - " << std::left << std::setw(8) << stage << std::right << ": " << seconds << "s\n";
 
-    std::cout << "=================================================" << std::endl;
+        if (const auto& schedule = stats.schedule; !schedule.policy.empty())
+            out << "\n Parallel efficiency : " << schedule.efficiency * 100.0 << "% of " << schedule.threads
+                << " threads over " << schedule.wallSeconds << "s (best possible " << schedule.bestEfficiency * 100.0
+                << "%, longest file " << schedule.longestFileSeconds << "s, schedule " << schedule.policy << ")\n";
+
+        out << "\n Per file type (read MB/s, file latency p50/p95/p99/max ms):\n";
+
+        for (const auto& [type, summary] : stats.fileTypes)
+        {
+            const auto& latency = summary.fileLatency;
+            out << "  - " << std::left << std::setw(6) << type << std::right
+                << ": " << summary.files << " files, " << summary.megabytesPerSecond << " MB/s, "
+                << latency.p50 * 1e3 << " / " << latency.p95 * 1e3 << " / "
+                << latency.p99 * 1e3 << " / " << latency.max * 1e3 << '\n';
+        }
+
+        for (const auto& [strategy, latency] : stats.strategyLatency)
+            out << "  - strategy " << strategy << " detect p50/p95/p99/max ms: "
+                << latency.p50 * 1e3 << " / " << latency.p95 * 1e3 << " / "
+                << latency.p99 * 1e3 << " / " << latency.max * 1e3 << '\n';
+    }
+
+    if (!stats.topValues.empty() && stats.topValues.front().occurrences > 1)
+    {
+        out << "\n Top recurring values (" << stats.distinctValues << " distinct):\n";
+
+        for (const auto& top : stats.topValues)
+            if (top.occurrences > 1)
+                out << "  - " << top.value << ": " << top.occurrences << " in " << top.files << " file(s)\n";
+    }
+
+    if (stats.totalFiles > 0)
+    {
+        constexpr double MB = 1024.0 * 1024.0;
+        out << "\n Memory (peak RSS " << stats.peakRssBytes / MB << " MB), per file type avg read alloc / avg peak / max peak MB:\n";
+
+        for (const auto& [type, summary] : stats.fileTypes)
+            out << "  - " << std::left << std::setw(6) << type << std::right << ": "
+                << summary.avgReadAllocatedBytes / MB << " / " << summary.avgPeakBytes / MB << " / "
+                << summary.maxPeakBytes / MB << '\n';
+
+        if (stats.streamedFiles > 0)
+            out << " Files streamed in chunks to fit the memory budget: " << stats.streamedFiles << '\n';
+
+        if (!stats.memoryHungryFiles.empty())
+        {
+            out << "\n Most memory-hungry files (peak heap MB, RSS after MB):\n";
+
+            for (const auto& file : stats.memoryHungryFiles)
+                out << "  - " << file.filePath << ": " << file.peakBytes / MB << ", " << file.rssBytes / MB << '\n';
+        }
+    }
+
+    if (!stats.patternCosts.empty())
+    {
+        out << "\n Most expensive patterns (seconds, MB/s, matches, program size):\n";
+
+        for (const auto& cost : stats.patternCosts)
+        {
+            const double megabytes = cost.bytesScanned / (1024.0 * 1024.0);
+            out << "  - " << std::setprecision(4) << cost.seconds << std::setprecision(2) << "s  "
+                << (cost.seconds > 0.0 ? megabytes / cost.seconds : 0.0) << " MB/s  "
+                << cost.matches << "  " << cost.programSize << "  "
+                << cost.strategy << '/' << cost.category << ": " << cost.pattern << '\n';
+        }
+    }
+
+    out << "=================================================\n";
+
+    _writer.submit(std::move(out).str());
+    _writer.close();
 }
 
 
-JsonExporter::JsonExporter(const std::filesystem::path& outputFile): outputFile(outputFile)
+static nlohmann::json latencyToJson(const LatencyHistogram::Summary& latency)
+{
+    return
+    {
+        {"count", latency.count},
+        {"p50", latency.p50},
+        {"p95", latency.p95},
+        {"p99", latency.p99},
+        {"max", latency.max},
+        {"buckets", latency.buckets}
+    };
+}
+
+static nlohmann::json statsToJson(const PIIGeneralStats::Stats& stats)
+{
+    nlohmann::json statsJson;
+    statsJson["total_files"] = stats.totalFiles;
+    statsJson["total_pii"] = stats.totalPII;
+    statsJson["total_duration"] = stats.totalDuration;
+    statsJson["avg_duration"] = stats.avgDuration;
+
+    statsJson["pii_counts"] = stats.piiCounts;
+    statsJson["distinct_values"] = stats.distinctValues;
+    statsJson["timed_out_files"] = stats.timedOutFiles;
+
+    if (stats.shardCount > 1)
+        statsJson["shard"] = { {"index", stats.shardIndex + 1}, {"count", stats.shardCount} };
+
+    statsJson["top_values"] = nlohmann::json::array();
+    for (const auto& top : stats.topValues)
+        statsJson["top_values"].push_back({
+            {"value", top.value}, {"occurrences", top.occurrences}, {"files", top.files} });
+
+    for (const auto& [stage, seconds] : stats.stageSeconds)
+        statsJson["stages"][stage] = seconds;
+
+    if (const auto& schedule = stats.schedule; !schedule.policy.empty())
+    {
+        statsJson["schedule"] =
+        {
+            {"policy", schedule.policy},
+            {"threads", schedule.threads},
+            {"wall_seconds", schedule.wallSeconds},
+            {"busy_seconds", schedule.busySeconds},
+            {"longest_file_seconds", schedule.longestFileSeconds},
+            {"efficiency", schedule.efficiency},
+            {"best_efficiency", schedule.bestEfficiency}
+        };
+    }
+
+    for (const auto& [type, summary] : stats.fileTypes)
+    {
+        statsJson["file_types"][type] =
+        {
+            {"files", summary.files},
+            {"bytes", summary.bytes},
+            {"read_seconds", summary.readSeconds},
+            {"read_mb_per_s", summary.megabytesPerSecond},
+            {"read_latency", latencyToJson(summary.readLatency)},
+            {"file_latency", latencyToJson(summary.fileLatency)},
+            {"avg_read_allocated_bytes", summary.avgReadAllocatedBytes},
+            {"avg_peak_bytes", summary.avgPeakBytes},
+            {"max_peak_bytes", summary.maxPeakBytes}
+        };
+    }
+
+    for (const auto& [strategy, latency] : stats.strategyLatency)
+        statsJson["strategies"][strategy] = latencyToJson(latency);
+
+    statsJson["memory"]["peak_rss_bytes"] = stats.peakRssBytes;
+    statsJson["memory"]["streamed_files"] = stats.streamedFiles;
+    statsJson["memory"]["top_files"] = nlohmann::json::array();
+
+    for (const auto& file : stats.memoryHungryFiles)
+        statsJson["memory"]["top_files"].push_back({
+            {"file", file.filePath},
+            {"type", file.fileType},
+            {"peak_bytes", file.peakBytes},
+            {"allocated_bytes", file.allocatedBytes},
+            {"rss_bytes", file.rssBytes} });
+
+    for (const auto& cost : stats.patternCosts)
+        statsJson["pattern_profile"].push_back({
+            {"strategy", cost.strategy},
+            {"category", cost.category},
+            {"pattern", cost.pattern},
+            {"seconds", cost.seconds},
+            {"bytes_scanned", cost.bytesScanned},
+            {"matches", cost.matches},
+            {"calls", cost.calls},
+            {"program_size", cost.programSize},
+            {"max_mem", cost.memoryBudget} });
+
+    return statsJson;
+}
+
+JsonExporter::JsonExporter(const std::filesystem::path& outputFile, const MatchInterner& values)
+    : outputFile(outputFile), _values(values)
 {
     jsonData["records"] = nlohmann::json::array();
 }
@@ -65,7 +294,7 @@ JsonExporter::JsonExporter(const std::filesystem::path& outputFile): outputFile(
 JsonExporter::~JsonExporter() = default;
 
 void JsonExporter::processFileResults(const std::filesystem::path& filePath,
-    const std::map<std::string, std::vector<std::string>>& results, double duration)
+    const PIIMatches& results, double duration)
 {
     nlohmann::json record;
     record["file"] = filePath;
@@ -74,8 +303,13 @@ void JsonExporter::processFileResults(const std::filesystem::path& filePath,
 
     nlohmann::json matches;
 
-    for (const auto& [type, values]: results)
-        matches[type] = values;
+    for (const auto& [type, ids]: results)
+    {
+        auto& values = matches[type] = nlohmann::json::array();
+
+        for (const auto id : ids)
+            values.push_back(_values.value(id));
+    }
 
     record["matches"] = matches;
     jsonData["records"].push_back(record);
@@ -83,14 +317,7 @@ void JsonExporter::processFileResults(const std::filesystem::path& filePath,
 
 void JsonExporter::finalize(const PIIGeneralStats::Stats& stats)
 {
-    nlohmann::json statsJson;
-    statsJson["total_files"] = stats.totalFiles;
-    statsJson["total_pii"] = stats.totalPII;
-    statsJson["total_duration"] = stats.totalDuration;
-    statsJson["avg_duration"] = stats.avgDuration;
-
-    statsJson["pii_counts"] = stats.piiCounts;
-    jsonData["statistics"] = statsJson;
+    jsonData["statistics"] = statsToJson(stats);
 
     std::ofstream file(outputFile, std::ios::trunc);
 
@@ -98,4 +325,100 @@ void JsonExporter::finalize(const PIIGeneralStats::Stats& stats)
         throw std::runtime_error("Could not open output file: " + outputFile.string());
 
     file << jsonData.dump(4) << std::endl;
-}
\ No newline at end of file
+}
+
+
+NdjsonExporter::NdjsonExporter(const std::filesystem::path& outputFile, const MatchInterner& values,
+    OutputCompression compression)
+    : _values(values), _writer(createOutputSink(outputFile, compression)) {}
+
+// Shared by both appendRecord overloads; valueOf maps one stored match to its text
+template<typename Matches, typename ValueOf>
+static void appendRecordWith(std::string& out, const std::filesystem::path& filePath,
+    const Matches& results, ValueOf valueOf, double duration)
+{
+    const auto u8Path = filePath.u8string();
+
+    out += "{\"file\":";
+    JsonText::appendString(out, std::string_view(reinterpret_cast<const char*>(u8Path.data()), u8Path.size()));
+    out += ",\"duration\":";
+    JsonText::appendNumber(out, duration);
+    out += ",\"timestamp\":";
+    JsonText::appendNumber(out, static_cast<long long>(std::chrono::system_clock::now().time_since_epoch().count()));
+    out += ",\"matches\":{";
+
+    bool firstType = true;
+    for (const auto& [type, matches]: results)
+    {
+        if (!firstType)
+            out += ',';
+        firstType = false;
+
+        JsonText::appendString(out, type);
+        out += ":[";
+
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            if (i > 0)
+                out += ',';
+            JsonText::appendString(out, valueOf(matches[i]));
+        }
+
+        out += ']';
+    }
+
+    out += "}}";
+}
+
+void NdjsonExporter::appendRecord(std::string& out, const std::filesystem::path& filePath,
+    const PIIMatches& results, const MatchInterner& values, double duration)
+{
+    appendRecordWith(out, filePath, results,
+        [&values](MatchInterner::Id id) { return values.value(id); }, duration);
+}
+
+void NdjsonExporter::appendRecord(std::string& out, const std::filesystem::path& filePath,
+    const std::map<std::string, std::vector<std::string>>& results, double duration)
+{
+    appendRecordWith(out, filePath, results,
+        [](const std::string& value) -> std::string_view { return value; }, duration);
+}
+
+void NdjsonExporter::processFileResults(const std::filesystem::path& filePath,
+    const PIIMatches& results, double duration)
+{
+    appendRecord(_pending, filePath, results, _values, duration);
+    _pending += '\n';
+
+    if (_pending.size() >= SUBMIT_BYTES)
+        _writer.submit(std::exchange(_pending, {}));
+}
+
+void NdjsonExporter::finalize(const PIIGeneralStats::Stats& stats)
+{
+    nlohmann::json statsRecord;
+    statsRecord["statistics"] = statsToJson(stats);
+
+    _pending += statsRecord.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    _pending += '\n';
+    _writer.submit(std::exchange(_pending, {}));
+    _writer.close();
+}
+
+
+void BinaryExporter::processFileResults(const std::filesystem::path& filePath,
+    const PIIMatches& results, double duration)
+{
+    _writer.addFile(filePath, duration, std::chrono::system_clock::now().time_since_epoch().count());
+
+    for (const auto& [type, ids]: results)
+        for (const auto id: ids)
+            _writer.addMatch(type, id);
+}
+
+void BinaryExporter::finalize(const PIIGeneralStats::Stats& stats)
+{
+    _writer.write(_outputFile, _values.size(),
+        [this](uint32_t id) { return _values.value(id); },
+        statsToJson(stats).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+}
@@ -0,0 +1,311 @@
+#include "PathFilter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <re2/re2.h>
+#include <re2/set.h>
+
+class PathFilter::GlobSet
+{
+public:
+    enum class Verdict
+    {
+        None,
+        Matched,
+        Negated
+    };
+
+    GlobSet(): _set(options(), RE2::ANCHOR_BOTH) {}
+
+    // One line of .gitignore syntax; blank lines and comments add nothing.
+    // False with the reason when the glob does not compile.
+    bool add(std::string line, std::string& error)
+    {
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r'))
+            line.pop_back();
+
+        if (line.empty() || line.front() == '#')
+            return true;
+
+        Glob glob;
+
+        if (line.front() == '!')
+        {
+            glob.negated = true;
+            line.erase(0, 1);
+        }
+        else if (line.starts_with("\\!") || line.starts_with("\\#"))
+            line.erase(0, 1);
+
+        if (!line.empty() && line.back() == '/')
+        {
+            glob.directoryOnly = true;
+            line.pop_back();
+        }
+
+        // A slash anywhere but at the end anchors the glob to its directory
+        const bool anchored = line.find('/') != std::string::npos;
+        if (!line.empty() && line.front() == '/')
+            line.erase(0, 1);
+
+        // "!", "/" and the like: nothing is left to match
+        if (line.empty())
+            return true;
+
+        if (_set.Add(toRegex(line, anchored), &error) < 0)
+            return false;
+
+        _globs.push_back(glob);
+        return true;
+    }
+
+    void compile()
+    {
+        if (!_globs.empty() && !_set.Compile())
+            throw std::runtime_error("Out of memory compiling path globs");
+    }
+
+    bool empty() const
+    {
+        return _globs.empty();
+    }
+
+    // The last glob that matches decides, as in .gitignore
+    Verdict match(const std::string& path, bool isDirectory) const
+    {
+        if (_globs.empty())
+            return Verdict::None;
+
+        thread_local std::vector<int> matched;
+        matched.clear();
+
+        if (!_set.Match(path, &matched))
+            return Verdict::None;
+
+        std::sort(matched.begin(), matched.end(), std::greater<>());
+
+        for (const auto index : matched)
+        {
+            const auto& glob = _globs[static_cast<size_t>(index)];
+
+            if (!glob.directoryOnly || isDirectory)
+                return glob.negated ? Verdict::Negated : Verdict::Matched;
+        }
+
+        return Verdict::None;
+    }
+
+private:
+    struct Glob
+    {
+        bool negated = false;
+        bool directoryOnly = false;
+    };
+
+    // Bytes, not UTF-8: file names need not be valid text
+    static RE2::Options options()
+    {
+        RE2::Options options;
+        options.set_encoding(RE2::Options::EncodingLatin1);
+        options.set_dot_nl(true);
+        options.set_log_errors(false);
+        return options;
+    }
+
+    static std::string toRegex(const std::string& glob, bool anchored)
+    {
+        std::string regex = anchored ? "" : "(?:.*/)?";
+
+        for (size_t i = 0; i < glob.size(); ++i)
+        {
+            const char c = glob[i];
+
+            if (c == '*' && i + 1 < glob.size() && glob[i + 1] == '*')
+            {
+                // "**/" is any number of directories, a final "**" everything below
+                if (i + 2 < glob.size() && glob[i + 2] == '/')
+                {
+                    regex += "(?:.*/)?";
+                    i += 2;
+                }
+                else
+                {
+                    regex += ".*";
+                    ++i;
+                }
+            }
+
+            else if (c == '*')
+                regex += "[^/]*";
+
+            else if (c == '?')
+                regex += "[^/]";
+
+            else if (c == '[')
+            {
+                // "]" right after the opening bracket (or "[!") is a member, not the end
+                size_t end = i + 1;
+                if (end < glob.size() && (glob[end] == '!' || glob[end] == '^'))
+                    ++end;
+                if (end < glob.size() && glob[end] == ']')
+                    ++end;
+                end = glob.find(']', end);
+
+                if (end == std::string::npos)
+                {
+                    regex += "\\[";
+                    continue;
+                }
+
+                std::string members = glob.substr(i + 1, end - i - 1);
+                if (members.front() == '!')
+                    members.front() = '^';
+
+                regex += '[' + members + ']';
+                i = end;
+            }
+
+            else if (c == '\\' && i + 1 < glob.size())
+                regex += RE2::QuoteMeta(std::string(1, glob[++i]));
+
+            else
+                regex += RE2::QuoteMeta(std::string(1, c));
+        }
+
+        return regex;
+    }
+
+    RE2::Set _set;
+    std::vector<Glob> _globs;
+};
+
+namespace
+{
+    std::unique_ptr<PathFilter::GlobSet> compileGlobs(const std::vector<std::string>& globs, const char* option)
+    {
+        auto set = std::make_unique<PathFilter::GlobSet>();
+
+        for (const auto& glob : globs)
+        {
+            std::string error;
+            if (!set->add(glob, error))
+                throw std::invalid_argument(std::string("Invalid ") + option + " glob " + glob + ": " + error);
+        }
+
+        set->compile();
+        return set;
+    }
+}
+
+PathFilter::PathFilter(Options options)
+    : _options(std::move(options)),
+      _include(compileGlobs(_options.include, "--include")),
+      _exclude(compileGlobs(_options.exclude, "--exclude"))
+{
+}
+
+PathFilter::~PathFilter() = default;
+
+PathFilter::Walk::Walk(const PathFilter& filter, const std::filesystem::path& root): _filter(filter)
+{
+    loadIgnoreFile(root, "", 0);
+}
+
+PathFilter::Walk::~Walk() = default;
+
+bool PathFilter::Walk::entersDirectory(const std::filesystem::path& directory, const std::filesystem::path& relative,
+                                       int depth)
+{
+    leaveDirectories(depth);
+
+    auto path = relative.generic_string();
+    if (excludes(path, true))
+        return false;
+
+    loadIgnoreFile(directory, std::move(path), depth + 1);
+    return true;
+}
+
+bool PathFilter::Walk::acceptsPath(const std::filesystem::path& relative, int depth)
+{
+    leaveDirectories(depth);
+
+    const auto path = relative.generic_string();
+    if (excludes(path, false))
+        return false;
+
+    return _filter._include->empty() || _filter._include->match(path, false) == GlobSet::Verdict::Matched;
+}
+
+bool PathFilter::Walk::acceptsFile(const std::filesystem::directory_entry& entry, uint64_t bytes) const
+{
+    const auto& options = _filter._options;
+
+    if (bytes < options.minBytes || (options.maxBytes != 0 && bytes > options.maxBytes))
+        return false;
+
+    if (!options.modifiedAfter && !options.modifiedBefore)
+        return true;
+
+    // The only filter that needs a second stat, so it is asked for last
+    std::error_code error;
+    const auto modified = entry.last_write_time(error);
+
+    return !error && (!options.modifiedAfter || modified >= *options.modifiedAfter)
+                  && (!options.modifiedBefore || modified < *options.modifiedBefore);
+}
+
+void PathFilter::Walk::leaveDirectories(int depth)
+{
+    while (!_ignoreFiles.empty() && _ignoreFiles.back().depth > depth)
+        _ignoreFiles.pop_back();
+}
+
+// --exclude first, then the ignore files from the deepest up: the nearest one with an opinion decides
+bool PathFilter::Walk::excludes(const std::string& relative, bool isDirectory) const
+{
+    if (_filter._exclude->match(relative, isDirectory) == GlobSet::Verdict::Matched)
+        return true;
+
+    for (auto it = _ignoreFiles.rbegin(); it != _ignoreFiles.rend(); ++it)
+    {
+        const auto path = it->base.empty() ? relative : relative.substr(it->base.size() + 1);
+        const auto verdict = it->globs->match(path, isDirectory);
+
+        if (verdict != GlobSet::Verdict::None)
+            return verdict == GlobSet::Verdict::Matched;
+    }
+
+    return false;
+}
+
+void PathFilter::Walk::loadIgnoreFile(const std::filesystem::path& directory, std::string base, int depth)
+{
+    if (!_filter._options.ignoreFiles)
+        return;
+
+    const auto filePath = directory / IGNORE_FILE;
+    std::ifstream in(filePath);
+
+    if (!in)
+        return;
+
+    auto globs = std::make_unique<GlobSet>();
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        std::string error;
+        if (!globs->add(line, error))
+            std::cerr << "Warning: " << filePath.string() << ": skipping " << line << ": " << error << std::endl;
+    }
+
+    if (globs->empty())
+        return;
+
+    globs->compile();
+    _ignoreFiles.push_back({ depth, std::move(base), std::move(globs) });
+}
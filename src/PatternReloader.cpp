@@ -0,0 +1,117 @@
+#include "PatternReloader.h"
+#include "PatternRegistry.h"
+
+#include <condition_variable>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+    std::atomic<PatternReloader*> signalTarget { nullptr };
+
+    void onReloadSignal(int)
+    {
+        if (auto* reloader = signalTarget.load())
+            reloader->requestReload();
+    }
+}
+
+PatternReloader::PatternReloader(StrategySlot& slot, std::filesystem::path configFile, std::string strategyName,
+                                 MatcherCache cache, MatchValidators validators,
+                                 MatchResolver resolver, std::chrono::milliseconds pollInterval)
+    : _slot(slot),
+      _configFile(std::move(configFile)),
+      _strategyName(std::move(strategyName)),
+      _cache(std::move(cache)),
+      _validators(std::move(validators)),
+      _resolver(std::move(resolver)),
+      _pollInterval(pollInterval)
+{
+    signalTarget.store(this);
+
+    struct sigaction action {};
+    action.sa_handler = onReloadSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGHUP, &action, nullptr);
+
+    _thread = std::jthread([this](std::stop_token stopToken) { run(stopToken); });
+}
+
+PatternReloader::~PatternReloader()
+{
+    ::signal(SIGHUP, SIG_DFL);
+    signalTarget.store(nullptr);
+
+    _thread.request_stop();
+    _thread.join();
+}
+
+PatternReloader::FileState PatternReloader::fileState() const
+{
+    std::error_code error;
+    FileState state;
+    state.modified = std::filesystem::last_write_time(_configFile, error);
+    state.size = error ? 0 : std::filesystem::file_size(_configFile, error);
+    return error ? FileState {} : state;
+}
+
+bool PatternReloader::reload()
+{
+    try
+    {
+        if (!std::filesystem::is_regular_file(_configFile))
+            throw std::runtime_error("Pattern config not found: " + _configFile.string());
+
+        std::map<std::string, std::vector<std::string>> patterns;
+        std::map<std::string, std::vector<std::string>> keywords;
+        JsonProvider(_configFile.string()).provide(patterns, keywords);
+
+        auto strategy = PIIStrategyHandler::createStrategy(_strategyName, patterns, keywords, _cache, _validators, _resolver);
+        if (strategy->categories().empty())
+            throw std::runtime_error("No " + _strategyName + " patterns in " + _configFile.string());
+
+        const auto generation = _slot.publish(std::move(strategy));
+        std::cout << "Reloaded patterns from " << _configFile.string() << " (generation " << generation << ")" << std::endl;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: pattern reload failed, keeping the current patterns: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void PatternReloader::run(std::stop_token stopToken)
+{
+    std::mutex mutex;
+    std::condition_variable_any wakeUp;
+
+    auto loaded = fileState();
+    auto pending = loaded;
+
+    while (!stopToken.stop_requested())
+    {
+        {
+            std::unique_lock lock(mutex);
+            wakeUp.wait_for(lock, stopToken, _pollInterval, [] { return false; });
+        }
+
+        if (stopToken.stop_requested())
+            break;
+
+        const auto current = fileState();
+
+        // A changed file is reloaded once it has stayed the same for one poll,
+        // so an editor that is still writing is not picked up half-way
+        const bool settled = current != loaded && current == pending && current != FileState {};
+        pending = current;
+
+        if (_reloadRequested.exchange(false) || settled)
+        {
+            reload();
+            loaded = current;
+        }
+    }
+}
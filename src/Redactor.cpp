@@ -0,0 +1,264 @@
+#include "Redactor.h"
+#include "FileReaders.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+RedactionStyle parseRedactionStyle(const std::string& name)
+{
+    if (name.empty() || name == "mask")
+        return RedactionStyle::Mask;
+    if (name == "token")
+        return RedactionStyle::Token;
+
+    throw std::invalid_argument("Unsupported redaction style: " + name);
+}
+
+namespace
+{
+    struct FileDescriptor
+    {
+        int fd = -1;
+
+        explicit FileDescriptor(int descriptor): fd(descriptor) {}
+        FileDescriptor(const FileDescriptor&) = delete;
+        FileDescriptor& operator=(const FileDescriptor&) = delete;
+        ~FileDescriptor() { if (fd >= 0) ::close(fd); }
+    };
+
+    // The output of one file. Short gaps and replacements collect in a buffer,
+    // long gaps go from file to file inside the kernel.
+    class RedactedCopy
+    {
+    public:
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+        static constexpr size_t ZERO_COPY_MIN = 16 * 1024;     // below this one read beats a syscall pair
+
+        RedactedCopy(int input, int output): _input(input), _output(output)
+        {
+            _buffer.reserve(BUFFER_SIZE);
+        }
+
+        void copy(off_t offset, size_t length)
+        {
+            if (length >= ZERO_COPY_MIN && _zeroCopy)
+            {
+                flush();
+
+                while (length > 0)
+                {
+                    loff_t from = offset;
+                    const auto copied = ::copy_file_range(_input, &from, _output, nullptr, length, 0);
+
+                    if (copied > 0)
+                    {
+                        offset += copied;
+                        length -= static_cast<size_t>(copied);
+                        continue;
+                    }
+
+                    if (copied == 0)
+                        throw std::runtime_error("file shrank while it was redacted");
+
+                    if (errno == EINTR)
+                        continue;
+
+                    // Across filesystems, on old kernels and on special files: plain reads from here on
+                    if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)
+                    {
+                        _zeroCopy = false;
+                        break;
+                    }
+
+                    throw std::system_error(errno, std::generic_category(), "copy_file_range");
+                }
+            }
+
+            while (length > 0)
+            {
+                if (_buffer.size() == BUFFER_SIZE)
+                    flush();
+
+                const size_t used = _buffer.size();
+                const size_t wanted = std::min(length, BUFFER_SIZE - used);
+                _buffer.resize(used + wanted);
+                const auto got = ::pread(_input, _buffer.data() + used, wanted, offset);
+
+                if (got < 0 && errno == EINTR)
+                {
+                    _buffer.resize(used);
+                    continue;
+                }
+
+                if (got <= 0)
+                {
+                    if (got == 0)
+                        throw std::runtime_error("file shrank while it was redacted");
+                    throw std::system_error(errno, std::generic_category(), "pread");
+                }
+
+                _buffer.resize(used + static_cast<size_t>(got));
+                offset += got;
+                length -= static_cast<size_t>(got);
+            }
+        }
+
+        void append(char c, size_t count)
+        {
+            while (count > 0)
+            {
+                if (_buffer.size() == BUFFER_SIZE)
+                    flush();
+
+                const size_t taken = std::min(count, BUFFER_SIZE - _buffer.size());
+                _buffer.append(taken, c);
+                count -= taken;
+            }
+        }
+
+        void append(const std::string& text)
+        {
+            if (_buffer.size() + text.size() > BUFFER_SIZE)
+                flush();
+
+            _buffer += text;
+        }
+
+        void flush()
+        {
+            const char* data = _buffer.data();
+            size_t left = _buffer.size();
+
+            while (left > 0)
+            {
+                const auto written = ::write(_output, data, left);
+
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "write");
+                }
+
+                data += written;
+                left -= static_cast<size_t>(written);
+            }
+
+            _buffer.clear();
+        }
+
+    private:
+        int _input;
+        int _output;
+        std::string _buffer;
+        bool _zeroCopy = true;
+    };
+}
+
+Redactor::Redactor(std::filesystem::path inputRoot, std::filesystem::path outputDirectory, RedactionStyle style)
+    : _inputRoot(std::move(inputRoot)), _outputDirectory(std::move(outputDirectory)), _style(style)
+{
+    if (std::filesystem::is_regular_file(_inputRoot))
+        _inputRoot = _inputRoot.parent_path();
+
+    _inputRoot = std::filesystem::absolute(_inputRoot).lexically_normal();
+
+    // Copies are renamed over their target, which must never be the original
+    if (std::filesystem::weakly_canonical(_outputDirectory) == std::filesystem::weakly_canonical(_inputRoot))
+        throw std::invalid_argument("Redaction directory must differ from the input directory: " + _outputDirectory.string());
+}
+
+bool Redactor::isSupported(const std::filesystem::path& filePath)
+{
+    const auto extension = FileReaderFactory::normalizeExtension(filePath.extension().string());
+    return extension == ".txt" || extension == ".xml";
+}
+
+std::filesystem::path Redactor::outputPath(const std::filesystem::path& filePath) const
+{
+    auto relative = std::filesystem::absolute(filePath).lexically_normal().lexically_relative(_inputRoot);
+
+    if (relative.empty() || *relative.begin() == "..")
+        relative = filePath.filename();
+
+    return _outputDirectory / relative;
+}
+
+void Redactor::redact(const std::filesystem::path& filePath, std::vector<MatchSpan> spans,
+                      const std::vector<std::string>& categories)
+{
+    std::sort(spans.begin(), spans.end(), [](const MatchSpan& lhs, const MatchSpan& rhs)
+    {
+        return lhs.begin != rhs.begin ? lhs.begin < rhs.begin : lhs.end > rhs.end;
+    });
+
+    FileDescriptor input(::open(filePath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (input.fd < 0)
+        throw std::runtime_error("Cannot open file: " + filePath.string());
+
+    struct stat fileStat {};
+    if (::fstat(input.fd, &fileStat) != 0)
+        throw std::system_error(errno, std::generic_category(), "fstat " + filePath.string());
+
+    const auto target = outputPath(filePath);
+    std::filesystem::create_directories(target.parent_path());
+
+    auto temporary = target;
+    temporary += "." + std::to_string(::getpid()) + ".tmp";
+
+    try
+    {
+        FileDescriptor output(::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, fileStat.st_mode & 0777));
+        if (output.fd < 0)
+            throw std::runtime_error("Could not open output file: " + temporary.string());
+
+        const auto fileSize = static_cast<size_t>(fileStat.st_size);
+        RedactedCopy copy(input.fd, output.fd);
+        size_t position = 0;
+        size_t redacted = 0;
+
+        for (size_t index = 0; index < spans.size(); )
+        {
+            // Overlapping matches (--keep-overlaps, keywords) become one range named after the first
+            const auto category = spans[index].category;
+            const size_t begin = std::max(spans[index].begin, position);
+            size_t end = spans[index].end;
+
+            while (++index < spans.size() && spans[index].begin < end)
+                end = std::max(end, spans[index].end);
+
+            end = std::min(end, fileSize);
+            if (begin >= end)
+                continue;
+
+            copy.copy(static_cast<off_t>(position), begin - position);
+
+            if (_style == RedactionStyle::Mask)
+                copy.append('*', end - begin);
+            else
+                copy.append("[REDACTED:" + (category < categories.size() ? categories[category] : std::string("pii")) + "]");
+
+            position = end;
+            ++redacted;
+        }
+
+        copy.copy(static_cast<off_t>(position), fileSize - position);
+        copy.flush();
+
+        std::filesystem::rename(temporary, target);
+        _filesWritten.fetch_add(1, std::memory_order_relaxed);
+        _rangesRedacted.fetch_add(redacted, std::memory_order_relaxed);
+    }
+
+    catch (...)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        throw;
+    }
+}
@@ -0,0 +1,453 @@
+#include "ResultMerge.h"
+#include "LatencyHistogram.h"
+#include "ValueSketch.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    // One NDJSON results file, read a record at a time
+    class ResultInput
+    {
+    public:
+        explicit ResultInput(const std::filesystem::path& filePath): _filePath(filePath), _stream(filePath, std::ios::binary)
+        {
+            if (!_stream)
+                throw std::runtime_error("Cannot open file: " + filePath.string());
+
+            // gzip and zstd magic; process substitution, <(zcat file), reads them fine
+            const auto first = _stream.peek();
+            if (first == 0x1f || first == 0x28)
+                throw std::runtime_error(filePath.string() + " is compressed, pass it decompressed, e.g. <(zcat " +
+                                         filePath.string() + ")");
+        }
+
+        // Moves to the next file record, handing statistics records to onStatistics; false at the end
+        bool next(const std::function<void(const nlohmann::json&)>& onStatistics)
+        {
+            while (std::getline(_stream, _line))
+            {
+                ++_lineNumber;
+
+                if (_line.empty())
+                    continue;
+
+                try
+                {
+                    _record = nlohmann::json::parse(_line);
+                }
+                catch (const nlohmann::json::parse_error& e)
+                {
+                    throw std::runtime_error(_filePath.string() + ":" + std::to_string(_lineNumber) + ": " + e.what());
+                }
+
+                if (_record.contains("statistics"))
+                {
+                    onStatistics(_record["statistics"]);
+                    continue;
+                }
+
+                _timestamp = _record.value("timestamp", int64_t { 0 });
+                return true;
+            }
+
+            return false;
+        }
+
+        const std::filesystem::path& filePath() const noexcept { return _filePath; }
+        const std::string& line() const noexcept { return _line; }
+        const nlohmann::json& record() const noexcept { return _record; }
+        int64_t timestamp() const noexcept { return _timestamp; }
+
+    private:
+        std::filesystem::path _filePath;
+        std::ifstream _stream;
+        std::string _line;
+        size_t _lineNumber = 0;
+        nlohmann::json _record;
+        int64_t _timestamp = 0;
+    };
+
+    // Same shape as the latency objects written by the exporters
+    nlohmann::json latencyToJson(const LatencyHistogram::Summary& latency)
+    {
+        return
+        {
+            {"count", latency.count},
+            {"p50", latency.p50},
+            {"p95", latency.p95},
+            {"p99", latency.p99},
+            {"max", latency.max},
+            {"buckets", latency.buckets}
+        };
+    }
+
+    void mergeLatency(LatencyHistogram& histogram, const nlohmann::json& latency)
+    {
+        if (latency.contains("buckets"))
+        {
+            histogram.merge(latency["buckets"].get<std::vector<std::pair<uint32_t, uint64_t>>>(), latency.value("max", 0.0));
+            return;
+        }
+
+        // Written without buckets: every file at the median, one at the maximum
+        const auto count = latency.value("count", uint64_t { 0 });
+
+        if (count > 0)
+        {
+            histogram.record(latency.value("p50", 0.0), count - 1);
+            histogram.record(latency.value("max", 0.0));
+        }
+    }
+
+    class StatisticsMerger
+    {
+    public:
+        void addRecord(const nlohmann::json& record)
+        {
+            ++_totalFiles;
+            _totalDuration += record.value("duration", 0.0);
+
+            if (!record.contains("matches"))
+                return;
+
+            // Occurrences per distinct value of this file; the record owns the strings
+            std::unordered_map<std::string_view, uint64_t> fileValues;
+
+            for (const auto& [type, values] : record["matches"].items())
+            {
+                _piiCounts[type] += values.size();
+                _totalPII += values.size();
+
+                for (const auto& value : values)
+                    ++fileValues[value.get_ref<const std::string&>()];
+            }
+
+            // A value counts once per file, whatever its number of matches
+            for (const auto& [value, occurrences] : fileValues)
+            {
+                _topValues.add(value, occurrences, 1);
+                _distinctValues.add(value);
+            }
+        }
+
+        void addStatistics(const nlohmann::json& statistics, const std::filesystem::path& source)
+        {
+            ++_statisticsRecords;
+            _topValueCount = std::max(_topValueCount, statistics.value("top_values", nlohmann::json::array()).size());
+
+            // value() returns a copy, which has to outlive the loops over its items()
+            const auto timedOutFiles = statistics.value("timed_out_files", nlohmann::json::array());
+            const auto stages = statistics.value("stages", nlohmann::json::object());
+            const auto fileTypes = statistics.value("file_types", nlohmann::json::object());
+            const auto strategies = statistics.value("strategies", nlohmann::json::object());
+
+            for (const auto& file : timedOutFiles)
+                _timedOutFiles.push_back(file.get<std::string>());
+
+            for (const auto& [stage, seconds] : stages.items())
+                _stageSeconds[stage] += seconds.get<double>();
+
+            if (statistics.contains("schedule"))
+                addSchedule(statistics["schedule"]);
+
+            for (const auto& [name, summary] : fileTypes.items())
+            {
+                auto& fileType = _fileTypes[name];
+                const auto files = summary.value("files", size_t { 0 });
+                fileType.files += files;
+                fileType.bytes += summary.value("bytes", uint64_t { 0 });
+                fileType.readSeconds += summary.value("read_seconds", 0.0);
+                fileType.readAllocatedBytes += summary.value("avg_read_allocated_bytes", 0.0) * static_cast<double>(files);
+                fileType.peakBytes += summary.value("avg_peak_bytes", 0.0) * static_cast<double>(files);
+                fileType.maxPeakBytes = std::max(fileType.maxPeakBytes, summary.value("max_peak_bytes", uint64_t { 0 }));
+
+                if (summary.contains("read_latency"))
+                    mergeLatency(fileType.readLatency, summary["read_latency"]);
+                if (summary.contains("file_latency"))
+                    mergeLatency(fileType.fileLatency, summary["file_latency"]);
+            }
+
+            for (const auto& [strategy, latency] : strategies.items())
+                mergeLatency(_strategyLatency[strategy], latency);
+
+            if (statistics.contains("memory"))
+            {
+                const auto& memory = statistics["memory"];
+                _peakRssBytes = std::max(_peakRssBytes, memory.value("peak_rss_bytes", uint64_t { 0 }));
+                _streamedFiles += memory.value("streamed_files", size_t { 0 });
+
+                const auto topFiles = memory.value("top_files", nlohmann::json::array());
+                _memoryFileCount = std::max(_memoryFileCount, topFiles.size());
+                _memoryFiles.insert(_memoryFiles.end(), topFiles.begin(), topFiles.end());
+                keepTopMemoryFiles();
+            }
+
+            const auto patterns = statistics.value("pattern_profile", nlohmann::json::array());
+            _patternCount = std::max(_patternCount, patterns.size());
+
+            for (const auto& cost : patterns)
+            {
+                auto& merged = _patternCosts[{ cost.value("strategy", ""), cost.value("category", ""), cost.value("pattern", "") }];
+
+                if (merged.is_null())
+                {
+                    merged = cost;
+                    continue;
+                }
+
+                merged["seconds"] = merged.value("seconds", 0.0) + cost.value("seconds", 0.0);
+
+                for (const auto* counter : { "bytes_scanned", "matches", "calls" })
+                    merged[counter] = merged.value(counter, uint64_t { 0 }) + cost.value(counter, uint64_t { 0 });
+            }
+
+            if (statistics.contains("shard"))
+            {
+                const auto& shard = statistics["shard"];
+                _shardCount = std::max(_shardCount, shard.value("count", size_t { 0 }));
+                _shards[shard.value("index", size_t { 0 })].push_back(source);
+            }
+        }
+
+        // Complaints about the set of inputs, once everything is read
+        void checkShards(size_t inputCount) const
+        {
+            if (_statisticsRecords < inputCount)
+                std::cerr << "Warning: " << inputCount - _statisticsRecords << " input(s) have no statistics record, "
+                          << "was a scan interrupted? Their files are in the totals, their timings are not" << std::endl;
+
+            if (_shards.empty())
+                return;
+
+            for (const auto& [index, sources] : _shards)
+                if (sources.size() > 1)
+                    std::cerr << "Warning: shard " << index << '/' << _shardCount << " appears in "
+                              << sources.size() << " inputs, its files are counted more than once" << std::endl;
+
+            for (size_t index = 1; index <= _shardCount; ++index)
+                if (!_shards.contains(index))
+                    std::cerr << "Warning: shard " << index << '/' << _shardCount << " is missing" << std::endl;
+        }
+
+        nlohmann::json result() const
+        {
+            nlohmann::json statsJson;
+            statsJson["total_files"] = _totalFiles;
+            statsJson["total_pii"] = _totalPII;
+            statsJson["total_duration"] = _totalDuration;
+            statsJson["avg_duration"] = _totalFiles > 0 ? _totalDuration / static_cast<double>(_totalFiles) : 0.0;
+
+            statsJson["pii_counts"] = _piiCounts;
+            // Exact until more distinct values than the sketch holds came by
+            statsJson["distinct_values"] = _topValues.exact() ? _topValues.size() : _distinctValues.estimate();
+            statsJson["distinct_values_estimated"] = !_topValues.exact();
+            statsJson["top_values_estimated"] = !_topValues.exact();
+            statsJson["timed_out_files"] = _timedOutFiles;
+            statsJson["top_values"] = topValues();
+
+            for (const auto& [stage, seconds] : _stageSeconds)
+                statsJson["stages"][stage] = seconds;
+
+            if (!_schedule.policy.empty())
+            {
+                statsJson["schedule"] =
+                {
+                    {"policy", _schedule.policy},
+                    {"threads", _schedule.threads},
+                    {"wall_seconds", _schedule.wallSeconds},
+                    {"busy_seconds", _schedule.busySeconds},
+                    {"longest_file_seconds", _schedule.longestFileSeconds},
+                    {"efficiency", _schedule.capacity > 0.0 ? std::min(1.0, _schedule.busySeconds / _schedule.capacity) : 0.0},
+                    {"best_efficiency", _schedule.bestCapacity > 0.0
+                        ? std::min(1.0, _schedule.busySeconds / _schedule.bestCapacity) : 0.0}
+                };
+            }
+
+            for (const auto& [name, fileType] : _fileTypes)
+            {
+                const auto files = static_cast<double>(std::max<size_t>(1, fileType.files));
+
+                statsJson["file_types"][name] =
+                {
+                    {"files", fileType.files},
+                    {"bytes", fileType.bytes},
+                    {"read_seconds", fileType.readSeconds},
+                    {"read_mb_per_s", fileType.readSeconds > 0.0 ? fileType.bytes / (1024.0 * 1024.0) / fileType.readSeconds : 0.0},
+                    {"read_latency", latencyToJson(fileType.readLatency.summary())},
+                    {"file_latency", latencyToJson(fileType.fileLatency.summary())},
+                    {"avg_read_allocated_bytes", static_cast<uint64_t>(fileType.readAllocatedBytes / files)},
+                    {"avg_peak_bytes", static_cast<uint64_t>(fileType.peakBytes / files)},
+                    {"max_peak_bytes", fileType.maxPeakBytes}
+                };
+            }
+
+            for (const auto& [strategy, histogram] : _strategyLatency)
+                statsJson["strategies"][strategy] = latencyToJson(histogram.summary());
+
+            statsJson["memory"]["peak_rss_bytes"] = _peakRssBytes;
+            statsJson["memory"]["streamed_files"] = _streamedFiles;
+            statsJson["memory"]["top_files"] = _memoryFiles;
+
+            std::vector<nlohmann::json> patternCosts;
+            for (const auto& [key, cost] : _patternCosts)
+                patternCosts.push_back(cost);
+
+            std::sort(patternCosts.begin(), patternCosts.end(), [](const nlohmann::json& lhs, const nlohmann::json& rhs)
+                { return lhs.value("seconds", 0.0) > rhs.value("seconds", 0.0); });
+            patternCosts.resize(std::min(patternCosts.size(), _patternCount));
+
+            for (const auto& cost : patternCosts)
+                statsJson["pattern_profile"].push_back(cost);
+
+            return statsJson;
+        }
+
+    private:
+        // Parts run side by side: their workers, wall and busy times add up, and
+        // every part's threads x wall counts towards the capacity they were given
+        struct Schedule
+        {
+            std::string policy;
+            size_t threads = 0;
+            double wallSeconds = 0.0;
+            double busySeconds = 0.0;
+            double longestFileSeconds = 0.0;
+            double capacity = 0.0;
+            double bestCapacity = 0.0;      // threads x the shortest wall each part could have had
+        };
+
+        struct FileType
+        {
+            size_t files = 0;
+            uint64_t bytes = 0;
+            double readSeconds = 0.0;
+            double readAllocatedBytes = 0.0;
+            double peakBytes = 0.0;
+            uint64_t maxPeakBytes = 0;
+            LatencyHistogram readLatency;
+            LatencyHistogram fileLatency;
+        };
+
+        // The largest of the inputs' top files, as many as the longest list had
+        void keepTopMemoryFiles()
+        {
+            std::stable_sort(_memoryFiles.begin(), _memoryFiles.end(), [](const nlohmann::json& lhs, const nlohmann::json& rhs)
+                { return lhs.value("peak_bytes", uint64_t { 0 }) > rhs.value("peak_bytes", uint64_t { 0 }); });
+            _memoryFiles.resize(std::min(_memoryFiles.size(), _memoryFileCount));
+        }
+
+        void addSchedule(const nlohmann::json& schedule)
+        {
+            const auto policy = schedule.value("policy", "");
+            const auto threads = schedule.value("threads", size_t { 0 });
+            const auto wall = schedule.value("wall_seconds", 0.0);
+            const auto busy = schedule.value("busy_seconds", 0.0);
+            const auto longest = schedule.value("longest_file_seconds", 0.0);
+
+            _schedule.policy = _schedule.policy.empty() || _schedule.policy == policy ? policy : "mixed";
+            _schedule.threads += threads;
+            _schedule.wallSeconds += wall;
+            _schedule.busySeconds += busy;
+            _schedule.longestFileSeconds = std::max(_schedule.longestFileSeconds, longest);
+            _schedule.capacity += static_cast<double>(threads) * wall;
+            _schedule.bestCapacity += static_cast<double>(threads)
+                                    * std::max(busy / static_cast<double>(std::max<size_t>(threads, 1)), longest);
+        }
+
+        nlohmann::json topValues() const
+        {
+            auto top = nlohmann::json::array();
+
+            for (const auto& entry : _topValues.top(_topValueCount))
+                top.push_back({ {"value", entry.value}, {"occurrences", entry.occurrences}, {"files", entry.files} });
+
+            return top;
+        }
+
+        size_t _totalFiles = 0;
+        size_t _totalPII = 0;
+        double _totalDuration = 0.0;
+        std::map<std::string, size_t> _piiCounts;
+        HeavyHitters _topValues;
+        DistinctCounter _distinctValues;
+        size_t _topValueCount = 0;
+
+        size_t _statisticsRecords = 0;
+        std::vector<std::string> _timedOutFiles;
+        std::map<std::string, double> _stageSeconds;
+        Schedule _schedule;
+        std::map<std::string, FileType> _fileTypes;
+        std::map<std::string, LatencyHistogram> _strategyLatency;
+        uint64_t _peakRssBytes = 0;
+        size_t _streamedFiles = 0;
+        std::vector<nlohmann::json> _memoryFiles;
+        size_t _memoryFileCount = 0;
+        std::map<std::tuple<std::string, std::string, std::string>, nlohmann::json> _patternCosts;
+        size_t _patternCount = 0;
+
+        std::map<size_t, std::vector<std::filesystem::path>> _shards;     // 1-based index -> inputs
+        size_t _shardCount = 0;
+    };
+}
+
+void mergeNdjsonResults(const std::vector<std::filesystem::path>& inputs, BufferedWriter& writer)
+{
+    std::vector<std::unique_ptr<ResultInput>> readers;
+    readers.reserve(inputs.size());
+
+    for (const auto& input : inputs)
+        readers.push_back(std::make_unique<ResultInput>(input));
+
+    StatisticsMerger statistics;
+
+    // Earliest record first, ties in input order
+    const auto later = [&readers](size_t lhs, size_t rhs)
+    {
+        return std::pair(readers[lhs]->timestamp(), lhs) > std::pair(readers[rhs]->timestamp(), rhs);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heads(later);
+
+    const auto advance = [&](size_t input)
+    {
+        const auto onStatistics = [&](const nlohmann::json& stats) { statistics.addStatistics(stats, inputs[input]); };
+
+        if (readers[input]->next(onStatistics))
+            heads.push(input);
+    };
+
+    for (size_t input = 0; input < readers.size(); ++input)
+        advance(input);
+
+    while (!heads.empty())
+    {
+        const auto input = heads.top();
+        heads.pop();
+
+        statistics.addRecord(readers[input]->record());
+
+        auto& out = writer.buffer();
+        out += readers[input]->line();
+        out += '\n';
+        writer.commit();
+
+        advance(input);
+    }
+
+    statistics.checkShards(inputs.size());
+
+    nlohmann::json statsRecord;
+    statsRecord["statistics"] = statistics.result();
+
+    writer.append(statsRecord.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+    writer.append("\n");
+    writer.close();
+}
@@ -0,0 +1,508 @@
+#include "ScanServer.h"
+#include "FileScan.h"
+#include "PIIResultExporter.h"
+#include "Scanner.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct ScanServer::Connection
+{
+    explicit Connection(int fd): fd(fd) {}
+    ~Connection() { ::close(fd); }
+
+    const int fd;
+    std::mutex writeMutex;
+};
+
+namespace
+{
+    constexpr size_t MAX_HEADER_BYTES = 4096;
+
+    std::atomic<ScanServer*> signalTarget { nullptr };
+
+    void onStopSignal(int)
+    {
+        if (auto* server = signalTarget.load())
+            server->stop();
+    }
+
+    std::string systemError(const std::string& what)
+    {
+        return what + ": " + std::strerror(errno);
+    }
+
+    // Buffered frame reads from a blocking socket; false on EOF or error
+    class FrameReader
+    {
+    public:
+        explicit FrameReader(int fd): _fd(fd) {}
+
+        bool readLine(std::string& line)
+        {
+            line.clear();
+
+            while (true)
+            {
+                const auto newline = _buffer.find('\n', _position);
+                if (newline != std::string::npos)
+                {
+                    line.assign(_buffer, _position, newline - _position);
+                    _position = newline + 1;
+                    return true;
+                }
+
+                if (_buffer.size() - _position > MAX_HEADER_BYTES)
+                    throw std::runtime_error("Frame header too long");
+
+                if (!fill())
+                    return false;
+            }
+        }
+
+        bool readExact(size_t size, std::string& out)
+        {
+            out.clear();
+            out.reserve(size);
+
+            while (out.size() < size)
+            {
+                if (_position == _buffer.size() && !fill())
+                    return false;
+
+                const auto take = std::min(size - out.size(), _buffer.size() - _position);
+                out.append(_buffer, _position, take);
+                _position += take;
+            }
+
+            return true;
+        }
+
+    private:
+        bool fill()
+        {
+            if (_position == _buffer.size())
+            {
+                _buffer.clear();
+                _position = 0;
+            }
+
+            char block[64 * 1024];
+            ssize_t received;
+
+            do
+                received = ::recv(_fd, block, sizeof(block), 0);
+            while (received < 0 && errno == EINTR);
+
+            if (received <= 0)
+                return false;
+
+            _buffer.append(block, static_cast<size_t>(received));
+            return true;
+        }
+
+        int _fd;
+        std::string _buffer;
+        size_t _position = 0;
+    };
+
+    bool sendAll(int fd, const std::string& data)
+    {
+        size_t sent = 0;
+
+        while (sent < data.size())
+        {
+            const auto written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+
+            sent += static_cast<size_t>(written);
+        }
+
+        return true;
+    }
+}
+
+ScanServer::ScanServer(const StrategySlot& strategies, const FileReaderFactory& readers, const ScanServerOptions& options)
+    : _strategies(strategies),
+      _readers(readers),
+      _options(options)
+{
+    if (::pipe2(_wakeFds, O_CLOEXEC | O_NONBLOCK) != 0)
+        throw std::runtime_error(systemError("Cannot create wake-up pipe"));
+}
+
+ScanServer::~ScanServer()
+{
+    ::close(_wakeFds[0]);
+    ::close(_wakeFds[1]);
+}
+
+void ScanServer::stop() noexcept
+{
+    _stopping.store(true);
+    [[maybe_unused]] const auto written = ::write(_wakeFds[1], "x", 1);
+}
+
+int ScanServer::openSocket(const std::filesystem::path& socketPath)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    const auto path = socketPath.string();
+    if (path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument("Socket path too long: " + path);
+
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw std::runtime_error(systemError("Cannot create socket"));
+
+    // A leftover socket file is reused unless another daemon still answers on it
+    if (std::filesystem::is_socket(socketPath))
+    {
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Socket already in use: " + path);
+        }
+
+        std::filesystem::remove(socketPath);
+    }
+
+    // Owner-only: the daemon reads any file its user can read
+    const auto previousMask = ::umask(0177);
+    const bool bound = ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::umask(previousMask);
+
+    if (!bound || ::listen(fd, SOMAXCONN) != 0)
+    {
+        const auto message = systemError("Cannot listen on " + path);
+        ::close(fd);
+        throw std::runtime_error(message);
+    }
+
+    return fd;
+}
+
+int ScanServer::run(const std::filesystem::path& socketPath)
+{
+    const int listenFd = openSocket(socketPath);
+
+    _started = std::chrono::steady_clock::now();
+    signalTarget.store(this);
+
+    struct sigaction action {};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    std::vector<std::jthread> workers;
+    for (size_t i = 0; i < std::max<size_t>(1, _options.workers); ++i)
+        workers.emplace_back([this] { workerLoop(); });
+
+    std::cout << "Serving on " << socketPath.string() << " with " << workers.size() << " worker(s)" << std::endl;
+
+    while (!_stopping.load())
+    {
+        pollfd fds[2] = { { listenFd, POLLIN, 0 }, { _wakeFds[0], POLLIN, 0 } };
+
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            std::cerr << "Error: " << systemError("poll") << std::endl;
+            break;
+        }
+
+        if (fds[1].revents != 0)
+            break;
+
+        if (fds[0].revents & POLLIN)
+        {
+            const int clientFd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (clientFd < 0)
+                continue;
+
+            auto connection = std::make_shared<Connection>(clientFd);
+            {
+                std::lock_guard lock(_connectionsMutex);
+                _connections.insert(connection.get());
+            }
+            {
+                std::lock_guard lock(_statsMutex);
+                ++_totalConnections;
+            }
+
+            std::thread([this, connection] { serveConnection(connection); }).detach();
+        }
+    }
+
+    _stopping.store(true);
+    ::close(listenFd);
+    std::filesystem::remove(socketPath);
+
+    // Drop what is still queued, wake blocked readers and workers, then unblock
+    // the readers waiting on their sockets; in-flight scans finish
+    {
+        std::lock_guard lock(_queueMutex);
+        _queue.clear();
+    }
+    _queueNotEmpty.notify_all();
+    _queueNotFull.notify_all();
+
+    {
+        std::unique_lock lock(_connectionsMutex);
+        for (auto* connection : _connections)
+            ::shutdown(connection->fd, SHUT_RDWR);
+
+        _connectionsDone.wait(lock, [this] { return _connections.empty(); });
+    }
+    workers.clear();
+
+    signalTarget.store(nullptr);
+    std::cout << "Scan server stopped" << std::endl;
+    return 0;
+}
+
+void ScanServer::serveConnection(std::shared_ptr<Connection> connection)
+{
+    FrameReader reader(connection->fd);
+    std::string header;
+
+    try
+    {
+        while (!_stopping.load() && reader.readLine(header))
+        {
+            Request request;
+            size_t length = 0;
+
+            std::istringstream fields(header);
+            if (!(fields >> request.op >> request.id >> length))
+            {
+                respond(*connection, Status::Error, "-", "Malformed frame header: " + header);
+                break;
+            }
+
+            fields >> request.name;
+
+            // Oversized payloads cannot be skipped cheaply, the connection is dropped
+            if (length > _options.maxPayloadBytes)
+            {
+                respond(*connection, Status::Error, request.id, "Payload exceeds " +
+                        std::to_string(_options.maxPayloadBytes) + " bytes");
+                break;
+            }
+
+            if (!reader.readExact(length, request.payload))
+                break;
+
+            if (request.op == "STATS")
+            {
+                {
+                    std::lock_guard lock(_statsMutex);
+                    ++_requests["stats"];
+                }
+                respond(*connection, Status::Ok, request.id, statsJson());
+            }
+            else if (request.op == "PATH" || request.op == "DATA")
+            {
+                request.connection = connection;
+                if (!enqueue(std::move(request)))
+                    break;
+            }
+            else
+                respond(*connection, Status::Error, request.id, "Unknown request type: " + request.op);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        respond(*connection, Status::Error, "-", e.what());
+    }
+
+    std::lock_guard lock(_connectionsMutex);
+    _connections.erase(connection.get());
+    _connectionsDone.notify_all();
+}
+
+bool ScanServer::enqueue(Request&& request)
+{
+    std::unique_lock lock(_queueMutex);
+    _queueNotFull.wait(lock, [this] { return _stopping.load() || _queue.size() < _options.maxQueuedRequests; });
+
+    if (_stopping.load())
+        return false;
+
+    _queue.push_back(std::move(request));
+    _queueNotEmpty.notify_one();
+    return true;
+}
+
+void ScanServer::workerLoop()
+{
+    while (true)
+    {
+        Request request;
+        {
+            std::unique_lock lock(_queueMutex);
+            _queueNotEmpty.wait(lock, [this] { return _stopping.load() || !_queue.empty(); });
+
+            if (_queue.empty())
+                return;
+
+            request = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        _queueNotFull.notify_one();
+
+        handle(request);
+    }
+}
+
+void ScanServer::handle(Request& request)
+{
+    {
+        std::lock_guard lock(_statsMutex);
+        ++_inFlight;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    RawMatches matches;
+    std::string payload;
+    Status status = Status::Ok;
+    uint64_t bytes = 0;
+
+    try
+    {
+        const auto snapshot = _strategies.current();
+        MatchQuota quota(_options.maxMatchesPerType);
+        std::filesystem::path recordPath;
+
+        if (request.op == "PATH")
+        {
+            recordPath = request.payload;
+
+            if (!_readers.isSupported(recordPath))
+                throw std::runtime_error("Unsupported file format: " + recordPath.extension().string());
+
+            const auto timeout = std::chrono::duration_cast<CancellationToken::Clock::duration>(
+                std::chrono::duration<double>(_options.fileTimeoutSeconds));
+            CancellationToken token(timeout);
+
+            std::error_code error;
+            bytes = std::filesystem::file_size(recordPath, error);
+
+            auto reader = _readers.getReader(recordPath);
+            matches = scanFileChunks(*snapshot->strategy, snapshot->categories, *reader, recordPath, quota, token);
+
+            if (token.timedOut())
+                status = Status::Partial;
+        }
+        else
+        {
+            recordPath = request.name.empty() ? "-" : request.name;
+            bytes = request.payload.size();
+            matches = snapshot->strategy->scan(request.payload, quota);
+        }
+
+        NdjsonExporter::appendRecord(payload, recordPath, matches, secondsSince(start));
+        payload += '\n';
+    }
+    catch (const std::exception& e)
+    {
+        status = Status::Error;
+        payload = e.what();
+    }
+
+    // Counted before answering, so a STATS sent after the response includes it
+    {
+        std::lock_guard lock(_statsMutex);
+        --_inFlight;
+        ++_requests[request.op == "PATH" ? "path" : "data"];
+        _latency.record(secondsSince(start));
+
+        if (status == Status::Error)
+            ++_errors;
+        else
+        {
+            _bytesScanned += bytes;
+            _timedOut += status == Status::Partial ? 1 : 0;
+
+            for (const auto& [type, values] : matches)
+                _piiCounts[type] += values.size();
+        }
+    }
+
+    respond(*request.connection, status, request.id, payload);
+}
+
+void ScanServer::respond(Connection& connection, Status status, const std::string& id, const std::string& payload)
+{
+    static constexpr const char* STATUS_NAMES[] = { "OK", "PARTIAL", "ERR" };
+
+    std::string frame = STATUS_NAMES[static_cast<size_t>(status)];
+    frame += ' ';
+    frame += id;
+    frame += ' ';
+    frame += std::to_string(payload.size() + (status == Status::Error ? 1 : 0));
+    frame += '\n';
+    frame += payload;
+
+    if (status == Status::Error)
+        frame += '\n';
+
+    // A client that went away only loses its own responses
+    std::lock_guard lock(connection.writeMutex);
+    sendAll(connection.fd, frame);
+}
+
+std::string ScanServer::statsJson()
+{
+    nlohmann::json stats;
+    size_t queued = 0;
+    size_t connections = 0;
+
+    {
+        std::lock_guard lock(_queueMutex);
+        queued = _queue.size();
+    }
+    {
+        std::lock_guard lock(_connectionsMutex);
+        connections = _connections.size();
+    }
+
+    std::lock_guard lock(_statsMutex);
+    const auto latency = _latency.summary();
+
+    stats["strategy"] = _strategies.current()->strategy->name();
+    stats["pattern_generation"] = _strategies.generation();
+    stats["uptime_seconds"] = secondsSince(_started);
+    stats["workers"] = std::max<size_t>(1, _options.workers);
+    stats["queued"] = queued;
+    stats["in_flight"] = _inFlight;
+    stats["connections"] = { {"active", connections}, {"total", _totalConnections} };
+    stats["requests"] = _requests;
+    stats["errors"] = _errors;
+    stats["timed_out"] = _timedOut;
+    stats["bytes_scanned"] = _bytesScanned;
+    stats["pii_counts"] = _piiCounts;
+    stats["latency"] = { {"count", latency.count}, {"p50", latency.p50}, {"p95", latency.p95},
+                         {"p99", latency.p99}, {"max", latency.max} };
+
+    return stats.dump() + '\n';
+}
@@ -0,0 +1,416 @@
+#include "SpecializedMatchers.h"
+#include "DefaultPatterns.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    enum CharClass : uint8_t
+    {
+        Digit = 1 << 0,
+        Alpha = 1 << 1,
+        Word = 1 << 2,          // \w: [0-9A-Za-z_]
+        Space = 1 << 3,         // \s: [\t\n\f\r ]
+        EmailLocal = 1 << 4,    // [A-Za-z0-9._%+\-]
+        EmailDomain = 1 << 5,   // [A-Za-z0-9.\-]
+        CardSeparator = 1 << 6, // [ -]
+        CardChar = 1 << 7       // [0-9 -]
+    };
+
+    constexpr auto CLASSES = []
+    {
+        std::array<uint8_t, 256> classes {};
+
+        for (int c = 0; c < 256; ++c)
+        {
+            const bool digit = c >= '0' && c <= '9';
+            const bool alpha = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+            uint8_t value = 0;
+
+            if (digit)
+                value |= Digit;
+            if (alpha)
+                value |= Alpha;
+            if (digit || alpha || c == '_')
+                value |= Word;
+            if (c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ')
+                value |= Space;
+            if (digit || alpha || c == '.' || c == '_' || c == '%' || c == '+' || c == '-')
+                value |= EmailLocal;
+            if (digit || alpha || c == '.' || c == '-')
+                value |= EmailDomain;
+            if (c == ' ' || c == '-')
+                value |= CardSeparator;
+            if (digit || c == ' ' || c == '-')
+                value |= CardChar;
+
+            classes[c] = value;
+        }
+
+        return classes;
+    }();
+
+    inline bool is(char c, CharClass charClass)
+    {
+        return CLASSES[static_cast<unsigned char>(c)] & charClass;
+    }
+
+    // \b after pos - 1 when text[pos - 1] is a word character
+    inline bool wordEndsAt(std::string_view text, size_t pos)
+    {
+        return pos == text.size() || !is(text[pos], Word);
+    }
+
+    inline size_t skip(std::string_view text, size_t pos, CharClass charClass)
+    {
+        while (pos < text.size() && is(text[pos], charClass))
+            ++pos;
+        return pos;
+    }
+
+    inline size_t find(std::string_view text, size_t pos, char c)
+    {
+        if (pos >= text.size())
+            return std::string_view::npos;
+
+        const void* found = std::memchr(text.data() + pos, c, text.size() - pos);
+        return found ? static_cast<size_t>(static_cast<const char*>(found) - text.data()) : std::string_view::npos;
+    }
+
+    inline bool found(std::string_view& input, std::string_view& capture, size_t begin, size_t end, size_t consumed)
+    {
+        capture = input.substr(begin, end - begin);
+        input.remove_prefix(consumed);
+        return true;
+    }
+
+    // Fixed-shape piece of a regex: '0' is \d, '~' is \s*, any other character itself.
+    // Returns the end of the match at pos, npos when it does not match.
+    template<size_t N>
+    struct Shape
+    {
+        char text[N];
+        constexpr Shape(const char (&shape)[N]) { std::copy_n(shape, N, text); }
+    };
+
+    template<Shape S>
+    size_t matchShape(std::string_view text, size_t pos)
+    {
+        for (size_t i = 0; i + 1 < sizeof(S.text); ++i)
+        {
+            const char expected = S.text[i];
+
+            if (expected == '~')
+            {
+                pos = skip(text, pos, Space);
+                continue;
+            }
+
+            if (pos == text.size())
+                return std::string_view::npos;
+
+            if (expected == '0' ? !is(text[pos], Digit) : text[pos] != expected)
+                return std::string_view::npos;
+
+            ++pos;
+        }
+
+        return pos;
+    }
+
+    // [A-Za-z0-9.\-]+\.[A-Za-z]{2,} over all of domain
+    bool isEmailDomain(std::string_view domain)
+    {
+        if (domain.empty() || skip(domain, 0, EmailDomain) != domain.size())
+            return false;
+
+        const size_t dot = domain.rfind('.');
+        if (dot == std::string_view::npos || dot == 0 || domain.size() - dot - 1 < 2)
+            return false;
+
+        return skip(domain, dot + 1, Alpha) == domain.size();
+    }
+
+    // (?:^|\s)([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,})(?:$|\s)
+    // The capture cannot hold whitespace, so it is a whole whitespace-delimited token.
+    bool matchEmailToken(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+        size_t at = 0;
+
+        while ((at = find(text, at, '@')) != std::string_view::npos)
+        {
+            size_t begin = at;
+            while (begin > 0 && !is(text[begin - 1], Space))
+                --begin;
+
+            const size_t end = std::min(text.find_first_of(" \t\n\f\r", at), text.size());
+
+            if (skip(text, begin, EmailLocal) == at && at > begin && isEmailDomain(text.substr(at + 1, end - at - 1)))
+                return found(input, capture, begin, end, end == text.size() ? end : end + 1);
+
+            at = end;
+        }
+
+        return false;
+    }
+
+    // <([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,})>
+    bool matchEmailAngle(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        for (size_t open = find(text, 0, '<'); open != std::string_view::npos; open = find(text, open + 1, '<'))
+        {
+            const size_t at = skip(text, open + 1, EmailLocal);
+            if (at == open + 1 || at == text.size() || text[at] != '@')
+                continue;
+
+            const size_t end = skip(text, at + 1, EmailDomain);
+            if (end == text.size() || text[end] != '>' || !isEmailDomain(text.substr(at + 1, end - at - 1)))
+                continue;
+
+            return found(input, capture, open + 1, end, end + 1);
+        }
+
+        return false;
+    }
+
+    // "([A-Za-z0-9._%+\-]+@[A-Za-z0-9.\-]+\.[A-Za-z]{2,})
+    // No closing anchor: the greedy domain backs off to the last dot followed by two letters.
+    bool matchEmailQuoted(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        for (size_t quote = find(text, 0, '"'); quote != std::string_view::npos; quote = find(text, quote + 1, '"'))
+        {
+            const size_t at = skip(text, quote + 1, EmailLocal);
+            if (at == quote + 1 || at == text.size() || text[at] != '@')
+                continue;
+
+            const size_t domainEnd = skip(text, at + 1, EmailDomain);
+
+            for (size_t dot = domainEnd; dot-- > at + 2;)
+            {
+                if (text[dot] != '.' || dot + 2 >= domainEnd || !is(text[dot + 1], Alpha) || !is(text[dot + 2], Alpha))
+                    continue;
+
+                const size_t end = skip(text, dot + 1, Alpha);
+                return found(input, capture, quote + 1, end, end);
+            }
+        }
+
+        return false;
+    }
+
+    // \+(\d{11}|\d \d{3} \d{3}-\d{2}-\d{2}|\d \(\d{3}\)\s*\d{3}-\d{4})\b
+    bool matchPhoneInternational(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        for (size_t plus = find(text, 0, '+'); plus != std::string_view::npos; plus = find(text, plus + 1, '+'))
+        {
+            for (const size_t end : { matchShape<"00000000000">(text, plus + 1),
+                                      matchShape<"0 000 000-00-00">(text, plus + 1),
+                                      matchShape<"0 (000)~000-0000">(text, plus + 1) })
+            {
+                if (end != std::string_view::npos && wordEndsAt(text, end))
+                    return found(input, capture, plus + 1, end, end);
+            }
+        }
+
+        return false;
+    }
+
+    // (\+7\s*\(\d{3}\)\s*\d{3}-\d{2}-\d{2})
+    bool matchPhoneRussian(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        for (size_t plus = find(text, 0, '+'); plus != std::string_view::npos; plus = find(text, plus + 1, '+'))
+        {
+            const size_t end = matchShape<"+7~(000)~000-00-00">(text, plus);
+            if (end != std::string_view::npos)
+                return found(input, capture, plus, end, end);
+        }
+
+        return false;
+    }
+
+    // Calls tryAt(pos) for every digit that can open a card number or an IP
+    // address, i.e. one (?:\b|\s|^) or \b allows: at the start or after a non-word character
+    template<typename TryAt>
+    bool forEachNumberStart(std::string_view text, TryAt&& tryAt)
+    {
+        static_assert((Word >> 2) == Digit);
+        uint8_t previous = 0;
+
+        // One test per byte: a digit whose predecessor's Word bit, shifted onto Digit, is clear
+        for (size_t pos = 0; pos < text.size(); ++pos)
+        {
+            const uint8_t current = CLASSES[static_cast<unsigned char>(text[pos])];
+
+            if ((current & ~(previous >> 2) & Digit) && tryAt(pos))
+                return true;
+
+            previous = current;
+        }
+
+        return false;
+    }
+
+    // (?:\b|\s|^)((\d[ -]?){15,16}\d)(?:\b|\s|$)
+    // A separator is never followed by another one, so the only choice the regex
+    // makes is the number of digits: 17 when they end a word, else 16.
+    bool matchCardNumber(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        return forEachNumberStart(text, [&](size_t begin)
+        {
+            // 16 digits take at least 16 bytes, all of them digits or separators
+            if (text.size() - begin < 16)
+                return false;
+
+            uint8_t common = 0xff;
+            for (size_t i = 0; i < 16; ++i)
+                common &= CLASSES[static_cast<unsigned char>(text[begin + i])];
+
+            if (!(common & CardChar))
+                return false;
+
+            size_t pos = begin;
+            size_t digits = 0;
+            size_t sixteenEnd = std::string_view::npos;
+
+            while (pos < text.size() && is(text[pos], Digit))
+            {
+                ++pos;
+
+                if (++digits == 17)
+                    break;
+                if (digits == 16)
+                    sixteenEnd = pos;
+
+                if (pos < text.size() && is(text[pos], CardSeparator))
+                    ++pos;
+            }
+
+            if (digits == 17 && wordEndsAt(text, pos))
+                return found(input, capture, begin, pos, pos);
+            if (digits >= 16 && wordEndsAt(text, sixteenEnd))
+                return found(input, capture, begin, sixteenEnd, sixteenEnd);
+
+            return false;
+        });
+    }
+
+    // (?:\b|\s|^)(3[47]\d{2}[ -]?\d{6}[ -]?\d{5})(?:\b|\s|$)
+    bool matchAmexNumber(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        const auto group = [&](size_t pos, size_t digits)
+        {
+            for (; digits > 0; --digits, ++pos)
+                if (pos == text.size() || !is(text[pos], Digit))
+                    return std::string_view::npos;
+            return pos;
+        };
+
+        const auto separator = [&](size_t pos)
+        {
+            return pos < text.size() && is(text[pos], CardSeparator) ? pos + 1 : pos;
+        };
+
+        return forEachNumberStart(text, [&](size_t begin)
+        {
+            if (text[begin] != '3' || begin + 1 == text.size() || (text[begin + 1] != '4' && text[begin + 1] != '7'))
+                return false;
+
+            size_t end = group(begin + 2, 2);
+            if (end != std::string_view::npos)
+                end = group(separator(end), 6);
+            if (end != std::string_view::npos)
+                end = group(separator(end), 5);
+
+            if (end == std::string_view::npos || !wordEndsAt(text, end))
+                return false;
+
+            return found(input, capture, begin, end, end);
+        });
+    }
+
+    // \b((?:25[0-5]|2[0-4][0-9]|1[0-9]{2}|[1-9]?[0-9])\.(?:...)\.(?:...)\.(?:...))\b
+    // An octet is followed by a dot or a word end, never by a digit, so every
+    // octet is a whole run of digits: 1 to 3 of them, no leading zero, at most 255.
+    bool matchIpAddress(std::string_view& input, std::string_view& capture)
+    {
+        const std::string_view text = input;
+
+        const auto octetEnd = [&](size_t pos)
+        {
+            const size_t end = skip(text, pos, Digit);
+            const size_t length = end - pos;
+
+            if (length == 0 || length > 3 || (length > 1 && text[pos] == '0'))
+                return std::string_view::npos;
+            if (length == 3 && text.compare(pos, 3, "255") > 0)
+                return std::string_view::npos;
+
+            return end;
+        };
+
+        return forEachNumberStart(text, [&](size_t begin)
+        {
+            size_t end = begin;
+
+            for (int octet = 0; octet < 4; ++octet)
+            {
+                if (octet > 0)
+                {
+                    if (end == text.size() || text[end] != '.')
+                        return false;
+                    ++end;
+                }
+
+                end = octetEnd(end);
+                if (end == std::string_view::npos)
+                    return false;
+            }
+
+            if (!wordEndsAt(text, end))
+                return false;
+
+            return found(input, capture, begin, end, end);
+        });
+    }
+
+    struct Entry
+    {
+        std::string_view pattern;
+        SpecializedMatcher matcher;
+    };
+
+    constexpr Entry MATCHERS[] =
+    {
+        { DefaultPatterns::CARD_NUMBER[0].regex, matchCardNumber },
+        { DefaultPatterns::CARD_NUMBER[1].regex, matchAmexNumber },
+        { DefaultPatterns::EMAIL[0].regex, matchEmailToken },
+        { DefaultPatterns::EMAIL[1].regex, matchEmailAngle },
+        { DefaultPatterns::EMAIL[2].regex, matchEmailQuoted },
+        { DefaultPatterns::IP[0].regex, matchIpAddress },
+        { DefaultPatterns::PHONE[0].regex, matchPhoneInternational },
+        { DefaultPatterns::PHONE[1].regex, matchPhoneRussian }
+    };
+}
+
+SpecializedMatcher findSpecializedMatcher(std::string_view pattern)
+{
+    for (const auto& entry : MATCHERS)
+        if (entry.pattern == pattern)
+            return entry.matcher;
+
+    return nullptr;
+}
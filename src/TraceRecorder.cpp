@@ -0,0 +1,118 @@
+#include "TraceRecorder.h"
+
+#ifdef PIIS_ENABLE_TRACING
+
+#include "OutputWriters.h"
+#include <unistd.h>
+
+TraceRecorder& TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::enable()
+{
+    _origin = std::chrono::steady_clock::now();
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (!buffer)
+    {
+        std::lock_guard lock(_buffersMutex);
+        buffer = _buffers.emplace_back(
+            std::make_unique<ThreadBuffer>(static_cast<uint32_t>(_buffers.size() + 1))).get();
+    }
+
+    return *buffer;
+}
+
+void TraceRecorder::record(const char* name, uint64_t startNanos, uint64_t endNanos, std::string detail)
+{
+    auto& buffer = localBuffer();
+    const auto index = buffer.written.load(std::memory_order_relaxed);
+
+    auto& event = buffer.events[index % RING_CAPACITY];
+    event.name = name;
+    event.startNanos = startNanos;
+    event.endNanos = endNanos;
+    event.detail = std::move(detail);
+
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+static void appendMicros(std::string& out, uint64_t nanos)
+{
+    out += std::to_string(nanos / 1000);
+    out += '.';
+
+    const auto fraction = std::to_string(nanos % 1000);
+    out.append(3 - fraction.size(), '0');
+    out += fraction;
+}
+
+void TraceRecorder::write(const std::filesystem::path& outputFile) const
+{
+    BufferedWriter writer(createOutputSink(outputFile, OutputCompression::None));
+    auto& out = writer.buffer();
+
+    const auto pid = std::to_string(::getpid());
+    bool first = true;
+
+    auto beginEvent = [&](uint32_t threadId)
+    {
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"pid\":";
+        out += pid;
+        out += ",\"tid\":";
+        out += std::to_string(threadId);
+    };
+
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    std::lock_guard lock(_buffersMutex);
+
+    for (const auto& buffer : _buffers)
+    {
+        beginEvent(buffer->threadId);
+        out += ",\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":";
+        JsonText::appendString(out, "thread-" + std::to_string(buffer->threadId));
+        out += "}}";
+
+        const auto written = buffer->written.load(std::memory_order_acquire);
+        const auto begin = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+
+        for (auto index = begin; index < written; ++index)
+        {
+            const auto& event = buffer->events[index % RING_CAPACITY];
+
+            beginEvent(buffer->threadId);
+            out += ",\"ph\":\"X\",\"cat\":\"piis\",\"name\":";
+            JsonText::appendString(out, event.name);
+            out += ",\"ts\":";
+            appendMicros(out, event.startNanos);
+            out += ",\"dur\":";
+            appendMicros(out, event.endNanos - event.startNanos);
+
+            if (!event.detail.empty())
+            {
+                out += ",\"args\":{\"detail\":";
+                JsonText::appendString(out, event.detail);
+                out += '}';
+            }
+
+            out += '}';
+            writer.commit();
+        }
+    }
+
+    out += "\n]}\n";
+    writer.close();
+}
+
+#endif // PIIS_ENABLE_TRACING
@@ -5,7 +5,10 @@
 #include "PIIDetector.h"
 #include "PIIResultExporter.h"
 #include "PIIResultHandler.h"
+#include "PatternReloader.h"
 #include "Scanner.h"
+#include "ScanServer.h"
+#include "TraceRecorder.h"
 
 int main(int argc, char* argv[])
 {
@@ -19,7 +22,7 @@ int main(int argc, char* argv[])
 
     GeneralConfig config = configger.getConfig();
 
-    if (config.inputPath.empty())
+    if (config.inputPath.empty() && config.serveSocket.empty())
     {
         std::cerr << "Error: Must specify a file or directory to scan" << std::endl;
         return 1;
@@ -36,30 +39,137 @@ int main(int argc, char* argv[])
     //TODO:
     // readerFactory.registerReader<ImageReader>({".jpg", ".jpeg", ".png", ".bmp", ".tiff", ".gif"});
 
-    std::unique_ptr<IStrategyScanner> piiStrategy;
+    const MatcherCache matcherCache(config.patternCacheDir);
+    const auto validators = config.validateMatches ? MatchValidators::defaults() : MatchValidators {};
+    const auto resolver = !config.resolveOverlaps ? MatchResolver {}
+                        : config.categoryPriority.empty() ? MatchResolver::defaults()
+                        : MatchResolver(config.categoryPriority);
+    auto piiStrategy = PIIStrategyHandler::createStrategy(config.strategy, config.patterns, config.keywords,
+                                                          matcherCache, validators, resolver);
 
-    if (config.strategy == "regex")
-        piiStrategy = PIIStrategyHandler::createRegexStrategy(config.patterns);
-    else if (config.strategy == "keyword")
-        piiStrategy = PIIStrategyHandler::createKeywordStrategy(config.keywords);
-    else
-        throw std::invalid_argument("Unsupported strategy type: " + config.strategy);
+    // Watches --pattern-config and swaps the strategy in place on change or SIGHUP. The
+    // reloader publishes into the slot from its own thread, so it is declared after
+    // the slot's owner and stopped before the slot is destroyed.
+    auto watchPatterns = [&config, &matcherCache, &validators, &resolver](StrategySlot& strategies)
+    {
+        return config.reloadPatterns
+            ? std::make_unique<PatternReloader>(strategies, config.patternConfigFile, config.strategy,
+                                                matcherCache, validators, resolver)
+            : std::unique_ptr<PatternReloader> {};
+    };
+
+    if (!config.serveSocket.empty())
+    {
+        ScanServerOptions serverOptions;
+        serverOptions.workers = config.threads;
+        serverOptions.maxMatchesPerType = config.maxMatchesPerType;
+        serverOptions.fileTimeoutSeconds = config.fileTimeoutSeconds;
+
+        StrategySlot strategies(std::move(piiStrategy));
+        const auto patternReloader = watchPatterns(strategies);
+
+        ScanServer server(strategies, readerFactory, serverOptions);
+        return server.run(config.serveSocket);
+    }
+
+    PatternProfiler patternProfiler;
 
-    PIIDetector detector(std::move(piiStrategy));
+    if (config.profilePatterns)
+        piiStrategy->enableProfiling(patternProfiler);
+
+    MatchInterner matchValues;
+    PIIDetector detector(std::move(piiStrategy), matchValues);
+    const auto patternReloader = watchPatterns(detector.strategies());
 
     std::vector<std::unique_ptr<IPIIResultExporter>> exporters;
-    exporters.push_back(std::make_unique<ConsoleExporter>());
+    exporters.push_back(std::make_unique<ConsoleExporter>(matchValues,
+        ConsoleExporter::parseVerbosity(config.consoleVerbosity)));
 
     if (!config.outputJson.empty())
-        exporters.push_back(std::make_unique<JsonExporter>(config.outputJson));
+        exporters.push_back(std::make_unique<JsonExporter>(config.outputJson, matchValues));
+
+    if (!config.outputNdjson.empty())
+        exporters.push_back(std::make_unique<NdjsonExporter>(config.outputNdjson, matchValues,
+            parseCompression(config.outputCompression)));
+
+    if (!config.outputBinary.empty())
+        exporters.push_back(std::make_unique<BinaryExporter>(config.outputBinary, matchValues));
+
+    auto stats = std::make_unique<PIIGeneralStats>(matchValues, config.topValues);
+
+    if (config.profilePatterns)
+        stats->setPatternProfiler(&patternProfiler);
+
+    if (config.shardCount > 1)
+        stats->setShard(config.shardIndex, config.shardCount);
 
-    PIIResultHandler resultProcessor(std::move(exporters));
-    PIIScanner scanner(detector, resultProcessor, readerFactory);
+    PIIResultHandler resultProcessor(std::move(exporters), std::move(stats));
+    ScanOptions scanOptions;
+    scanOptions.maxMatchesPerType = config.maxMatchesPerType;
+    scanOptions.maxFileMemoryBytes = static_cast<uint64_t>(config.maxMemoryMiB) * 1024 * 1024;
+    scanOptions.memoryBudgetBytes = static_cast<uint64_t>(config.memoryBudgetMiB) * 1024 * 1024;
+    scanOptions.threads = config.threads;
+    scanOptions.fileTimeoutSeconds = config.fileTimeoutSeconds;
+    scanOptions.shard = { config.shardIndex, config.shardCount };
+    scanOptions.schedule = parseSchedulePolicy(config.schedule);
+    scanOptions.batchReads = config.ioUring;
+
+    PathFilter pathFilter({ config.includeGlobs, config.excludeGlobs, config.minFileBytes, config.maxFileBytes,
+                            config.modifiedAfter, config.modifiedBefore, config.ignoreFiles });
+    scanOptions.pathFilter = &pathFilter;
+
+    // Scan times of earlier runs, kept next to the matcher tables. Only the cost
+    // schedule reads them, so only it learns from this run.
+    const bool costSchedule = scanOptions.schedule == SchedulePolicy::Cost;
+    const auto costFile = config.patternCacheDir.empty() || !costSchedule
+        ? std::filesystem::path() : config.patternCacheDir / "scan-costs.json";
+    std::unique_ptr<ScanCostModel> scanCosts = costFile.empty()
+        ? std::make_unique<ScanCostModel>() : std::make_unique<ScanCostModel>(costFile);
+    scanOptions.costs = costSchedule ? scanCosts.get() : nullptr;
+
+    std::unique_ptr<Redactor> redactor;
+    if (!config.redactDir.empty())
+    {
+        redactor = std::make_unique<Redactor>(config.inputPath, config.redactDir, parseRedactionStyle(config.redactStyle));
+        scanOptions.redactor = redactor.get();
+    }
+
+    PIIScanner scanner(detector, resultProcessor, readerFactory, scanOptions);
+
+#ifdef PIIS_ENABLE_TRACING
+    if (!config.traceFile.empty())
+        TraceRecorder::instance().enable();
+#else
+    if (!config.traceFile.empty())
+        std::cerr << "Warning: built without PIIS_ENABLE_TRACING, --trace is ignored" << std::endl;
+#endif
 
     if (std::filesystem::is_regular_file(config.inputPath))
         scanner.scan(config.inputPath);
     else if (std::filesystem::is_directory(config.inputPath))
         scanner.scan(config.inputPath, config.recursive);
 
+#ifdef PIIS_ENABLE_TRACING
+    if (!config.traceFile.empty())
+        TraceRecorder::instance().write(config.traceFile);
+#endif
+
+    if (!costFile.empty())
+    {
+        try
+        {
+            std::filesystem::create_directories(config.patternCacheDir);
+            scanCosts->save(costFile);
+        }
+        catch (const std::exception&)
+        {
+            // Read-only or full cache directory: the next run starts from the same history
+        }
+    }
+
+    if (redactor)
+        std::cout << "Redacted " << redactor->rangesRedacted() << " matches in " << redactor->filesWritten()
+                  << " files to " << redactor->outputDirectory().string() << std::endl;
+
     return 0;
 }
\ No newline at end of file
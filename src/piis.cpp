@@ -0,0 +1,272 @@
+#include "piis.h"
+#include "FileScan.h"
+#include "PatternRegistry.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// The scanner is immutable after creation: strategies and the reader factory
+// are only read by scan calls, so one handle serves every thread.
+struct piis_scanner
+{
+    std::unique_ptr<IStrategyScanner> strategy;
+    std::vector<std::string> categories;
+    FileReaderFactory readers;
+    size_t maxMatchesPerType = MatchQuota::UNLIMITED;
+    double fileTimeoutSeconds = 0.0;
+};
+
+namespace
+{
+    thread_local std::string lastError;
+
+    piis_status fail(piis_status status, std::string message)
+    {
+        lastError = std::move(message);
+        return status;
+    }
+
+    // Maps the exception of a failed call to its status, see piis_status
+    piis_status failWithCurrentException(piis_status fallback)
+    {
+        try
+        {
+            throw;
+        }
+        catch (const std::bad_alloc& e)
+        {
+            return fail(PIIS_ERROR_OUT_OF_MEMORY, e.what());
+        }
+        catch (const std::invalid_argument& e)
+        {
+            return fail(PIIS_ERROR_INVALID_ARGUMENT, e.what());
+        }
+        catch (const std::exception& e)
+        {
+            return fail(fallback, e.what());
+        }
+        catch (...)
+        {
+            return fail(PIIS_ERROR_INTERNAL, "unknown error");
+        }
+    }
+
+    // One malloc'ed block: the result, the category table, the matches and their bytes
+    piis_result* buildResult(const RawMatches& matches, double seconds, bool timedOut)
+    {
+        size_t categoryCount = 0;
+        size_t matchCount = 0;
+        size_t textBytes = 0;
+
+        for (const auto& [category, values] : matches)
+        {
+            if (values.empty())
+                continue;
+
+            ++categoryCount;
+            textBytes += category.size() + 1;
+            matchCount += values.size();
+
+            for (const auto& value : values)
+                textBytes += value.size() + 1;
+        }
+
+        const size_t categoriesOffset = sizeof(piis_result);
+        const size_t matchesOffset = categoriesOffset + categoryCount * sizeof(const char*);
+        const size_t textOffset = matchesOffset + matchCount * sizeof(piis_match);
+
+        auto* block = static_cast<char*>(std::malloc(textOffset + textBytes));
+        if (!block)
+            throw std::bad_alloc();
+
+        auto* result = reinterpret_cast<piis_result*>(block);
+        auto* categories = reinterpret_cast<const char**>(block + categoriesOffset);
+        auto* matchTable = reinterpret_cast<piis_match*>(block + matchesOffset);
+        char* text = block + textOffset;
+
+        auto copy = [&text](const std::string& value)
+        {
+            const char* stored = text;
+            std::memcpy(text, value.c_str(), value.size() + 1);
+            text += value.size() + 1;
+            return stored;
+        };
+
+        uint32_t categoryIndex = 0;
+        size_t matchIndex = 0;
+
+        for (const auto& [category, values] : matches)
+        {
+            if (values.empty())
+                continue;
+
+            categories[categoryIndex] = copy(category);
+
+            for (const auto& value : values)
+                matchTable[matchIndex++] = { copy(value), static_cast<uint32_t>(value.size()), categoryIndex };
+
+            ++categoryIndex;
+        }
+
+        result->categories = categories;
+        result->category_count = categoryCount;
+        result->matches = matchTable;
+        result->match_count = matchCount;
+        result->seconds = seconds;
+        result->timed_out = timedOut ? 1 : 0;
+        return result;
+    }
+
+    void loadPatterns(const piis_options& options, RawMatches& patterns, RawMatches& keywords)
+    {
+        if (options.pattern_config && *options.pattern_config)
+        {
+            if (!std::filesystem::is_regular_file(options.pattern_config))
+                throw std::runtime_error(std::string("Pattern config not found: ") + options.pattern_config);
+
+            JsonProvider(options.pattern_config).provide(patterns, keywords);
+        }
+        else
+            DefaultProvider().provide(patterns, keywords);
+    }
+}
+
+extern "C"
+{
+
+int piis_api_version(void)
+{
+    return PIIS_API_VERSION;
+}
+
+piis_status piis_scanner_create(const piis_options* options, piis_scanner** scanner)
+{
+    if (!scanner)
+        return fail(PIIS_ERROR_INVALID_ARGUMENT, "scanner must not be NULL");
+
+    *scanner = nullptr;
+    lastError.clear();
+
+    const piis_options defaults {};
+    const auto& settings = options ? *options : defaults;
+    const std::string strategy = settings.strategy ? settings.strategy : "regex";
+
+    RawMatches patterns;
+    RawMatches keywords;
+
+    try
+    {
+        loadPatterns(settings, patterns, keywords);
+    }
+    catch (...)
+    {
+        return failWithCurrentException(PIIS_ERROR_CONFIG);
+    }
+
+    try
+    {
+        auto handle = std::make_unique<piis_scanner>();
+
+        handle->strategy = PIIStrategyHandler::createStrategy(strategy, patterns, keywords);
+
+        handle->categories = handle->strategy->categories();
+        if (handle->categories.empty())
+            return fail(PIIS_ERROR_CONFIG, "No " + strategy + " patterns configured");
+
+        handle->readers.registerReader<TxtReader>(".txt");
+        handle->readers.registerReader<PdfReader>(".pdf");
+        handle->readers.registerReader<XlsxReader>(".xlsx");
+        handle->readers.registerReader<PptxReader>(".pptx");
+        handle->readers.registerReader<XmlReader>(".xml");
+        handle->readers.registerReader<DocxReader>(".docx");
+
+        handle->maxMatchesPerType = settings.max_matches_per_type;
+        handle->fileTimeoutSeconds = settings.file_timeout_seconds > 0.0 ? settings.file_timeout_seconds : 0.0;
+
+        *scanner = handle.release();
+        return PIIS_OK;
+    }
+    catch (...)
+    {
+        return failWithCurrentException(PIIS_ERROR_INTERNAL);
+    }
+}
+
+void piis_scanner_destroy(piis_scanner* scanner)
+{
+    delete scanner;
+}
+
+piis_status piis_scan_buffer(const piis_scanner* scanner, const char* data, size_t size, piis_result** result)
+{
+    if (!scanner || !result || (!data && size != 0))
+        return fail(PIIS_ERROR_INVALID_ARGUMENT, "scanner, data and result must not be NULL");
+
+    *result = nullptr;
+    lastError.clear();
+
+    try
+    {
+        const auto start = std::chrono::steady_clock::now();
+        MatchQuota quota(scanner->maxMatchesPerType);
+        const auto matches = scanner->strategy->scan(std::string(data, size), quota);
+        const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+        *result = buildResult(matches, seconds.count(), false);
+        return PIIS_OK;
+    }
+    catch (...)
+    {
+        return failWithCurrentException(PIIS_ERROR_INTERNAL);
+    }
+}
+
+piis_status piis_scan_file(const piis_scanner* scanner, const char* path, piis_result** result)
+{
+    if (!scanner || !path || !result)
+        return fail(PIIS_ERROR_INVALID_ARGUMENT, "scanner, path and result must not be NULL");
+
+    *result = nullptr;
+    lastError.clear();
+
+    const std::filesystem::path filePath(path);
+
+    if (!scanner->readers.isSupported(filePath))
+        return fail(PIIS_ERROR_UNSUPPORTED_FORMAT, "Unsupported file format: " + filePath.extension().string());
+
+    try
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto timeout = std::chrono::duration_cast<CancellationToken::Clock::duration>(
+            std::chrono::duration<double>(scanner->fileTimeoutSeconds));
+
+        CancellationToken token(timeout);
+        MatchQuota quota(scanner->maxMatchesPerType);
+
+        auto reader = scanner->readers.getReader(filePath);
+        const auto matches = scanFileChunks(*scanner->strategy, scanner->categories, *reader, filePath, quota, token);
+
+        const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+        *result = buildResult(matches, seconds.count(), token.timedOut());
+        return PIIS_OK;
+    }
+    catch (...)
+    {
+        return failWithCurrentException(PIIS_ERROR_READ);
+    }
+}
+
+void piis_result_free(piis_result* result)
+{
+    std::free(result);
+}
+
+const char* piis_last_error(void)
+{
+    return lastError.c_str();
+}
+
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <cxxopts.hpp>
+#include "OutputWriters.h"
+#include "PIIBinaryFormat.h"
+#include "ResultMerge.h"
+
+// Query and convert .piib results written by PIIScanner --binary,
+// merge NDJSON results of the parts of a sharded scan
+
+static void printInfo(const PIIBinaryResult& result)
+{
+    std::cout << " Files          : " << result.fileCount() << std::endl;
+    std::cout << " Matches        : " << result.matchCount() << std::endl;
+    std::cout << " Directories    : " << result.directories().size() << std::endl;
+    std::cout << " Categories     : " << result.categories().size() << std::endl;
+    std::cout << " Distinct values: " << result.values().size() << std::endl;
+    std::cout << " Statistics     : " << result.statisticsJson() << std::endl;
+}
+
+static void convertToJson(const PIIBinaryResult& result, const std::string& outputFile)
+{
+    std::unique_ptr<IOutputSink> sink;
+    if (outputFile.empty())
+        sink = std::make_unique<StreamSink>(stdout);
+    else
+        sink = std::make_unique<FileSink>(outputFile);
+
+    BufferedWriter writer(std::move(sink));
+    auto& out = writer.buffer();
+
+    const auto matchBegin = result.fileMatchBegin();
+    const auto categories = result.matchCategories();
+    const auto values = result.matchValues();
+
+    out += "{\"records\":[";
+
+    for (size_t file = 0; file < result.fileCount(); ++file)
+    {
+        if (file > 0)
+            out += ',';
+
+        out += "{\"duration\":";
+        JsonText::appendNumber(out, result.fileDurations()[file]);
+        out += ",\"file\":";
+        JsonText::appendString(out, result.paths()[result.filePaths()[file]]);
+        out += ",\"matches\":{";
+
+        // Matches are stored grouped by category in scan order
+        uint32_t currentCategory = UINT32_MAX;
+        for (auto match = matchBegin[file]; match < matchBegin[file + 1]; ++match)
+        {
+            if (categories[match] != currentCategory)
+            {
+                if (currentCategory != UINT32_MAX)
+                    out += "],";
+
+                currentCategory = categories[match];
+                JsonText::appendString(out, result.categories()[currentCategory]);
+                out += ":[";
+            }
+            else
+                out += ',';
+
+            JsonText::appendString(out, result.values()[values[match]]);
+        }
+
+        if (currentCategory != UINT32_MAX)
+            out += ']';
+
+        out += "},\"timestamp\":";
+        JsonText::appendNumber(out, static_cast<long long>(result.fileTimestamps()[file]));
+        out += '}';
+
+        writer.commit();
+    }
+
+    out += "],\"statistics\":";
+    out += result.statisticsJson().empty() ? std::string_view("{}") : result.statisticsJson();
+    out += "}\n";
+    writer.close();
+}
+
+static void mergeResults(const std::vector<std::string>& inputs, const std::string& outputFile)
+{
+    std::unique_ptr<IOutputSink> sink;
+    if (outputFile.empty())
+        sink = std::make_unique<StreamSink>(stdout);
+    else
+        sink = std::make_unique<FileSink>(outputFile);
+
+    BufferedWriter writer(std::move(sink));
+    mergeNdjsonResults(std::vector<std::filesystem::path>(inputs.begin(), inputs.end()), writer);
+}
+
+static void printCounts(const PIIBinaryResult& result, const std::string& by, size_t top)
+{
+    const auto& names = by == "type" ? result.categories()
+                      : by == "dir" ? result.directories()
+                      : by == "value" ? result.values()
+                      : throw std::invalid_argument("Unknown grouping: " + by + " (expected type/dir/value)");
+
+    std::vector<uint64_t> counts(names.size(), 0);
+
+    if (by == "type")
+    {
+        for (const auto category: result.matchCategories())
+            ++counts[category];
+    }
+    else if (by == "value")
+    {
+        for (const auto value: result.matchValues())
+            ++counts[value];
+    }
+    else
+    {
+        const auto matchBegin = result.fileMatchBegin();
+        const auto directories = result.fileDirectories();
+
+        for (size_t file = 0; file < result.fileCount(); ++file)
+            counts[directories[file]] += matchBegin[file + 1] - matchBegin[file];
+    }
+
+    std::vector<uint32_t> order(counts.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    const auto shown = std::min(top, order.size());
+    std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(shown), order.end(),
+        [&counts](uint32_t lhs, uint32_t rhs) { return counts[lhs] > counts[rhs]; });
+
+    for (size_t i = 0; i < shown && counts[order[i]] > 0; ++i)
+        std::cout << counts[order[i]] << '\t' << names[order[i]] << '\n';
+
+    std::cout.flush();
+}
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("PIIResultTool", "Query and convert PIIScanner binary results (.piib)");
+    options.add_options()
+        ("command", "info | json | count | merge", cxxopts::value<std::string>())
+        ("input", "Binary results file; for merge, the NDJSON results to combine", cxxopts::value<std::vector<std::string>>())
+        ("o,output", "Output file for json and merge (default: stdout)", cxxopts::value<std::string>()->default_value(""))
+        ("b,by", "Grouping for count (type/dir/value)", cxxopts::value<std::string>()->default_value("type"))
+        ("t,top", "Number of groups to print for count", cxxopts::value<size_t>()->default_value("20"))
+        ("h,help", "Show help message");
+    options.parse_positional({ "command", "input" });
+    options.positional_help("<command> <file.piib> | merge <part.ndjson>...");
+
+    try
+    {
+        const auto args = options.parse(argc, argv);
+
+        if (args.count("help") || !args.count("command") || !args.count("input"))
+        {
+            std::cout << options.help() << std::endl;
+            return args.count("help") ? 0 : 1;
+        }
+
+        const auto command = args["command"].as<std::string>();
+        const auto inputs = args["input"].as<std::vector<std::string>>();
+
+        if (command == "merge")
+        {
+            mergeResults(inputs, args["output"].as<std::string>());
+            return 0;
+        }
+
+        if (inputs.size() != 1)
+            throw std::invalid_argument(command + " takes one input file");
+
+        PIIBinaryResult result(inputs.front());
+
+        if (command == "info")
+            printInfo(result);
+        else if (command == "json")
+            convertToJson(result, args["output"].as<std::string>());
+        else if (command == "count")
+            printCounts(result, args["by"].as<std::string>(), args["top"].as<size_t>());
+        else
+            throw std::invalid_argument("Unknown command: " + command);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}